@@ -1,6 +1,10 @@
 import os
 import subprocess
 import json
+import queue
+import atexit
+import threading
+import time
 from flask import Flask, request, jsonify
 from flask_cors import CORS
 
@@ -10,39 +14,333 @@ CORS(app) # Enable CORS for frontend integration
 # Path to the C++ engine executable
 ENGINE_PATH = os.path.join(os.path.dirname(__file__), "dsa_engine", "amaan_engine.exe")
 
+# Number of resident engine processes kept alive by the worker pool
+ENGINE_POOL_SIZE = int(os.environ.get("AMAAN_ENGINE_WORKERS", "4"))
+
+# Seconds to wait for an engine answer, or for a free pooled worker, before giving up on it
+ENGINE_TIMEOUT = float(os.environ.get("AMAAN_ENGINE_TIMEOUT", "30"))
+
+# Arguments longer than this go to a one-shot engine via stdin (Windows caps a command line at 32K chars)
+ARGV_PAYLOAD_LIMIT = 16 * 1024
+
+# Hazard argument telling a resident worker to use the hazards streamed into it (see HazardFeed)
+LIVE_HAZARDS = "live"
+
+
+def format_hazard(h):
+    # Engine wire format: id|lat|lon|sev|type
+    return f"{h['id']}|{h['lat']}|{h['lon']}|{h['severity']}|{h['type']}"
+
+
+class HazardFeed:
+    """
+    Versioned log of hazard changes, streamed into the resident engine workers.
+    publish() diffs the scraper's current list against the previous one and logs
+    add / update / remove records under a new version (with "expires_at" Unix
+    seconds when a hazard carries one); each worker replays only the records it
+    has not seen yet (EngineWorker.sync_hazards), so requests no longer carry the
+    full hazard list. A worker too far behind the trimmed log is resynced with
+    "clear" plus the current list.
+    """
+    LOG_LIMIT = 1000
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.version = 0
+        self.current = {}   # id -> (record fields, expires_at)
+        self.log = []       # (version, record), oldest first
+        self.floor = 0      # Versions up to this one are no longer in the log
+
+    def publish(self, hazards):
+        with self.lock:
+            latest = {h['id']: (format_hazard(h), int(h.get('expires_at') or 0)) for h in hazards}
+            records = [f"remove|{hid}" for hid in self.current if hid not in latest]
+            for hid, (fields, expires_at) in latest.items():
+                if self.current.get(hid) != (fields, expires_at):
+                    records.append(f"add|{fields}|{expires_at}")
+            if not records:
+                return
+            self.version += 1
+            self.current = latest
+            self.log.extend((self.version, r) for r in records)
+            if len(self.log) > self.LOG_LIMIT:
+                self.floor = self.log[-self.LOG_LIMIT - 1][0]
+                self.log = [entry for entry in self.log if entry[0] > self.floor]
+
+    def records_since(self, version):
+        """(latest version, update records taking a worker from 'version' to it)"""
+        with self.lock:
+            if version == self.version:
+                return version, []
+            if version < self.floor or version > self.version:
+                records = ["clear"] + [f"add|{fields}|{expires_at}" for fields, expires_at in self.current.values()]
+                return self.version, records
+            return self.version, [r for v, r in self.log if v > version]
+
+    def full_list(self):
+        """
+        The current list in the one-shot format, which has no expiry field, so
+        hazards past their expiry are left out here (as a resident worker drops them)
+        """
+        now = time.time()
+        with self.lock:
+            return ";".join(fields for fields, expires_at in self.current.values()
+                            if expires_at == 0 or expires_at > now)
+
+
+hazard_feed = HazardFeed()
+
+
+class EngineWorker:
+    """
+    One long-lived `amaan_engine serve` process.
+    The graph is loaded once at spawn; each call is a length-prefixed frame:
+    "<request_id> <byte_count>\n" followed by the tab-separated command.
+    Answers are read by a reader thread, so a call can give up after
+    ENGINE_TIMEOUT (pipes cannot be polled with a timeout on Windows).
+    """
+    def __init__(self):
+        self.proc = subprocess.Popen([ENGINE_PATH, "serve"],
+                                     stdin=subprocess.PIPE,
+                                     stdout=subprocess.PIPE,
+                                     stderr=subprocess.DEVNULL)
+        self.next_id = 0
+        self.hazard_version = 0  # Last HazardFeed version streamed into this worker
+        self.frames = queue.Queue()  # (request_id, body) per answer; None once stdout closes
+        threading.Thread(target=self._read_frames, daemon=True).start()
+
+    def _read_frames(self):
+        try:
+            while True:
+                header = self.proc.stdout.readline().split()
+                if len(header) != 2:
+                    break
+                self.frames.put((int(header[0]), self.proc.stdout.read(int(header[1]))))
+        except Exception:
+            pass
+        self.frames.put(None)
+
+    def sync_hazards(self):
+        # Streams only the hazard changes this worker has not seen yet
+        version, records = hazard_feed.records_since(self.hazard_version)
+        if records:
+            result = self.call("hazards", ";".join(records))
+            if result.get("status") != "success":
+                raise RuntimeError("Engine worker rejected hazard updates")
+        self.hazard_version = version
+
+    def call(self, command, *args):
+        # Tabs separate arguments inside a frame, so they must not leak into values
+        fields = [command] + [str(arg).replace("\t", " ") for arg in args]
+        payload = "\t".join(fields).encode("utf-8")
+        self.next_id += 1
+        self.proc.stdin.write(f"{self.next_id} {len(payload)}\n".encode("ascii") + payload)
+        self.proc.stdin.flush()
+
+        try:
+            frame = self.frames.get(timeout=ENGINE_TIMEOUT)
+        except queue.Empty:
+            raise RuntimeError("Engine worker did not answer in time")
+        if frame is None or frame[0] != self.next_id:
+            raise RuntimeError("Engine worker returned a malformed frame")
+        return json.loads(frame[1])
+
+    def close(self):
+        try:
+            self.proc.stdin.close()
+            self.proc.wait(timeout=2)
+        except Exception:
+            self.proc.kill()
+            self.proc.wait()
+
+
+class EnginePool:
+    """
+    Pool of resident engine workers shared by all Flask request threads.
+    Workers are spawned lazily; a worker that fails is discarded and replaced.
+    A worker that cannot be spawned, or a pool busy for longer than
+    ENGINE_TIMEOUT, raises so the caller falls back to a one-shot engine.
+    """
+    def __init__(self, size):
+        self.size = size
+        self.idle = queue.Queue()
+        self.spawned = 0
+        self.lock = threading.Lock()
+
+    def _acquire(self):
+        with self.lock:
+            spawn = self.idle.empty() and self.spawned < self.size
+            if spawn:
+                self.spawned += 1
+        if spawn:
+            try:
+                return EngineWorker()
+            except Exception:
+                with self.lock:
+                    self.spawned -= 1
+                raise
+        try:
+            return self.idle.get(timeout=ENGINE_TIMEOUT)
+        except queue.Empty:
+            raise RuntimeError("No engine worker became free in time")
+
+    def call(self, command, *args):
+        worker = self._acquire()
+        try:
+            if LIVE_HAZARDS in args:
+                worker.sync_hazards()
+            result = worker.call(command, *args)
+        except Exception:
+            worker.close()
+            with self.lock:
+                self.spawned -= 1
+            raise
+        self.idle.put(worker)
+        return result
+
+    def call_idle(self, command, *args):
+        """
+        Runs a command on every worker that is idle right now (e.g. "stats").
+        Busy workers are skipped rather than waited for.
+        """
+        workers = []
+        while True:
+            try:
+                workers.append(self.idle.get_nowait())
+            except queue.Empty:
+                break
+        results = []
+        for worker in workers:
+            try:
+                results.append(worker.call(command, *args))
+            except Exception:
+                worker.close()
+                with self.lock:
+                    self.spawned -= 1
+                continue
+            self.idle.put(worker)
+        return results
+
+    def shutdown(self):
+        while not self.idle.empty():
+            self.idle.get().close()
+
+
+engine_pool = EnginePool(ENGINE_POOL_SIZE)
+atexit.register(engine_pool.shutdown)
+
+
+def run_engine_once(command, *args):
+    """
+    Spawns a single engine process for one command (fallback path).
+    A payload too large for the OS command line is passed on stdin ("-") instead.
+    A one-shot process has no streamed hazards, so it gets the full list.
+    """
+    args = [hazard_feed.full_list() if arg == LIVE_HAZARDS else str(arg) for arg in args]
+    stdin_payload = None
+    if args:
+        largest = max(range(len(args)), key=lambda i: len(args[i]))
+        if len(args[largest]) > ARGV_PAYLOAD_LIMIT:
+            stdin_payload = args[largest]
+            args[largest] = "-"
+    cmd_list = [ENGINE_PATH, command] + args
+    result = subprocess.run(cmd_list, input=stdin_payload, capture_output=True, text=True, timeout=ENGINE_TIMEOUT)
+    if result.returncode != 0:
+        return {"status": "error", "message": "Engine failed", "details": result.stderr}
+    return json.loads(result.stdout)
+
+
 def run_engine(command, *args):
     """
     Calls the C++ engine and returns the JSON output.
+    Requests go to a pooled resident worker; if that fails we fall back to
+    launching a one-shot process so a broken worker never fails a request.
     """
     try:
-        # Check if executable exists, otherwise fallback to mock for demo if needed
-        # But here we implement the real bridge
-        cmd_list = [ENGINE_PATH, command] + [str(arg) for arg in args]
-        result = subprocess.run(cmd_list, capture_output=True, text=True)
-        if result.returncode != 0:
-            return {"status": "error", "message": "Engine failed", "details": result.stderr}
-        return json.loads(result.stdout)
+        try:
+            return engine_pool.call(command, *args)
+        except Exception:
+            return run_engine_once(command, *args)
     except Exception as e:
         return {"status": "error", "message": str(e)}
 
+def route_endpoint(data, prefix):
+    # "<prefix>_node" (an ID) or "<prefix>_lat"/"<prefix>_lon", sent to the engine as "lat,lon"
+    if data.get(f'{prefix}_node') is not None:
+        return data[f'{prefix}_node']
+    lat, lon = data.get(f'{prefix}_lat'), data.get(f'{prefix}_lon')
+    if lat is None or lon is None:
+        return None
+    return f"{lat},{lon}"
+
 @app.route('/api/evaluate_route', methods=['POST'])
 def evaluate_route():
     data = request.json
-    start_node = data.get('start_node') # ID
-    end_node = data.get('end_node') # ID
+    # Each end is a node ID, or raw coordinates that the engine snaps to the nearest road
+    start_node = route_endpoint(data, 'start')
+    end_node = route_endpoint(data, 'end')
     
     if start_node is None or end_node is None:
         return jsonify({"status": "error", "message": "Missing start or end node"}), 400
     
-    # Get current hazards to pass to engine
-    live_hazards = scraper.get_live_hazards()
-    # Format: id|lat|lon|sev|type;id|lat|lon|sev|type
-    haz_strs = []
-    for h in live_hazards:
-        haz_strs.append(f"{h['id']}|{h['lat']}|{h['lon']}|{h['severity']}|{h['type']}")
-    full_haz_str = ";".join(haz_strs)
-        
-    res = run_engine("route", start_node, end_node, full_haz_str)
+    # The workers already hold the live hazards (streamed by HazardFeed)
+    # Optional search strategy: "dijkstra" (default), "astar" or "bidirectional"
+    options = []
+    if data.get('search'):
+        options.append(f"search={data['search']}")
+    # Optional priority queue: "binary" (default), "4ary", "radix" or "buckets"
+    if data.get('queue'):
+        options.append(f"queue={data['queue']}")
+    # Optional cost model: "standard" (default), "eta", "night" or "vulnerable"
+    if data.get('mode'):
+        options.append(f"mode={data['mode']}")
+    # Optional per-query timing / search-work breakdown
+    if data.get('stats'):
+        options.append("stats=1")
+    # Repeated origin/destination pairs are served from the engine's route cache unless disabled
+    if data.get('cache') is False:
+        options.append("cache=0")
+
+    res = run_engine("route", start_node, end_node, LIVE_HAZARDS, *options)
+    return jsonify(res)
+
+@app.route('/api/engine_stats', methods=['GET'])
+def engine_stats():
+    # Latency histograms (p50/p90/p99/p99.9 per command) from each idle resident worker
+    return jsonify({"status": "success", "workers": engine_pool.call_idle("stats")})
+
+@app.route('/api/route_matrix', methods=['POST'])
+def route_matrix():
+    data = request.json
+    sources = data.get('sources', []) # Node IDs, e.g. pending incidents
+    targets = data.get('targets', []) # Node IDs, e.g. responder locations
+    
+    if not sources or not targets:
+        return jsonify({"status": "error", "message": "Missing sources or targets"}), 400
+    
+    res = run_engine("matrix", ",".join(str(s) for s in sources), ",".join(str(t) for t in targets), LIVE_HAZARDS)
+    return jsonify(res)
+
+@app.route('/api/isochrone', methods=['POST'])
+def isochrone():
+    data = request.json
+    origins = data.get('origins', []) # Node IDs, e.g. responder stations
+    budget = data.get('budget')       # Safety-weighted cost limit (km under the chosen mode)
+
+    if not origins or budget is None:
+        return jsonify({"status": "error", "message": "Missing origins or budget"}), 400
+
+    options = []
+    # Optional cost model: "standard" (default), "eta", "night" or "vulnerable"
+    if data.get('mode'):
+        options.append(f"mode={data['mode']}")
+    # Optional coverage polygon per origin, and how tightly it follows the reached nodes
+    if data.get('hull'):
+        options.append("hull=1")
+    if data.get('concavity'):
+        options.append(f"concavity={data['concavity']}")
+
+    res = run_engine("isochrone", ",".join(str(o) for o in origins), str(budget), LIVE_HAZARDS, *options)
     return jsonify(res)
 
 # Simulated Real-Time Traffic Scraper (Mocking ITP FM 92.4 / Social Media)
@@ -62,6 +360,7 @@ class ITPMockScraper:
         return self.hazards
 
 scraper = ITPMockScraper()
+hazard_feed.publish(scraper.get_live_hazards())
 
 @app.route('/api/hazards', methods=['GET'])
 def get_hazards():
@@ -74,7 +373,9 @@ def get_hazards():
     live_hazards = scraper.get_live_hazards(user_lat, user_lon)
     for h in live_hazards:
         h['severity'] = max(1, min(10, h['severity'] + random.randint(-1, 1)))
-        
+    # Only the hazards whose severity moved are streamed to the engine workers
+    hazard_feed.publish(live_hazards)
+
     return jsonify({
         "status": "success", 
         "source": "AMAAN Real-Time Intelligence (Gemini Optimized)", 
@@ -111,6 +412,47 @@ def dynamic_nearest():
     res = run_engine("dynamic_nearest", lat, lon, full_cand_str)
     return jsonify(res)
 
+def format_candidates(candidates):
+    # Format candidates for C++: name|lat|lon|type;name|lat|lon|type
+    cand_strs = []
+    for c in candidates:
+        cand_strs.append(f"{c['name']}|{c['lat']}|{c['lon']}|{c.get('type', '')}")
+    return ";".join(cand_strs)
+
+@app.route('/api/k_nearest', methods=['POST'])
+def k_nearest():
+    data = request.json
+    lat = data.get('lat')
+    lon = data.get('lon')
+    k = data.get('k', 5)
+    candidates = data.get('candidates', []) # List of {name, lat, lon, type?}
+    
+    if not lat or not lon or not candidates:
+        return jsonify({"status": "error", "message": "Missing lat, lon or candidates"}), 400
+    
+    args = [lat, lon, k, format_candidates(candidates)]
+    if data.get('type'):
+        args.append(data['type'])
+    res = run_engine("k_nearest", *args)
+    return jsonify(res)
+
+@app.route('/api/within_radius', methods=['POST'])
+def within_radius():
+    data = request.json
+    lat = data.get('lat')
+    lon = data.get('lon')
+    radius_km = data.get('radius_km')
+    candidates = data.get('candidates', []) # List of {name, lat, lon, type?}
+    
+    if not lat or not lon or radius_km is None or not candidates:
+        return jsonify({"status": "error", "message": "Missing lat, lon, radius_km or candidates"}), 400
+    
+    args = [lat, lon, radius_km, format_candidates(candidates)]
+    if data.get('type'):
+        args.append(data['type'])
+    res = run_engine("within_radius", *args)
+    return jsonify(res)
+
 if __name__ == '__main__':
     # Add a check for the engine executable
     if not os.path.exists(ENGINE_PATH):
@@ -0,0 +1,314 @@
+/**
+ * amaan_bench
+ * End-to-end benchmark suite on reproducible synthetic cities (see synthetic_city.h).
+ * For every city kind and size it measures:
+ *   route_<search>    Dijkstra::find_safest_path with live hazards (dijkstra / astar / bidirectional)
+ *   isochrone_2km     Dijkstra::reachable_within with a 2 km cost budget around each query start
+ *   kdtree_nearest    KDTree::find_nearest over the city's facilities
+ *   hazard_penalty    HazardManager::get_penalty_for_location at random points
+ *   node_penalties_<isa>  HazardManager::get_penalties_for_locations over every node, with the
+ *                     penalty kernel on its best instruction set and capped to scalar
+ *   overlay_update / overlay_rebuild  one hazard's severity changes: WeightOverlay::update
+ *                     rescoring only the nodes around it, against a full WeightOverlay::rebuild
+ *   handle_route      the full "route" command (hazard parsing, overlay check, search, JSON), cache off
+ *   handle_route_churn  the same, but the hazard list changes every request (overlay rebuilds)
+ *   handle_route_cached        repeated queries answered by the route cache
+ *   handle_route_cached_churn  the same while one hazard changes every request (lazy revalidation)
+ *   parse_hazards_20k  decoding a 20,000-record hazard payload (payload_parser.h)
+ *   snap_coordinate    EdgeIndex::snap of random points onto the nearest road segment
+ *   route_snapped      Dijkstra between two snapped coordinates (virtual start / end nodes)
+ * Results go to stdout (or --out) as JSON, one record per benchmark, so runs from
+ * different commits can be diffed with bench/compare_bench.py. A table goes to stderr.
+ *
+ * Usage: amaan_bench [--sizes 1000,10000,100000] [--kind grid|geometric|both]
+ *                    [--queries N] [--lookups N] [--hazards N] [--seed S]
+ *                    [--label TEXT] [--out results.json]
+ */
+#include "synthetic_city.h"
+#include "../dijkstra.h"
+#include "../edge_index.h"
+#include "../engine.h"
+#include "../hazards.h"
+#include "../kdtree.h"
+#include "../latency_histogram.h"
+#include "../payload_parser.h"
+#include "../penalty_kernel.h"
+#include "../weight_overlay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * BenchResult
+ * One row of the report. Latencies are per operation, in nanoseconds.
+ */
+struct BenchResult {
+    std::string benchmark;
+    std::string city;
+    int nodes = 0;
+    int edges = 0;
+    uint64_t ops = 0;
+    double ops_per_sec = 0;
+    double mean_ns = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t max_ns = 0;
+    double checksum = 0; // Sum of the results, to spot behavior changes between runs
+};
+
+/**
+ * measure
+ * Runs op(i) for i in [0, ops), timing each call into a histogram (recorded in
+ * nanoseconds here). op returns a value folded into the checksum, which also keeps
+ * the compiler from discarding the work.
+ */
+template <typename Op>
+BenchResult measure(const std::string& name, const std::string& city, const CSRGraph& graph, uint64_t ops, Op op) {
+    LatencyHistogram histogram;
+    BenchResult r;
+    r.benchmark = name;
+    r.city = city;
+    r.nodes = graph.node_count();
+    r.edges = graph.edge_count();
+    r.ops = ops;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ops; ++i) {
+        auto started = std::chrono::steady_clock::now();
+        r.checksum += op(i);
+        histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count()));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    r.ops_per_sec = seconds > 0 ? ops / seconds : 0;
+    r.mean_ns = histogram.mean();
+    r.p50_ns = histogram.percentile(50);
+    r.p99_ns = histogram.percentile(99);
+    r.max_ns = histogram.max();
+    std::fprintf(stderr, "%-26s %-10s %8d %12.0f %12.0f %12llu %12llu\n", name.c_str(), city.c_str(), r.nodes,
+                 r.ops_per_sec, r.mean_ns, static_cast<unsigned long long>(r.p50_ns), static_cast<unsigned long long>(r.p99_ns));
+    return r;
+}
+
+void write_json(std::ostream& out, const std::string& label, unsigned seed, const std::vector<BenchResult>& results) {
+    out.precision(10);
+    out << "{\"label\": \"" << label << "\", \"seed\": " << seed << ", \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << (i > 0 ? "," : "") << "\n  {\"benchmark\": \"" << r.benchmark << "\", \"city\": \"" << r.city << "\"";
+        out << ", \"nodes\": " << r.nodes << ", \"edges\": " << r.edges << ", \"ops\": " << r.ops;
+        out << ", \"ops_per_sec\": " << r.ops_per_sec << ", \"mean_ns\": " << r.mean_ns;
+        out << ", \"p50_ns\": " << r.p50_ns << ", \"p99_ns\": " << r.p99_ns << ", \"max_ns\": " << r.max_ns;
+        out << ", \"checksum\": " << r.checksum << "}";
+    }
+    out << "\n]}" << std::endl;
+}
+
+std::vector<int> parse_sizes(const char* list) {
+    std::vector<int> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) sizes.push_back(std::atoi(item.c_str()));
+    }
+    return sizes;
+}
+
+int usage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [--sizes 1000,10000,100000] [--kind grid|geometric|both] [--queries N] [--lookups N]\n"
+                         "          [--hazards N] [--seed S] [--label TEXT] [--out results.json]\n", program);
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<int> sizes = {1000, 10000, 100000};
+    std::vector<synthetic::CityKind> kinds = {synthetic::CityKind::Grid, synthetic::CityKind::Geometric};
+    int queries = 100;      // Route searches per benchmark
+    int lookups = 100000;   // Point queries (KD-tree, hazard penalty) per benchmark
+    int hazard_count = 50;
+    unsigned seed = 42;
+    std::string label, out_path;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--sizes") && i + 1 < argc) sizes = parse_sizes(argv[++i]);
+        else if (!std::strcmp(argv[i], "--kind") && i + 1 < argc) {
+            std::string kind = argv[++i];
+            if (kind == "grid") kinds = {synthetic::CityKind::Grid};
+            else if (kind == "geometric") kinds = {synthetic::CityKind::Geometric};
+            else if (kind != "both") return usage(argv[0]);
+        }
+        else if (!std::strcmp(argv[i], "--queries") && i + 1 < argc) queries = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--lookups") && i + 1 < argc) lookups = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--hazards") && i + 1 < argc) hazard_count = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--label") && i + 1 < argc) label = argv[++i];
+        else if (!std::strcmp(argv[i], "--out") && i + 1 < argc) out_path = argv[++i];
+        else return usage(argv[0]);
+    }
+    if (queries <= 0 || lookups <= 0) return usage(argv[0]);
+
+    std::fprintf(stderr, "%-26s %-10s %8s %12s %12s %12s %12s\n", "benchmark", "city", "nodes", "ops/s", "mean_ns", "p50_ns", "p99_ns");
+    std::vector<BenchResult> results;
+    for (synthetic::CityKind kind : kinds) {
+        for (int size : sizes) {
+            const std::string city = synthetic::kind_name(kind);
+            CSRGraph graph = synthetic::make_city(kind, size, seed);
+            const int n = graph.node_count();
+
+            // Same query set for every benchmark on this city
+            std::mt19937 rng(seed + 1);
+            std::vector<std::pair<int, int>> pairs;
+            for (int q = 0; q < queries; ++q) pairs.push_back({graph.node_id(rng() % n), graph.node_id(rng() % n)});
+            std::vector<std::pair<double, double>> points;
+            for (int q = 0; q < lookups; ++q) {
+                int v = rng() % n;
+                points.push_back({graph.latitude(v) + 0.001 * (rng() % 1000) / 1000.0, graph.longitude(v)});
+            }
+
+            // 1. Raw searches against a live hazard overlay
+            HazardManager hazards;
+            std::vector<Hazard> live = synthetic::make_hazards(graph, hazard_count, seed + 2);
+            hazards.replace_all(live);
+            WeightOverlay overlay;
+            overlay.rebuild(graph, hazards);
+            const struct { SearchAlgorithm algorithm; const char* name; } algorithms[] = {
+                {SearchAlgorithm::Dijkstra, "route_dijkstra"}, {SearchAlgorithm::AStar, "route_astar"},
+                {SearchAlgorithm::Bidirectional, "route_bidirectional"}};
+            for (const auto& a : algorithms) {
+                Dijkstra::find_safest_path(graph, pairs[0].first, pairs[0].second, &overlay, a.algorithm); // Warm-up
+                results.push_back(measure(a.name, city, graph, pairs.size(), [&](uint64_t i) {
+                    return Dijkstra::find_safest_path(graph, pairs[i].first, pairs[i].second, &overlay, a.algorithm).total_distance;
+                }));
+            }
+
+            results.push_back(measure("isochrone_2km", city, graph, pairs.size(), [&](uint64_t i) {
+                return static_cast<double>(Dijkstra::reachable_within(graph, pairs[i].first, 2.0, &overlay).reached.size());
+            }));
+
+            // 2. Nearest facility (one facility per ~100 intersections)
+            KDTree tree(synthetic::make_facilities(graph, std::max(16, n / 100), seed + 3));
+            results.push_back(measure("kdtree_nearest", city, graph, points.size(), [&](uint64_t i) {
+                return tree.find_nearest(points[i].first, points[i].second).latitude;
+            }));
+
+            // 3. Hazard penalty lookups
+            results.push_back(measure("hazard_penalty", city, graph, points.size(), [&](uint64_t i) {
+                return hazards.get_penalty_for_location(points[i].first, points[i].second);
+            }));
+
+            // 3b. Every node at once (what an overlay rebuild does), vectorized and scalar
+            std::vector<double> node_penalties;
+            for (penalty_kernel::Isa isa : {penalty_kernel::detected_isa(), penalty_kernel::Isa::Scalar}) {
+                penalty_kernel::force_isa(isa);
+                const std::string name = std::string("node_penalties_") + penalty_kernel::isa_name(isa);
+                results.push_back(measure(name, city, graph, 20, [&](uint64_t) {
+                    hazards.get_penalties_for_locations(graph.node_latitudes(), graph.node_longitudes(),
+                                                        graph.node_count(), node_penalties);
+                    double sum = 0;
+                    for (double p : node_penalties) sum += p;
+                    return sum;
+                }));
+                if (isa == penalty_kernel::Isa::Scalar) break; // No AVX2 on this machine: measured once
+            }
+            penalty_kernel::force_isa(penalty_kernel::Isa::AVX2);
+
+            // 3c. A streamed update to one hazard: incremental overlay update vs full rebuild
+            if (!live.empty()) {
+                HazardManager streamed;
+                streamed.replace_all(live);
+                WeightOverlay streamed_overlay;
+                streamed_overlay.rebuild(graph, streamed);
+                auto bump = [&](uint64_t i) {
+                    HazardUpdate update{HazardUpdate::Op::Update, live[0], 0};
+                    update.hazard.severity = i % 2 ? live[0].severity : live[0].severity % 10 + 1;
+                    streamed.apply({update});
+                };
+                results.push_back(measure("overlay_update", city, graph, 200, [&](uint64_t i) {
+                    bump(i);
+                    streamed_overlay.update(graph, streamed);
+                    return static_cast<double>(streamed_overlay.penalized_edges().size());
+                }));
+                results.push_back(measure("overlay_rebuild", city, graph, 20, [&](uint64_t i) {
+                    bump(i);
+                    streamed_overlay.rebuild(graph, streamed);
+                    return static_cast<double>(streamed_overlay.penalized_edges().size());
+                }));
+            }
+
+            // 4. The full route command, with a steady hazard list and with one that changes every request
+            use_road_network(graph);
+            const std::string steady = synthetic::format_hazards(live);
+            std::vector<Hazard> moved = live;
+            if (!moved.empty()) moved[0].severity = moved[0].severity % 10 + 1;
+            const std::string changed = synthetic::format_hazards(moved);
+            RouteOptions options;
+            options.use_cache = false;
+            JsonWriter response;
+            auto run_route = [&](uint64_t i, const std::string& hazards_str) {
+                response.clear();
+                handle_route(response, pairs[i].first, pairs[i].second, hazards_str, options);
+                return static_cast<double>(response.size());
+            };
+            run_route(0, steady); // Builds the overlay once
+            results.push_back(measure("handle_route", city, graph, pairs.size(), [&](uint64_t i) { return run_route(i, steady); }));
+            results.push_back(measure("handle_route_churn", city, graph, pairs.size(), [&](uint64_t i) {
+                return run_route(i, i % 2 ? steady : changed);
+            }));
+
+            // 5. Payload decoding at scale
+            const std::string big_payload = synthetic::format_hazards(synthetic::make_hazards(graph, 20000, seed + 4));
+            std::vector<Hazard> parsed;
+            results.push_back(measure("parse_hazards_20k", city, graph, 20, [&](uint64_t) {
+                parsed.clear();
+                ParseReport report;
+                parse_hazards(big_payload, parsed, report);
+                return static_cast<double>(report.accepted);
+            }));
+
+            // 6. Dispatch-style repeats: the same pairs again, now through the route cache
+            options.use_cache = true;
+            for (size_t i = 0; i < pairs.size(); ++i) run_route(i, steady); // Fill the cache
+            results.push_back(measure("handle_route_cached", city, graph, pairs.size(), [&](uint64_t i) { return run_route(i, steady); }));
+            results.push_back(measure("handle_route_cached_churn", city, graph, pairs.size(), [&](uint64_t i) {
+                return run_route(i, i % 2 ? steady : changed);
+            }));
+
+            // 7. Raw coordinates: snapping onto roads, and routes between snapped points
+            EdgeIndex edges(graph);
+            results.push_back(measure("snap_coordinate", city, graph, points.size(), [&](uint64_t i) {
+                return edges.snap(graph, points[i].first, points[i].second).fraction;
+            }));
+            std::vector<std::pair<RoadSnap, RoadSnap>> snapped;
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                const std::pair<double, double>& a = points[(2 * i) % points.size()];
+                const std::pair<double, double>& b = points[(2 * i + 1) % points.size()];
+                snapped.push_back({edges.snap(graph, a.first, a.second), edges.snap(graph, b.first, b.second)});
+            }
+            results.push_back(measure("route_snapped", city, graph, snapped.size(), [&](uint64_t i) {
+                return Dijkstra::find_safest_path(graph, snapped[i].first, snapped[i].second, &overlay).total_distance;
+            }));
+        }
+    }
+
+    if (out_path.empty()) {
+        write_json(std::cout, label, seed, results);
+    } else {
+        std::ofstream out(out_path);
+        if (!out) {
+            std::fprintf(stderr, "amaan_bench: cannot write %s\n", out_path.c_str());
+            return 1;
+        }
+        write_json(out, label, seed, results);
+    }
+    return 0;
+}
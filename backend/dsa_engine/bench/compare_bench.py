@@ -0,0 +1,38 @@
+"""
+Compares two amaan_bench result files (e.g. before / after a change):
+
+    python3 bench/compare_bench.py baseline.json candidate.json
+
+Prints the p50 latency and throughput of every benchmark present in both runs,
+with the relative change. A changed checksum means the two builds computed
+different results, not just different timings.
+"""
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        run = json.load(f)
+    return run.get("label", path), {(r["benchmark"], r["city"], r["nodes"]): r for r in run["results"]}
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip())
+        return 1
+    base_label, base = load(sys.argv[1])
+    cand_label, cand = load(sys.argv[2])
+    print(f"baseline: {base_label}  candidate: {cand_label}")
+    print(f"{'benchmark':<20} {'city':<10} {'nodes':>8} {'p50_ns':>12} {'->':>2} {'p50_ns':<12} {'change':>8} {'ops/s x':>8}")
+    for key in sorted(base.keys() & cand.keys()):
+        a, b = base[key], cand[key]
+        change = (b["p50_ns"] - a["p50_ns"]) / a["p50_ns"] * 100 if a["p50_ns"] else 0.0
+        speedup = b["ops_per_sec"] / a["ops_per_sec"] if a["ops_per_sec"] else 0.0
+        note = "" if abs(a["checksum"] - b["checksum"]) <= 1e-6 * max(1.0, abs(a["checksum"])) else "  checksum differs"
+        print(f"{key[0]:<20} {key[1]:<10} {key[2]:>8} {a['p50_ns']:>12} {'->':>2} {b['p50_ns']:<12} {change:>7.1f}% {speedup:>7.2f}x{note}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
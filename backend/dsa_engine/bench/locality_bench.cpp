@@ -0,0 +1,160 @@
+/**
+ * locality_bench
+ * Measures what the Hilbert node order (see node_order.h) buys the searches.
+ * The same road network is laid out three ways and answers the same queries
+ * (by external Node ID) in each:
+ *   shuffled   internal indices in random order, like arbitrary OSM numbering
+ *   source     the order the network came in (file order, or generation order)
+ *   hilbert    renumbered along the Hilbert curve, as the engine loads it
+ * Besides the time per query it reads the CPU's cache-miss counter around the
+ * query loop (Linux perf events; "n/a" where the kernel does not allow it).
+ * Uses a binary graph file, or a synthetic city if none is given.
+ *
+ * Usage: locality_bench [--graph city.amgr] [--kind grid|geometric] [--nodes N] [--queries N]
+ */
+#include "synthetic_city.h"
+#include "../dijkstra.h"
+#include "../graph_file.h"
+#include "../node_order.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * CacheMissCounter
+ * Hardware cache-miss count of this thread between start() and stop(), or -1
+ * if perf events are unavailable (non-Linux, containers, perf_event_paranoid).
+ */
+class CacheMissCounter {
+private:
+    int fd = -1;
+
+public:
+    CacheMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long long stop() {
+#ifdef __linux__
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+        return count;
+#else
+        return -1;
+#endif
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string graph_path;
+    synthetic::CityKind kind = synthetic::CityKind::Geometric;
+    int nodes = 200000;
+    int queries = 200;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--graph") && i + 1 < argc) graph_path = argv[++i];
+        else if (!std::strcmp(argv[i], "--kind") && i + 1 < argc) {
+            const std::string k = argv[++i];
+            if (k != "grid" && k != "geometric") return std::fprintf(stderr, "Unknown kind: %s\n", k.c_str()), 1;
+            kind = k == "grid" ? synthetic::CityKind::Grid : synthetic::CityKind::Geometric;
+        }
+        else if (!std::strcmp(argv[i], "--nodes") && i + 1 < argc) nodes = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--queries") && i + 1 < argc) queries = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "Usage: %s [--graph city.amgr] [--kind grid|geometric] [--nodes N] [--queries N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CSRGraph source = graph_path.empty() ? synthetic::make_city(kind, nodes, 42) : GraphFile::load(graph_path);
+    std::printf("graph: %d nodes, %d edges, %d queries\n", source.node_count(), source.edge_count(), queries);
+    if (source.node_count() == 0 || queries <= 0) return 1;
+
+    // The three layouts of the same network
+    std::vector<int> shuffle(source.node_count());
+    std::iota(shuffle.begin(), shuffle.end(), 0);
+    std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(3));
+    const CSRGraph shuffled = source.permuted(shuffle);
+    const CSRGraph hilbert = source.permuted(node_order::hilbert_order(source));
+    const struct { const char* name; const CSRGraph* graph; } layouts[] = {
+        {"shuffled", &shuffled}, {"source", &source}, {"hilbert", &hilbert}};
+
+    std::mt19937 rng(7);
+    std::vector<std::pair<int, int>> pairs;
+    for (int q = 0; q < queries; ++q) {
+        pairs.push_back({source.node_id(rng() % source.node_count()), source.node_id(rng() % source.node_count())});
+    }
+
+    const struct { SearchAlgorithm algorithm; const char* name; } algorithms[] = {
+        {SearchAlgorithm::Dijkstra, "dijkstra"}, {SearchAlgorithm::AStar, "astar"}, {SearchAlgorithm::Bidirectional, "bidirectional"}};
+
+    CacheMissCounter misses;
+    std::printf("%-14s %-10s %12s %16s %10s\n", "search", "layout", "us/query", "misses/query", "checksum");
+    for (const auto& a : algorithms) {
+        for (const auto& layout : layouts) {
+            const CSRGraph& graph = *layout.graph;
+            // Warm-up pass so every layout starts with grown per-thread storage
+            Dijkstra::find_safest_path(graph, pairs[0].first, pairs[0].second, nullptr, a.algorithm);
+
+            double checksum = 0;
+            misses.start();
+            auto begin = std::chrono::steady_clock::now();
+            for (const auto& p : pairs) {
+                checksum += Dijkstra::find_safest_path(graph, p.first, p.second, nullptr, a.algorithm).total_distance;
+            }
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+            const long long missed = misses.stop();
+
+            char per_query[32] = "n/a";
+            if (missed >= 0) std::snprintf(per_query, sizeof(per_query), "%lld", missed / queries);
+            std::printf("%-14s %-10s %12.1f %16s %10.3f\n", a.name, layout.name, us / queries, per_query, checksum);
+        }
+    }
+    return 0;
+}
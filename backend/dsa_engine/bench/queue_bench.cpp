@@ -0,0 +1,69 @@
+/**
+ * queue_bench
+ * Compares the priority queues of the Dijkstra core (see priority_queues.h) on
+ * the same random queries. Uses a road network from a binary graph file, or a
+ * synthetic W x W downtown grid (dense, many near-equal costs; see synthetic_city.h)
+ * if none is given.
+ *
+ * Usage: queue_bench [--graph city.amgr] [--queries N] [--grid W]
+ */
+#include "synthetic_city.h"
+#include "../graph_file.h"
+#include "../dijkstra.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    std::string graph_path;
+    int queries = 200;
+    int grid = 300;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--graph") && i + 1 < argc) graph_path = argv[++i];
+        else if (!std::strcmp(argv[i], "--queries") && i + 1 < argc) queries = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--grid") && i + 1 < argc) grid = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "Usage: %s [--graph city.amgr] [--queries N] [--grid W]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CSRGraph graph = graph_path.empty() ? synthetic::make_city(synthetic::CityKind::Grid, grid * grid, 42) : GraphFile::load(graph_path);
+    std::printf("graph: %d nodes, %d edges, %d queries\n", graph.node_count(), graph.edge_count(), queries);
+    if (graph.node_count() == 0) return 1;
+
+    std::mt19937 rng(7);
+    std::vector<std::pair<int, int>> pairs;
+    for (int q = 0; q < queries; ++q) {
+        pairs.push_back({graph.node_id(rng() % graph.node_count()), graph.node_id(rng() % graph.node_count())});
+    }
+
+    const struct { SearchAlgorithm algorithm; const char* name; } algorithms[] = {
+        {SearchAlgorithm::Dijkstra, "dijkstra"}, {SearchAlgorithm::AStar, "astar"}, {SearchAlgorithm::Bidirectional, "bidirectional"}};
+    const struct { QueueType queue; const char* name; } queues[] = {
+        {QueueType::BinaryHeap, "binary"}, {QueueType::FourAryHeap, "4ary"}, {QueueType::RadixHeap, "radix"}, {QueueType::Buckets, "buckets"}};
+
+    std::printf("%-14s %-8s %12s %14s %10s\n", "search", "queue", "us/query", "settled/query", "checksum");
+    for (const auto& a : algorithms) {
+        for (const auto& q : queues) {
+            // Warm-up pass so every queue starts with grown per-thread storage
+            Dijkstra::find_safest_path(graph, pairs[0].first, pairs[0].second, nullptr, a.algorithm, q.queue);
+
+            double checksum = 0;
+            long long settled = 0;
+            auto begin = std::chrono::steady_clock::now();
+            for (const auto& p : pairs) {
+                PathResult r = Dijkstra::find_safest_path(graph, p.first, p.second, nullptr, a.algorithm, q.queue);
+                checksum += r.total_distance;
+                settled += r.stats.nodes_settled;
+            }
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+            std::printf("%-14s %-8s %12.1f %14lld %10.3f\n", a.name, q.name, us / queries, settled / queries, checksum);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "synthetic_city.h"
+#include "../geo.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+namespace synthetic {
+
+namespace {
+
+const double kOriginLat = 33.60;
+const double kOriginLon = 72.95;
+const double kBlockDeg = 0.002; // Spacing of neighbouring intersections (~200 m)
+
+// Two-way street between a and b. Length is the straight-line distance times a
+// detour factor; ~10% of streets carry a static hazard and ~5% a safety bonus
+// (kept below half the length, so routing costs stay positive).
+void add_street(Graph& g, std::mt19937& rng, int a, int b, double lat_a, double lon_a, double lat_b, double lon_b) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double length = geo::haversine_km(lat_a, lon_a, lat_b, lon_b) * (1.0 + 0.25 * unit(rng));
+    double hazard = unit(rng) < 0.10 ? unit(rng) * 2.0 : 0.0;
+    double safety = unit(rng) < 0.05 ? unit(rng) * 0.5 * length : 0.0;
+    g.add_edge(a, b, length, hazard, safety);
+}
+
+Graph make_grid(int nodes, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const int width = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(nodes)))));
+    std::vector<double> lats(nodes), lons(nodes);
+    Graph g;
+    for (int i = 0; i < nodes; ++i) {
+        lats[i] = kOriginLat + (i / width) * kBlockDeg + unit(rng) * 0.25 * kBlockDeg;
+        lons[i] = kOriginLon + (i % width) * kBlockDeg + unit(rng) * 0.25 * kBlockDeg;
+        g.add_node(i, lats[i], lons[i]);
+    }
+    for (int i = 0; i < nodes; ++i) {
+        int east = i + 1, south = i + width;
+        // ~4% of segments are missing (parks, dead ends), which still leaves one giant component
+        if (east % width != 0 && east < nodes && unit(rng) >= 0.04) add_street(g, rng, i, east, lats[i], lons[i], lats[east], lons[east]);
+        if (south < nodes && unit(rng) >= 0.04) add_street(g, rng, i, south, lats[i], lons[i], lats[south], lons[south]);
+    }
+    return g;
+}
+
+Graph make_geometric(int nodes, std::mt19937& rng) {
+    // Same density as the grid: one intersection per block-sized cell on average
+    const int width = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(nodes)))));
+    const int kNeighbours = 4;
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> lats(nodes), lons(nodes);
+    std::vector<std::vector<int>> cells(static_cast<size_t>(width) * width);
+    Graph g;
+    for (int i = 0; i < nodes; ++i) {
+        double row = unit(rng) * width, col = unit(rng) * width;
+        lats[i] = kOriginLat + row * kBlockDeg;
+        lons[i] = kOriginLon + col * kBlockDeg;
+        g.add_node(i, lats[i], lons[i]);
+        cells[std::min(width - 1, static_cast<int>(row)) * static_cast<size_t>(width) + std::min(width - 1, static_cast<int>(col))].push_back(i);
+    }
+
+    // Join every node to its nearest neighbours among the surrounding 5x5 cells
+    std::unordered_set<long long> joined;
+    std::vector<std::pair<double, int>> near;
+    for (int i = 0; i < nodes; ++i) {
+        int row = std::min(width - 1, static_cast<int>((lats[i] - kOriginLat) / kBlockDeg));
+        int col = std::min(width - 1, static_cast<int>((lons[i] - kOriginLon) / kBlockDeg));
+        near.clear();
+        for (int r = std::max(0, row - 2); r <= std::min(width - 1, row + 2); ++r) {
+            for (int c = std::max(0, col - 2); c <= std::min(width - 1, col + 2); ++c) {
+                for (int j : cells[static_cast<size_t>(r) * width + c]) {
+                    if (j == i) continue;
+                    double d_lat = lats[j] - lats[i], d_lon = lons[j] - lons[i];
+                    near.push_back({d_lat * d_lat + d_lon * d_lon, j});
+                }
+            }
+        }
+        size_t keep = std::min(near.size(), static_cast<size_t>(kNeighbours));
+        std::partial_sort(near.begin(), near.begin() + keep, near.end());
+        for (size_t k = 0; k < keep; ++k) {
+            int j = near[k].second;
+            long long key = static_cast<long long>(std::min(i, j)) * nodes + std::max(i, j);
+            if (joined.insert(key).second) add_street(g, rng, i, j, lats[i], lons[i], lats[j], lons[j]);
+        }
+    }
+    return g;
+}
+
+} // namespace
+
+const char* kind_name(CityKind kind) {
+    return kind == CityKind::Geometric ? "geometric" : "grid";
+}
+
+CSRGraph make_city(CityKind kind, int nodes, unsigned seed) {
+    std::mt19937 rng(seed);
+    nodes = std::max(1, nodes);
+    return CSRGraph(kind == CityKind::Geometric ? make_geometric(nodes, rng) : make_grid(nodes, rng));
+}
+
+std::vector<Hazard> make_hazards(const CSRGraph& city, int count, unsigned seed) {
+    static const char* const types[] = {"Traffic", "Construction", "Accident", "Protest"};
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> offset(-kBlockDeg, kBlockDeg);
+    std::vector<Hazard> hazards;
+    if (city.node_count() == 0) return hazards;
+    for (int i = 0; i < count; ++i) {
+        int node = static_cast<int>(rng() % city.node_count());
+        hazards.push_back({i + 1, city.latitude(node) + offset(rng), city.longitude(node) + offset(rng),
+                           static_cast<int>(1 + rng() % 10), types[i % 4]});
+    }
+    return hazards;
+}
+
+std::vector<Facility> make_facilities(const CSRGraph& city, int count, unsigned seed) {
+    static const char* const types[] = {"Hospital", "Police", "Fire Station"};
+    std::vector<Facility> facilities;
+    if (city.node_count() == 0) return facilities;
+    double min_lat = city.latitude(0), max_lat = min_lat, min_lon = city.longitude(0), max_lon = min_lon;
+    for (int v = 1; v < city.node_count(); ++v) {
+        min_lat = std::min(min_lat, city.latitude(v));
+        max_lat = std::max(max_lat, city.latitude(v));
+        min_lon = std::min(min_lon, city.longitude(v));
+        max_lon = std::max(max_lon, city.longitude(v));
+    }
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> lat(min_lat, max_lat), lon(min_lon, max_lon);
+    for (int i = 0; i < count; ++i) {
+        facilities.push_back({i + 1, "Facility " + std::to_string(i + 1), types[i % 3], lat(rng), lon(rng)});
+    }
+    return facilities;
+}
+
+std::string format_hazards(const std::vector<Hazard>& hazards) {
+    std::ostringstream out;
+    out.precision(10);
+    for (size_t i = 0; i < hazards.size(); ++i) {
+        const Hazard& h = hazards[i];
+        out << (i > 0 ? ";" : "") << h.id << '|' << h.latitude << '|' << h.longitude << '|' << h.severity << '|' << h.type;
+    }
+    return out.str();
+}
+
+} // namespace synthetic
@@ -0,0 +1,48 @@
+#ifndef SYNTHETIC_CITY_H
+#define SYNTHETIC_CITY_H
+
+#include "../csr_graph.h"
+#include "../hazards.h"
+#include "../kdtree.h"
+#include <string>
+#include <vector>
+
+/**
+ * Synthetic City Generator
+ * Reproducible road networks and hazard / facility sets for the benchmarks, so
+ * results can be compared across commits without shipping real map data.
+ * Every generator is a pure function of its arguments (a fixed-seed mt19937),
+ * and cities are laid out around Islamabad with ~200 m blocks.
+ */
+namespace synthetic {
+
+/**
+ * CityKind
+ * - Grid:      downtown grid with jittered intersections, ~4% missing street
+ *              segments and noisy road lengths. Many near-equal route costs.
+ * - Geometric: random geometric graph; uniformly scattered intersections, each
+ *              joined to its nearest neighbours. Irregular, like suburbs.
+ */
+enum class CityKind {
+    Grid,
+    Geometric
+};
+
+// Name used on the command line and in benchmark results ("grid" / "geometric")
+const char* kind_name(CityKind kind);
+
+// Compiled road network with roughly 'nodes' intersections (node IDs 0..nodes-1)
+CSRGraph make_city(CityKind kind, int nodes, unsigned seed);
+
+// 'count' live hazards (IDs 1..count) centered near random intersections of 'city'
+std::vector<Hazard> make_hazards(const CSRGraph& city, int count, unsigned seed);
+
+// 'count' facilities scattered over the bounding box of 'city', cycling through a few types
+std::vector<Facility> make_facilities(const CSRGraph& city, int count, unsigned seed);
+
+// Hazards in the "id|lat|lon|sev|type;..." wire format of the route command
+std::string format_hazards(const std::vector<Hazard>& hazards);
+
+} // namespace synthetic
+
+#endif // SYNTHETIC_CITY_H
@@ -0,0 +1,115 @@
+/**
+ * tile_bench
+ * Measures routing on a tiled map (see graph_tiles.h) against the resident CSR
+ * graph it was cut from. The network is written to a temporary tile file and
+ * opened afresh for every row, so each row starts with no tile mapped:
+ *   local      both ends within 5 km, the common case for a city app
+ *   random     ends anywhere on the map
+ * under several caps on resident tiles (0 = no cap). Every route is compared
+ * with Dijkstra::find_safest_path on the CSR graph with the same hazards;
+ * "mismatches" counts routes whose cost or path differ.
+ *
+ * Usage: tile_bench [--nodes N] [--queries N] [--tile-size DEG] [--hazards N]
+ */
+#include "synthetic_city.h"
+#include "../dijkstra.h"
+#include "../geo.h"
+#include "../graph_tiles.h"
+#include "../node_order.h"
+#include "../weight_overlay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int nodes = 200000;
+    int queries = 200;
+    int hazard_count = 50;
+    double tile_size = TiledGraph::kDefaultTileSize;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--nodes") && i + 1 < argc) nodes = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--queries") && i + 1 < argc) queries = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--tile-size") && i + 1 < argc) tile_size = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--hazards") && i + 1 < argc) hazard_count = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "Usage: %s [--nodes N] [--queries N] [--tile-size DEG] [--hazards N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const CSRGraph city = node_order::hilbert_reordered(synthetic::make_city(synthetic::CityKind::Geometric, nodes, 42));
+    HazardManager hazards;
+    hazards.replace_all(synthetic::make_hazards(city, hazard_count, 44));
+    WeightOverlay overlay;
+    overlay.rebuild(city, hazards);
+    if (city.node_count() == 0 || queries <= 0) return 1;
+
+    const std::string path = "tile_bench.amtl";
+    TiledGraph::write(city, path, tile_size);
+    const int tile_count = TiledGraph(path, 0).tile_count();
+    std::printf("graph: %d nodes, %d edges, %d tiles of %.3f deg, %d queries\n",
+                city.node_count(), city.edge_count(), tile_count, tile_size, queries);
+
+    // Query sets, as external Node IDs
+    std::mt19937 rng(7);
+    std::vector<std::pair<int, int>> local, random;
+    while (static_cast<int>(local.size()) < queries) {
+        const int s = rng() % city.node_count(), t = rng() % city.node_count();
+        if (geo::haversine_km(city.latitude(s), city.longitude(s), city.latitude(t), city.longitude(t)) < 5.0) {
+            local.push_back({city.node_id(s), city.node_id(t)});
+        }
+    }
+    for (int q = 0; q < queries; ++q) {
+        random.push_back({city.node_id(rng() % city.node_count()), city.node_id(rng() % city.node_count())});
+    }
+    const struct { const char* name; const std::vector<std::pair<int, int>>* pairs; } workloads[] = {
+        {"local", &local}, {"random", &random}};
+    const struct { SearchAlgorithm algorithm; const char* name; } algorithms[] = {
+        {SearchAlgorithm::Dijkstra, "dijkstra"}, {SearchAlgorithm::AStar, "astar"}};
+    const size_t caps[] = {8, 32, 0};
+
+    std::printf("%-10s %-8s %5s %11s %11s %11s %12s %11s %11s\n", "search", "queries", "cap", "us/query",
+                "csr_us", "tiles/query", "loads/query", "resident_MB", "mismatches");
+    for (const auto& a : algorithms) {
+        for (const auto& w : workloads) {
+            // Reference routes on the resident graph
+            std::vector<PathResult> expected;
+            auto begin = std::chrono::steady_clock::now();
+            for (const auto& p : *w.pairs) {
+                expected.push_back(Dijkstra::find_safest_path(city, p.first, p.second, &overlay, a.algorithm));
+            }
+            const double csr_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+            for (size_t cap : caps) {
+                TiledGraph tiles(path, cap);
+                long long touched = 0, loaded = 0;
+                int mismatches = 0;
+                size_t peak_bytes = 0;
+                double us = 0;
+                for (size_t q = 0; q < w.pairs->size(); ++q) {
+                    const auto& p = (*w.pairs)[q];
+                    begin = std::chrono::steady_clock::now();
+                    PathResult r = Dijkstra::find_safest_path(tiles, p.first, p.second, &hazards, a.algorithm);
+                    us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+                    touched += r.stats.tiles_touched;
+                    loaded += r.stats.tiles_loaded;
+                    peak_bytes = std::max(peak_bytes, tiles.cache_counters().resident_bytes);
+                    const PathResult& e = expected[q];
+                    if (r.success != e.success || r.total_cost != e.total_cost || r.path != e.path ||
+                        r.total_distance != e.total_distance || r.safety_score != e.safety_score) {
+                        mismatches++;
+                    }
+                }
+                const double n = static_cast<double>(w.pairs->size());
+                std::printf("%-10s %-8s %5zu %11.1f %11.1f %11.1f %12.1f %11.1f %11d\n", a.name, w.name, cap,
+                            us / n, csr_us / n, touched / n, loaded / n, peak_bytes / 1048576.0, mismatches);
+            }
+        }
+    }
+    std::remove(path.c_str());
+    return 0;
+}
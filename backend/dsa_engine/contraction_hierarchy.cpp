@@ -0,0 +1,326 @@
+#include "contraction_hierarchy.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace {
+
+const double kInfinity = 1e18;
+
+// Subproblems at or below this size are ranked directly (no further bisection)
+const size_t kLeafSize = 8;
+
+} // namespace
+
+/**
+ * ContractionHierarchy::ContractionHierarchy
+ * 1. Rank nodes (compute_order).
+ * 2. Contract in rank order: the upward neighbors of a node must form a clique,
+ *    and it suffices to merge them into the node's lowest upward neighbor
+ *    (its elimination-tree parent), which is contracted later and propagates them further.
+ * 3. Freeze the upward neighbor lists into a CSR arc array and map each original
+ *    edge to the arc that carries it.
+ */
+ContractionHierarchy::ContractionHierarchy(const CSRGraph& graph) : node_total(graph.node_count()) {
+    compute_order(graph);
+
+    // 1. Initial upward neighbor sets from the undirected road topology
+    std::vector<std::vector<int>> upward(node_total);
+    for (int e = 0; e < graph.edge_count(); ++e) {
+        int a = rank_of[graph.edge_source(e)];
+        int b = rank_of[graph.edge_target(e)];
+        if (a == b) continue; // Self loops never lie on a shortest path
+        upward[std::min(a, b)].push_back(std::max(a, b));
+    }
+
+    // 2. Contraction (elimination game)
+    parent.assign(node_total, -1);
+    for (int r = 0; r < node_total; ++r) {
+        std::vector<int>& mine = upward[r];
+        std::sort(mine.begin(), mine.end());
+        mine.erase(std::unique(mine.begin(), mine.end()), mine.end());
+        if (mine.empty()) continue;
+
+        int p = mine.front();
+        parent[r] = p;
+        if (mine.size() > 1) {
+            // Fill-in: every other upward neighbor of r becomes a neighbor of p
+            std::vector<int>& theirs = upward[p];
+            theirs.insert(theirs.end(), mine.begin() + 1, mine.end());
+        }
+    }
+
+    // 3. Freeze the arcs
+    arc_offsets.assign(node_total + 1, 0);
+    for (int r = 0; r < node_total; ++r) {
+        arc_offsets[r + 1] = arc_offsets[r] + static_cast<int>(upward[r].size());
+    }
+    arc_tail.reserve(arc_offsets[node_total]);
+    arc_head.reserve(arc_offsets[node_total]);
+    for (int r = 0; r < node_total; ++r) {
+        for (int h : upward[r]) {
+            arc_tail.push_back(r);
+            arc_head.push_back(h);
+        }
+        std::vector<int>().swap(upward[r]); // Release memory as we go
+    }
+
+    arc_of_edge.assign(graph.edge_count(), -1);
+    for (int e = 0; e < graph.edge_count(); ++e) {
+        int a = rank_of[graph.edge_source(e)];
+        int b = rank_of[graph.edge_target(e)];
+        if (a != b) arc_of_edge[e] = find_arc(std::min(a, b), std::max(a, b));
+    }
+}
+
+/**
+ * compute_order
+ * Nested dissection by coordinate bisection: split the node set at the median
+ * of its longer geographic extent, take the nodes of one half that touch the
+ * other half as the separator, recurse into both remaining parts and rank the
+ * separator last (highest). Road networks have small geometric separators, which
+ * keeps both the number of shortcuts and the elimination tree depth low.
+ */
+void ContractionHierarchy::compute_order(const CSRGraph& graph) {
+    node_at_rank.clear();
+    node_at_rank.reserve(node_total);
+    // Marks the nodes of the "far" half during one bisection step
+    std::vector<int> mark(node_total, -1);
+    int step = 0;
+
+    std::function<void(std::vector<int>&)> dissect = [&](std::vector<int>& nodes) {
+        if (nodes.size() <= kLeafSize) {
+            node_at_rank.insert(node_at_rank.end(), nodes.begin(), nodes.end());
+            return;
+        }
+
+        // Choose the axis with the larger extent (longitude scaled to ground distance)
+        double min_lat = kInfinity, max_lat = -kInfinity, min_lon = kInfinity, max_lon = -kInfinity;
+        for (int v : nodes) {
+            min_lat = std::min(min_lat, graph.latitude(v));
+            max_lat = std::max(max_lat, graph.latitude(v));
+            min_lon = std::min(min_lon, graph.longitude(v));
+            max_lon = std::max(max_lon, graph.longitude(v));
+        }
+        double lon_scale = std::cos((min_lat + max_lat) / 2 * 3.14159265358979323846 / 180.0);
+        bool by_lat = (max_lat - min_lat) >= (max_lon - min_lon) * lon_scale;
+        auto coordinate = [&](int v) { return by_lat ? graph.latitude(v) : graph.longitude(v); };
+
+        // Median split into [0, mid) and [mid, n)
+        size_t mid = nodes.size() / 2;
+        std::nth_element(nodes.begin(), nodes.begin() + mid, nodes.end(),
+                         [&](int a, int b) { return coordinate(a) < coordinate(b); });
+
+        const int tag = step++;
+        for (size_t i = mid; i < nodes.size(); ++i) mark[nodes[i]] = tag;
+
+        // Separator: nodes of the first half with a road (either direction) into the second half
+        std::vector<int> near_part, far_part(nodes.begin() + mid, nodes.end()), separator;
+        for (size_t i = 0; i < mid; ++i) {
+            int v = nodes[i];
+            bool crosses = false;
+            for (int e = graph.edge_begin(v); e < graph.edge_end(v) && !crosses; ++e) {
+                crosses = mark[graph.edge_target(e)] == tag;
+            }
+            for (int j = graph.in_edge_begin(v); j < graph.in_edge_end(v) && !crosses; ++j) {
+                crosses = mark[graph.edge_source(graph.in_edge(j))] == tag;
+            }
+            (crosses ? separator : near_part).push_back(v);
+        }
+
+        std::vector<int>().swap(nodes); // The parts now own the nodes
+        dissect(near_part);
+        dissect(far_part);
+        node_at_rank.insert(node_at_rank.end(), separator.begin(), separator.end());
+    };
+
+    std::vector<int> all(node_total);
+    for (int v = 0; v < node_total; ++v) all[v] = v;
+    dissect(all);
+
+    rank_of.assign(node_total, -1);
+    for (int r = 0; r < node_total; ++r) rank_of[node_at_rank[r]] = r;
+}
+
+/**
+ * find_arc
+ * Binary search for 'high' among the sorted heads of the arcs leaving 'low'.
+ */
+int ContractionHierarchy::find_arc(int low, int high) const {
+    auto first = arc_head.begin() + arc_offsets[low];
+    auto last = arc_head.begin() + arc_offsets[low + 1];
+    auto it = std::lower_bound(first, last, high);
+    return (it != last && *it == high) ? static_cast<int>(it - arc_head.begin()) : -1;
+}
+
+/**
+ * customize
+ * 1. Every arc starts at the cheapest original edge it carries (or infinity).
+ * 2. Lower triangles are processed bottom-up: for a node m with upward
+ *    neighbors x < y, the path x -> m -> y may be cheaper than the arc x -> y
+ *    (and likewise y -> m -> x). After this pass, every arc cost is the cheapest
+ *    way to travel between its endpoints through lower-ranked nodes.
+ */
+void ContractionHierarchy::customize(const CSRGraph& graph, const WeightOverlay* overlay) {
+    const size_t arc_total = arc_head.size();
+    up_cost.assign(arc_total, kInfinity);
+    down_cost.assign(arc_total, kInfinity);
+    up_via.assign(arc_total, -1);
+    down_via.assign(arc_total, -1);
+    up_edge.assign(arc_total, -1);
+    down_edge.assign(arc_total, -1);
+
+    // 1. Original edge costs
+    for (int e = 0; e < graph.edge_count(); ++e) {
+        int a = arc_of_edge[e];
+        if (a < 0) continue;
+        double cost = routing_cost(graph, overlay, e);
+        bool upward = rank_of[graph.edge_source(e)] < rank_of[graph.edge_target(e)];
+        double& slot = upward ? up_cost[a] : down_cost[a];
+        if (cost < slot) {
+            slot = cost;
+            (upward ? up_edge[a] : down_edge[a]) = e;
+        }
+    }
+
+    // 2. Lower triangle relaxation in rank order
+    for (int m = 0; m < node_total; ++m) {
+        for (int i = arc_offsets[m]; i < arc_offsets[m + 1]; ++i) {
+            for (int j = i + 1; j < arc_offsets[m + 1]; ++j) {
+                // Heads are sorted, so arc_head[i] < arc_head[j]
+                int top = find_arc(arc_head[i], arc_head[j]);
+                // x -> y via m: x -> m is the downward direction of arc i, m -> y the upward of j
+                double through_up = down_cost[i] + up_cost[j];
+                if (through_up < up_cost[top]) {
+                    up_cost[top] = through_up;
+                    up_via[top] = m;
+                }
+                double through_down = down_cost[j] + up_cost[i];
+                if (through_down < down_cost[top]) {
+                    down_cost[top] = through_down;
+                    down_via[top] = m;
+                }
+            }
+        }
+    }
+
+    customized = true;
+}
+
+/**
+ * unpack
+ * Replaces shortcuts by the two arcs of their triangle until only original
+ * edges remain. Uses an explicit stack; edges are appended in travel order.
+ */
+void ContractionHierarchy::unpack(int arc, bool upward, std::vector<int>& edges) const {
+    std::vector<std::pair<int, bool>> stack = {{arc, upward}};
+    while (!stack.empty()) {
+        auto [a, up] = stack.back();
+        stack.pop_back();
+
+        int via = up ? up_via[a] : down_via[a];
+        if (via < 0) {
+            edges.push_back(up ? up_edge[a] : down_edge[a]);
+            continue;
+        }
+
+        int low = arc_tail[a], high = arc_head[a];
+        int to_low = find_arc(via, low);   // via -- low
+        int to_high = find_arc(via, high); // via -- high
+        if (up) {
+            // low -> via -> high; push in reverse so the first leg is expanded first
+            stack.push_back({to_high, true});
+            stack.push_back({to_low, false});
+        } else {
+            // high -> via -> low
+            stack.push_back({to_low, true});
+            stack.push_back({to_high, false});
+        }
+    }
+}
+
+/**
+ * find_safest_path
+ * Elimination tree query: the forward search relaxes upward arcs along the
+ * ancestor chain of the start, the backward search relaxes downward costs along
+ * the ancestor chain of the target. The best meeting rank on the common part of
+ * the two chains gives the optimal cost; its arcs are then unpacked.
+ */
+PathResult ContractionHierarchy::find_safest_path(const CSRGraph& graph, const WeightOverlay* overlay,
+                                                  int start_node, int end_node) const {
+    const int start = graph.index_of(start_node);
+    const int end = graph.index_of(end_node);
+    if (start < 0 || end < 0 || !customized) return {{}, 0, 0, false, {}, 0};
+
+    // Per-thread scratch indexed by rank; only chain entries are written and reset
+    thread_local std::vector<double> dist_fwd, dist_bwd;
+    thread_local std::vector<int> arc_fwd, arc_bwd;
+    if (dist_fwd.size() != static_cast<size_t>(node_total)) {
+        dist_fwd.assign(node_total, kInfinity);
+        dist_bwd.assign(node_total, kInfinity);
+        arc_fwd.assign(node_total, -1);
+        arc_bwd.assign(node_total, -1);
+    }
+
+    std::vector<int> chain_fwd, chain_bwd;
+    for (int r = rank_of[start]; r != -1; r = parent[r]) chain_fwd.push_back(r);
+    for (int r = rank_of[end]; r != -1; r = parent[r]) chain_bwd.push_back(r);
+
+    // Forward: start -> higher ranks using upward costs
+    long long arcs_scanned = 0;
+    dist_fwd[chain_fwd.front()] = 0;
+    for (int x : chain_fwd) {
+        if (dist_fwd[x] == kInfinity) continue;
+        arcs_scanned += arc_offsets[x + 1] - arc_offsets[x];
+        for (int a = arc_offsets[x]; a < arc_offsets[x + 1]; ++a) {
+            double candidate = dist_fwd[x] + up_cost[a];
+            if (candidate < dist_fwd[arc_head[a]]) {
+                dist_fwd[arc_head[a]] = candidate;
+                arc_fwd[arc_head[a]] = a;
+            }
+        }
+    }
+    // Backward: higher ranks -> end using downward costs
+    dist_bwd[chain_bwd.front()] = 0;
+    for (int x : chain_bwd) {
+        if (dist_bwd[x] == kInfinity) continue;
+        arcs_scanned += arc_offsets[x + 1] - arc_offsets[x];
+        for (int a = arc_offsets[x]; a < arc_offsets[x + 1]; ++a) {
+            double candidate = dist_bwd[x] + down_cost[a];
+            if (candidate < dist_bwd[arc_head[a]]) {
+                dist_bwd[arc_head[a]] = candidate;
+                arc_bwd[arc_head[a]] = a;
+            }
+        }
+    }
+
+    // Meeting rank: only ranks on both chains can have finite costs on both sides
+    double best = kInfinity;
+    int meet = -1;
+    for (int x : chain_fwd) {
+        if (dist_fwd[x] + dist_bwd[x] < best) {
+            best = dist_fwd[x] + dist_bwd[x];
+            meet = x;
+        }
+    }
+
+    // Collect the arc sequence start -> meet -> end and unpack it to original edges
+    std::vector<int> edges;
+    if (meet >= 0) {
+        std::vector<int> up_arcs;
+        for (int x = meet; x != rank_of[start]; x = arc_tail[arc_fwd[x]]) up_arcs.push_back(arc_fwd[x]);
+        for (auto it = up_arcs.rbegin(); it != up_arcs.rend(); ++it) unpack(*it, true, edges);
+        for (int x = meet; x != rank_of[end]; x = arc_tail[arc_bwd[x]]) unpack(arc_bwd[x], false, edges);
+    }
+
+    // Reset the scratch entries this query wrote (chains are closed under arc heads)
+    for (int x : chain_fwd) { dist_fwd[x] = kInfinity; arc_fwd[x] = -1; }
+    for (int x : chain_bwd) { dist_bwd[x] = kInfinity; arc_bwd[x] = -1; }
+
+    SearchStats stats;
+    stats.nodes_settled = static_cast<int>(chain_fwd.size() + chain_bwd.size());
+    stats.edges_relaxed = arcs_scanned;
+    if (meet < 0) return {{}, 0, 0, false, stats, 0};
+
+    return Dijkstra::summarize_path(graph, overlay, start, edges, best, stats);
+}
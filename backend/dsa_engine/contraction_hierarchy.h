@@ -0,0 +1,82 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include "csr_graph.h"
+#include "weight_overlay.h"
+#include "dijkstra.h"
+#include <vector>
+
+/**
+ * ContractionHierarchy Class
+ * A Customizable Contraction Hierarchy (CCH) for hazard-weighted routing.
+ *
+ * Work is split into three phases:
+ * 1. Preprocessing (constructor, once per road network, metric independent):
+ *    ranks every intersection with a nested-dissection order and "contracts"
+ *    them lowest-first, adding shortcut arcs so the upward graph is chordal.
+ * 2. Customization (customize, whenever hazards change): loads the current
+ *    edge costs into the arcs and propagates them through lower triangles.
+ *    This is linear in the number of triangles, i.e. milliseconds.
+ * 3. Query (find_safest_path): walks the elimination tree upward from both
+ *    ends; only the ancestors of the two endpoints are ever touched.
+ *
+ * Arcs connect a lower-ranked node to a higher-ranked node and carry one cost
+ * per direction, so one-way roads are supported.
+ */
+class ContractionHierarchy {
+private:
+    int node_total = 0;
+
+    // Internal node index -> rank (contraction position) and the inverse mapping
+    std::vector<int> rank_of;
+    std::vector<int> node_at_rank;
+    // Elimination tree: lowest-ranked upward neighbor of each rank (-1 for roots)
+    std::vector<int> parent;
+
+    // Upward arcs, grouped by the rank of their lower endpoint (CSR layout).
+    // Heads inside a group are sorted, so arc lookup is a binary search.
+    std::vector<int> arc_offsets;
+    std::vector<int> arc_tail;     // Rank of the lower endpoint
+    std::vector<int> arc_head;     // Rank of the higher endpoint
+    // Original CSR edge -> arc carrying it
+    std::vector<int> arc_of_edge;
+
+    // Customized metric. "up" = lower -> higher endpoint, "down" = higher -> lower.
+    std::vector<double> up_cost;
+    std::vector<double> down_cost;
+    // How each cost was obtained: the rank of the middle node of the shortcut
+    // triangle, or -1 if the cost comes straight from an original edge
+    std::vector<int> up_via;
+    std::vector<int> down_via;
+    // Original edge behind a non-shortcut cost (-1 if the arc has no such edge)
+    std::vector<int> up_edge;
+    std::vector<int> down_edge;
+    bool customized = false;
+
+    // Builds the contraction order by recursive coordinate bisection
+    void compute_order(const CSRGraph& graph);
+    // Returns the arc between ranks low < high (it always exists for triangle members)
+    int find_arc(int low, int high) const;
+    // Expands an arc into the original edges it represents, appending them to 'edges'
+    void unpack(int arc, bool upward, std::vector<int>& edges) const;
+
+public:
+    // Preprocessing: ordering + contraction of the road topology
+    explicit ContractionHierarchy(const CSRGraph& graph);
+
+    // Applies the current edge costs (static weight + overlay penalty) to the hierarchy
+    void customize(const CSRGraph& graph, const WeightOverlay* overlay);
+
+    // True once customize() has run at least once
+    bool is_customized() const { return customized; }
+
+    // Number of arcs, including the shortcuts added by contraction
+    int arc_count() const { return static_cast<int>(arc_head.size()); }
+
+    // Same contract as Dijkstra::find_safest_path, using the customized metric.
+    // 'overlay' must be the one passed to the last customize() (for the safety score).
+    PathResult find_safest_path(const CSRGraph& graph, const WeightOverlay* overlay,
+                                int start_node, int end_node) const;
+};
+
+#endif // CONTRACTION_HIERARCHY_H
@@ -0,0 +1,86 @@
+#ifndef COST_POLICIES_H
+#define COST_POLICIES_H
+
+#include "csr_graph.h"
+#include "weight_overlay.h"
+#include <algorithm>
+
+/**
+ * Cost Policies
+ * Each policy is a stateless struct that the searches are instantiated with, so
+ * the chosen cost model is inlined into the relaxation loop (no virtual calls).
+ * A policy provides:
+ *   cost(graph, overlay, e)  routing cost of edge e, live hazard penalty included
+ *   base(graph, e)           the same cost without the overlay; never above cost(),
+ *                            so it yields a valid A* lower bound for the policy
+ * All costs are non-negative, except where StandardCost keeps the original formula.
+ *
+ * The CSR columns give length L, static hazard H and weight W = L + H - S, so the
+ * safety bonus S of an edge is recovered as L + H - W. P is the overlay penalty.
+ */
+
+// Safety bonus S of edge e (see above)
+inline double edge_safety_bonus(const CSRGraph& graph, int e) {
+    return graph.edge_length(e) + graph.edge_hazard(e) - graph.edge_weight(e);
+}
+
+/**
+ * StandardCost ("mode=standard", the default)
+ * The original AMAAN formula: L + H - S + P.
+ */
+struct StandardCost {
+    static double base(const CSRGraph& graph, int e) { return graph.edge_weight(e); }
+    static double cost(const CSRGraph& graph, const WeightOverlay* overlay, int e) {
+        return routing_cost(graph, overlay, e);
+    }
+};
+
+/**
+ * EtaCost ("mode=eta")
+ * Pure road length, for travel-time estimates: hazards and bonuses are ignored.
+ */
+struct EtaCost {
+    static double base(const CSRGraph& graph, int e) { return graph.edge_length(e); }
+    static double cost(const CSRGraph& graph, const WeightOverlay*, int e) { return graph.edge_length(e); }
+};
+
+/**
+ * NightCost ("mode=night")
+ * Hazards weigh three times as much after dark: L + 3(H + P) - S, floored at zero.
+ */
+struct NightCost {
+    static constexpr double kHazardFactor = 3.0;
+    static double base(const CSRGraph& graph, int e) {
+        return std::max(0.0, graph.edge_length(e) + kHazardFactor * graph.edge_hazard(e) - edge_safety_bonus(graph, e));
+    }
+    static double cost(const CSRGraph& graph, const WeightOverlay* overlay, int e) {
+        double value = graph.edge_length(e) + kHazardFactor * graph.edge_hazard(e) - edge_safety_bonus(graph, e);
+        if (overlay) value += kHazardFactor * overlay->penalty(e);
+        return std::max(0.0, value);
+    }
+};
+
+/**
+ * VulnerableCost ("mode=vulnerable")
+ * For users who should stay on lit, secured roads: L + 2(H + P) - 3S. The bonus can
+ * outweigh the length, so the cost is floored at 10% of L; a secured detour is
+ * strongly preferred but never free.
+ */
+struct VulnerableCost {
+    static constexpr double kHazardFactor = 2.0;
+    static constexpr double kSafetyFactor = 3.0;
+    static constexpr double kMinLengthShare = 0.1;
+    static double base(const CSRGraph& graph, int e) {
+        const double length = graph.edge_length(e);
+        return std::max(kMinLengthShare * length,
+                        length + kHazardFactor * graph.edge_hazard(e) - kSafetyFactor * edge_safety_bonus(graph, e));
+    }
+    static double cost(const CSRGraph& graph, const WeightOverlay* overlay, int e) {
+        const double length = graph.edge_length(e);
+        double value = length + kHazardFactor * graph.edge_hazard(e) - kSafetyFactor * edge_safety_bonus(graph, e);
+        if (overlay) value += kHazardFactor * overlay->penalty(e);
+        return std::max(kMinLengthShare * length, value);
+    }
+};
+
+#endif // COST_POLICIES_H
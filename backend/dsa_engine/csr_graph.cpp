@@ -0,0 +1,235 @@
+#include "csr_graph.h"
+#include "geo.h"
+#include <stdexcept>
+#include <string>
+#include <numeric>
+
+namespace {
+
+/**
+ * OwnedColumns
+ * The arrays of a CSRGraph compiled in memory. Shared (read-only) by all copies.
+ */
+struct OwnedColumns {
+    std::vector<int32_t> node_ids, sorted_ids, sorted_index;
+    std::vector<double> latitudes, longitudes;
+    std::vector<uint32_t> name_offsets;
+    std::string name_chars;
+    std::vector<int32_t> offsets, sources, targets;
+    std::vector<double> weights, lengths, hazards;
+    std::vector<int32_t> in_offsets, in_edges;
+};
+
+/**
+ * build_reverse_adjacency
+ * Counting sort over the target column: the IDs of the edges arriving at each node.
+ */
+void build_reverse_adjacency(OwnedColumns& data, int node_total, int edge_total) {
+    data.in_offsets.assign(node_total + 1, 0);
+    for (int e = 0; e < edge_total; ++e) {
+        data.in_offsets[data.targets[e] + 1]++;
+    }
+    for (int v = 0; v < node_total; ++v) {
+        data.in_offsets[v + 1] += data.in_offsets[v];
+    }
+    data.in_edges.resize(edge_total);
+    std::vector<int> cursor(data.in_offsets.begin(), data.in_offsets.end() - 1);
+    for (int e = 0; e < edge_total; ++e) {
+        data.in_edges[cursor[data.targets[e]]++] = e;
+    }
+}
+
+/**
+ * build_id_lookup
+ * IDs sorted ascending with the internal index of each (CSRGraph::index_of).
+ */
+void build_id_lookup(OwnedColumns& data, int node_total) {
+    data.sorted_index.resize(node_total);
+    std::iota(data.sorted_index.begin(), data.sorted_index.end(), 0);
+    std::sort(data.sorted_index.begin(), data.sorted_index.end(),
+              [&](int a, int b) { return data.node_ids[a] < data.node_ids[b]; });
+    data.sorted_ids.resize(node_total);
+    for (int i = 0; i < node_total; ++i) data.sorted_ids[i] = data.node_ids[data.sorted_index[i]];
+}
+
+// Points a column view at the owned arrays
+CSRGraph::Columns view_of(const OwnedColumns& data) {
+    CSRGraph::Columns cols;
+    cols.node_ids = data.node_ids.data();
+    cols.sorted_ids = data.sorted_ids.data();
+    cols.sorted_index = data.sorted_index.data();
+    cols.latitudes = data.latitudes.data();
+    cols.longitudes = data.longitudes.data();
+    cols.name_offsets = data.name_offsets.data();
+    cols.name_chars = data.name_chars.data();
+    cols.offsets = data.offsets.data();
+    cols.sources = data.sources.data();
+    cols.targets = data.targets.data();
+    cols.weights = data.weights.data();
+    cols.lengths = data.lengths.data();
+    cols.hazards = data.hazards.data();
+    cols.in_offsets = data.in_offsets.data();
+    cols.in_edges = data.in_edges.data();
+    return cols;
+}
+
+} // namespace
+
+/**
+ * CSRGraph::CSRGraph
+ * Two passes over the adjacency list:
+ * 1. Assign dense indices in ascending ID order (same order as Graph::get_all_node_ids).
+ * 2. Write each node's edges into its slice of the packed edge arrays.
+ * A counting sort over edge targets then produces the reverse adjacency, and a
+ * final scan derives the A* heuristic factor.
+ */
+CSRGraph::CSRGraph(const Graph& graph) {
+    auto data = std::make_shared<OwnedColumns>();
+    std::vector<int> ids = graph.get_all_node_ids();
+    node_total = static_cast<int>(ids.size());
+
+    // Pass 1: dense renumbering and node columns
+    data->node_ids.assign(ids.begin(), ids.end());
+    data->latitudes.reserve(node_total);
+    data->longitudes.reserve(node_total);
+    data->name_offsets.assign(1, 0);
+    data->offsets.assign(node_total + 1, 0);
+    for (int i = 0; i < node_total; ++i) {
+        const Node& n = graph.get_node(ids[i]);
+        data->latitudes.push_back(n.latitude);
+        data->longitudes.push_back(n.longitude);
+        data->name_chars += n.name;
+        data->name_offsets.push_back(static_cast<uint32_t>(data->name_chars.size()));
+        data->offsets[i + 1] = data->offsets[i] + static_cast<int>(graph.get_neighbors(n.id).size());
+    }
+
+    // ID lookup table: IDs sorted ascending with the internal index of each
+    build_id_lookup(*data, node_total);
+    cols.sorted_ids = data->sorted_ids.data();
+    cols.sorted_index = data->sorted_index.data();
+
+    // Pass 2: packed edge columns
+    edge_total = data->offsets[node_total];
+    data->sources.reserve(edge_total);
+    data->targets.reserve(edge_total);
+    data->weights.reserve(edge_total);
+    data->lengths.reserve(edge_total);
+    data->hazards.reserve(edge_total);
+    for (int i = 0; i < node_total; ++i) {
+        for (const auto& edge : graph.get_neighbors(ids[i])) {
+            // Edges may only point at known nodes, otherwise the index table is incomplete
+            int target = index_of(edge.destination_id);
+            if (target < 0) {
+                throw std::runtime_error("Critical Error: Edge to unknown node " + std::to_string(edge.destination_id) + " while compiling CSR graph.");
+            }
+            data->sources.push_back(i);
+            data->targets.push_back(target);
+            data->weights.push_back(edge.get_weight());
+            data->lengths.push_back(edge.distance);
+            data->hazards.push_back(edge.hazard_penalty);
+        }
+    }
+
+    // Pass 3: reverse adjacency via counting sort on the target column
+    build_reverse_adjacency(*data, node_total, edge_total);
+
+    // Pass 4: the tightest ratio of routing weight to straight-line length.
+    // Edges whose endpoints coincide give no geometric constraint and are skipped.
+    heuristic_factor = edge_total > 0 ? 1e18 : 0.0;
+    for (int e = 0; e < edge_total; ++e) {
+        int u = data->sources[e], v = data->targets[e];
+        double straight = geo::haversine_km(data->latitudes[u], data->longitudes[u],
+                                            data->latitudes[v], data->longitudes[v]);
+        if (straight <= 0) continue;
+        heuristic_factor = std::min(heuristic_factor, std::max(0.0, data->weights[e]) / straight);
+    }
+    if (heuristic_factor == 1e18) heuristic_factor = 0.0;
+
+    // Point the column views at the owned arrays
+    cols = view_of(*data);
+    backing = data;
+}
+
+/**
+ * CSRGraph::CSRGraph (adopting constructor)
+ * Wraps arrays that already exist in CSR layout, e.g. inside a mapped file.
+ */
+CSRGraph::CSRGraph(int nodes, int edges, const Columns& columns, double heuristic_scale,
+                   std::shared_ptr<const void> backing_memory)
+    : node_total(nodes), edge_total(edges), cols(columns),
+      backing(std::move(backing_memory)), heuristic_factor(heuristic_scale) {}
+
+/**
+ * CSRGraph::lower_bound_scale
+ * Same scan as pass 4 of the compiling constructor, over 'base' instead of the
+ * weight column. The result is cached per function for the graph's lifetime, so
+ * a graph later built at the same address never sees it.
+ */
+double CSRGraph::lower_bound_scale(double (*base)(const CSRGraph& graph, int edge)) const {
+    std::lock_guard<std::mutex> lock(scale_cache->mutex);
+    for (const auto& cached : scale_cache->scales) {
+        if (cached.first == base) return cached.second;
+    }
+
+    double scale = edge_total > 0 ? 1e18 : 0.0;
+    for (int e = 0; e < edge_total; ++e) {
+        int u = cols.sources[e], v = cols.targets[e];
+        double straight = geo::haversine_km(cols.latitudes[u], cols.longitudes[u], cols.latitudes[v], cols.longitudes[v]);
+        if (straight <= 0) continue;
+        scale = std::min(scale, std::max(0.0, base(*this, e)) / straight);
+    }
+    if (scale == 1e18) scale = 0.0;
+    scale_cache->scales.push_back({base, scale});
+    return scale;
+}
+
+/**
+ * CSRGraph::permuted
+ * Node columns are gathered in the new order; each node's edges are copied as a
+ * block (keeping their order) with both endpoints translated. The ID lookup table
+ * and the reverse adjacency are rebuilt for the new indices.
+ */
+CSRGraph CSRGraph::permuted(const std::vector<int>& order) const {
+    if (order.size() != static_cast<size_t>(node_total)) {
+        throw std::invalid_argument("CSRGraph::permuted: order must list every node once");
+    }
+    std::vector<int> new_index(node_total, -1);
+    for (int i = 0; i < node_total; ++i) {
+        if (order[i] < 0 || order[i] >= node_total || new_index[order[i]] >= 0) {
+            throw std::invalid_argument("CSRGraph::permuted: order must list every node once");
+        }
+        new_index[order[i]] = i;
+    }
+
+    auto data = std::make_shared<OwnedColumns>();
+    data->node_ids.reserve(node_total);
+    data->latitudes.reserve(node_total);
+    data->longitudes.reserve(node_total);
+    data->name_offsets.assign(1, 0);
+    data->offsets.assign(node_total + 1, 0);
+    data->sources.reserve(edge_total);
+    data->targets.reserve(edge_total);
+    data->weights.reserve(edge_total);
+    data->lengths.reserve(edge_total);
+    data->hazards.reserve(edge_total);
+    for (int i = 0; i < node_total; ++i) {
+        const int old = order[i];
+        data->node_ids.push_back(cols.node_ids[old]);
+        data->latitudes.push_back(cols.latitudes[old]);
+        data->longitudes.push_back(cols.longitudes[old]);
+        data->name_chars.append(cols.name_chars + cols.name_offsets[old], cols.name_chars + cols.name_offsets[old + 1]);
+        data->name_offsets.push_back(static_cast<uint32_t>(data->name_chars.size()));
+        for (int e = edge_begin(old); e < edge_end(old); ++e) {
+            data->sources.push_back(i);
+            data->targets.push_back(new_index[cols.targets[e]]);
+            data->weights.push_back(cols.weights[e]);
+            data->lengths.push_back(cols.lengths[e]);
+            data->hazards.push_back(cols.hazards[e]);
+        }
+        data->offsets[i + 1] = static_cast<int>(data->sources.size());
+    }
+    build_id_lookup(*data, node_total);
+    build_reverse_adjacency(*data, node_total, edge_total);
+
+    return CSRGraph(node_total, edge_total, view_of(*data), heuristic_factor, data);
+}
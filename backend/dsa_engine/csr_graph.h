@@ -0,0 +1,140 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include "graph.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * CSRGraph Class
+ * A frozen, contiguous "Compressed Sparse Row" snapshot of a Graph.
+ * Nodes are renumbered to dense internal indices [0, V) and the outgoing edges
+ * of node u occupy the slice [offsets[u], offsets[u + 1]) of the packed edge arrays.
+ * Rationale: neighbor access becomes O(1) array indexing instead of a std::map walk,
+ * and the Dijkstra relaxation loop streams through memory sequentially.
+ * The graph is immutable once compiled; rebuild it if the source Graph changes.
+ *
+ * Every column is a plain array. The arrays are either owned by the graph
+ * (when compiled from a Graph) or live inside a memory-mapped graph file
+ * (see GraphFile), so loading a prebuilt city costs no parsing or copying.
+ * Copies are cheap and share the same immutable arrays.
+ */
+class CSRGraph {
+public:
+    /**
+     * Columns
+     * Raw pointers to every array of the graph (V = nodes, E = edges).
+     */
+    struct Columns {
+        const int32_t* node_ids = nullptr;      // [V] Index -> external Node ID
+        const int32_t* sorted_ids = nullptr;    // [V] External IDs in ascending order...
+        const int32_t* sorted_index = nullptr;  // [V] ...and the internal index of each (ID lookup table)
+        const double* latitudes = nullptr;      // [V] Node coordinates, column-wise
+        const double* longitudes = nullptr;     // [V]
+        const uint32_t* name_offsets = nullptr; // [V + 1] Slice of 'name_chars' holding each node name
+        const char* name_chars = nullptr;       // String table of all node names
+        const int32_t* offsets = nullptr;       // [V + 1] offsets[u]..offsets[u + 1] is the edge slice of u
+        const int32_t* sources = nullptr;       // [E] Internal index of the origin node
+        const int32_t* targets = nullptr;       // [E] Internal index of the destination node
+        const double* weights = nullptr;        // [E] Precomputed Edge::get_weight() (routing cost)
+        const double* lengths = nullptr;        // [E] Physical length in kilometers
+        const double* hazards = nullptr;        // [E] Static hazard penalty (for the safety score)
+        const int32_t* in_offsets = nullptr;    // [V + 1] Reverse adjacency: slice of 'in_edges' per node
+        const int32_t* in_edges = nullptr;      // [E] IDs of the edges arriving at each node
+    };
+
+private:
+    int node_total = 0;
+    int edge_total = 0;
+    Columns cols;
+    // Keeps the memory behind 'cols' alive (owned vectors or a mapped file)
+    std::shared_ptr<const void> backing;
+
+    // Largest factor k such that every edge weight >= k * straight-line length (km).
+    // Makes k * haversine(v, target) an admissible, consistent A* heuristic as long
+    // as live penalties only add cost. Zero if safety bonuses can cancel a road's length.
+    double heuristic_factor = 0.0;
+
+    // The same factor for other edge costs (see lower_bound_scale), found on first use.
+    // Shared by copies of the graph, which share its columns.
+    struct ScaleCache {
+        std::mutex mutex;
+        std::vector<std::pair<double (*)(const CSRGraph&, int), double>> scales;
+    };
+    std::shared_ptr<ScaleCache> scale_cache = std::make_shared<ScaleCache>();
+
+public:
+    // Creates an empty graph
+    CSRGraph() = default;
+
+    // Compiles an adjacency-list Graph into CSR form. O(V + E).
+    explicit CSRGraph(const Graph& graph);
+
+    // Adopts columns owned by someone else (e.g. a mapped graph file). 'backing'
+    // must keep the memory valid for as long as any copy of this graph exists.
+    CSRGraph(int nodes, int edges, const Columns& columns, double heuristic_scale,
+             std::shared_ptr<const void> backing);
+
+    // Copy with the internal indices renumbered: new index i is old index order[i]
+    // ('order' must be a permutation of [0, V)). External IDs, coordinates and each
+    // node's edge list are unchanged; edge IDs follow the new node order. O(V + E).
+    CSRGraph permuted(const std::vector<int>& order) const;
+
+    int node_count() const { return node_total; }
+    int edge_count() const { return edge_total; }
+
+    // Raw access to all arrays (used by the graph file writer)
+    const Columns& columns() const { return cols; }
+
+    // Translates an external Node ID into its internal index, or -1 if unknown.
+    // Binary search over the sorted ID column: O(log V), needed only at query endpoints.
+    int index_of(int node_id) const {
+        const int32_t* last = cols.sorted_ids + node_total;
+        const int32_t* it = std::lower_bound(cols.sorted_ids, last, node_id);
+        return (it != last && *it == node_id) ? cols.sorted_index[it - cols.sorted_ids] : -1;
+    }
+
+    // Translates an internal index back into the external Node ID
+    int node_id(int index) const { return cols.node_ids[index]; }
+
+    // Human-readable name of a node (may be empty)
+    std::string node_name(int index) const {
+        return std::string(cols.name_chars + cols.name_offsets[index], cols.name_chars + cols.name_offsets[index + 1]);
+    }
+
+    double latitude(int index) const { return cols.latitudes[index]; }
+    double longitude(int index) const { return cols.longitudes[index]; }
+
+    // Whole coordinate columns (node_count() entries), for batch computations over every node
+    const double* node_latitudes() const { return cols.latitudes; }
+    const double* node_longitudes() const { return cols.longitudes; }
+
+    // Edge slice of a node: iterate e in [edge_begin(u), edge_end(u))
+    int edge_begin(int index) const { return cols.offsets[index]; }
+    int edge_end(int index) const { return cols.offsets[index + 1]; }
+
+    // Incoming edge IDs of a node: iterate i in [in_edge_begin(v), in_edge_end(v)) and read in_edge(i)
+    int in_edge_begin(int index) const { return cols.in_offsets[index]; }
+    int in_edge_end(int index) const { return cols.in_offsets[index + 1]; }
+    int in_edge(int i) const { return cols.in_edges[i]; }
+
+    int edge_source(int edge) const { return cols.sources[edge]; }
+    int edge_target(int edge) const { return cols.targets[edge]; }
+    double edge_weight(int edge) const { return cols.weights[edge]; }
+    double edge_length(int edge) const { return cols.lengths[edge]; }
+    double edge_hazard(int edge) const { return cols.hazards[edge]; }
+
+    // Scale for the geographic lower bound used by A* (see heuristic_factor)
+    double heuristic_scale() const { return heuristic_factor; }
+
+    // Like heuristic_scale(), for edge costs 'base' instead of the weight column: the
+    // largest k with base(*this, e) >= k * straight-line length for every edge (negative
+    // costs count as zero). Scans the edges on the first call per function. O(E) once.
+    double lower_bound_scale(double (*base)(const CSRGraph& graph, int edge)) const;
+};
+
+#endif // CSR_GRAPH_H
@@ -1,98 +1,867 @@
 #include "dijkstra.h"
+#include "geo.h"
+#include "search_workspace.h"
+#include "priority_queues.h"
+#include "cost_policies.h"
+#include "graph_tiles.h"
+#include "hazards.h"
+#include "worker_pool.h"
 #include <set>
 #include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+const double kInfinity = 1e18;
 
 /**
- * find_safest_path
- * Core algorithm to find the optimal path through the city graph.
- * This implementation uses the standard Dijkstra's algorithm but with weights
- * that are pre-optimized to include hazard penalties.
+ * local_queue
+ * Per-thread queue of the requested type, kept between searches so its storage
+ * is reused. 'slot' gives bidirectional search a second, independent queue.
  */
-PathResult Dijkstra::find_safest_path(const Graph& graph, int start_node, int end_node) {
-    // Stores the minimum weight found to reach each node (ID -> Weight)
-    std::map<int, double> distances;
-    // Stores the predecessor of each node for path reconstruction (ID -> ID)
-    std::map<int, int> predecessors;
-    
-    // Priority Queue to always expand the node with the smallest cumulative weight next.
-    // Format: pair<cumulative_weight, node_id>
-    // We use std::greater to turn the default max-heap into a min-heap.
-    std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> pq;
+template <typename Queue>
+Queue& local_queue(int slot = 0) {
+    thread_local Queue queues[2];
+    return queues[slot];
+}
+
+/**
+ * safety_score_for
+ * Safety score logic: 100 is perfect, subtract based on hazard density.
+ * We scale the hazard sum by distance to reflect "safety per km".
+ */
+double safety_score_for(double hazard_sum, double real_dist) {
+    double safety_score = 100.0 - (hazard_sum / (real_dist + 0.1) * 10.0);
+    if (safety_score < 0) safety_score = 0; // Cap floor at zero
+    return safety_score;
+}
 
-    // Initialization: Set all distances to 'infinity'
-    for (int id : graph.get_all_node_ids()) {
-        distances[id] = 1e18; 
+/**
+ * collect_path_edges
+ * Walks the predecessor edges stored in 'ws' back from 'node' to the search origin
+ * and returns them in origin -> node order.
+ */
+std::vector<int> collect_path_edges(const CSRGraph& graph, const SearchWorkspace& ws, int node) {
+    std::vector<int> edges;
+    for (int e = ws.parent_edge(node); e != -1; e = ws.parent_edge(graph.edge_source(e))) {
+        edges.push_back(e);
     }
+    std::reverse(edges.begin(), edges.end());
+    return edges;
+}
 
-    // Safety check: ensure the starting location exists in the graph
-    if (!graph.has_node(start_node)) return {{}, 0, 0, false};
+/**
+ * EdgePosition
+ * A share of one CSR edge: for a snapped point, how far along the edge it lies;
+ * for a route piece, how much of the edge the route travels.
+ */
+struct EdgePosition {
+    int edge;
+    double fraction;
+};
+
+/**
+ * summarize_pieces
+ * summarize_path for routes that start or end inside an edge: each piece adds
+ * its share of the edge's length and hazard impact. 'nodes' are the internal
+ * indices of the intersections passed, reported as external Node IDs.
+ */
+PathResult summarize_pieces(const CSRGraph& graph, const WeightOverlay* overlay, const std::vector<EdgePosition>& pieces,
+                            const std::vector<int>& nodes, double total_cost, const SearchStats& stats) {
+    double real_dist = 0;
+    double hazard_sum = 0;
+    for (const EdgePosition& piece : pieces) {
+        double hazard = graph.edge_hazard(piece.edge);
+        if (overlay) hazard += overlay->penalty(piece.edge);
+        real_dist += piece.fraction * graph.edge_length(piece.edge);
+        hazard_sum += piece.fraction * hazard;
+    }
+    std::vector<int> path;
+    path.reserve(nodes.size());
+    for (int v : nodes) path.push_back(graph.node_id(v));
+    return {path, real_dist, safety_score_for(hazard_sum, real_dist), true, stats, total_cost};
+}
+
+/**
+ * heuristic_scale_for
+ * A* scale for a cost policy: the smallest ratio of the policy's static cost to
+ * the straight-line length of any edge. The standard policy uses the scale stored
+ * with the graph; the graph works out the others on first use.
+ */
+template <typename Cost>
+double heuristic_scale_for(const CSRGraph& graph) {
+    return graph.lower_bound_scale(&Cost::base);
+}
+
+template <>
+double heuristic_scale_for<StandardCost>(const CSRGraph& graph) {
+    return graph.heuristic_scale();
+}
+
+/**
+ * search_unidirectional
+ * Classic Dijkstra when 'goal_directed' is false. When true this becomes A*:
+ * the queue is ordered by cost-so-far + scale * haversine(node, end), which
+ * never overestimates because every edge costs at least scale * its length.
+ */
+template <typename Cost, typename Queue>
+PathResult search_unidirectional(const CSRGraph& graph, const WeightOverlay* overlay, int start, int end, bool goal_directed) {
+    // Per-thread distance / predecessor-edge arrays, reset in O(1) by a generation bump
+    SearchWorkspace& ws = SearchWorkspace::local();
+    ws.begin(graph.node_count());
+
+    // A* lower bound per node, stored in the workspace's aux slot the first time the node is reached
+    const double scale = goal_directed ? heuristic_scale_for<Cost>(graph) : 0.0;
+    auto lower_bound = [&](int v) {
+        if (scale <= 0) return 0.0;
+        return scale * geo::haversine_km(graph.latitude(v), graph.longitude(v),
+                                         graph.latitude(end), graph.longitude(end));
+    };
+
+    // Priority Queue to always expand the most promising node next.
+    // Entries are (cost_so_far + lower_bound, node_index)
+    Queue& pq = local_queue<Queue>();
+    pq.reset(graph.node_count());
+    SearchStats stats;
 
     // The distance to the start node is always zero
-    distances[start_node] = 0;
-    pq.push({0, start_node});
+    ws.set(start, 0, -1);
+    ws.aux(start) = lower_bound(start);
+    pq.push(start, ws.aux(start));
+    stats.queue_pushes = 1;
+    stats.peak_queue_size = 1;
 
     // Main Dijkstra Loop
     while (!pq.empty()) {
-        double current_dist = pq.top().first; // Cumulative weight of current path
-        int u = pq.top().second;            // ID of the node we are visiting
+        double key = pq.top().first; // Cumulative weight (+ lower bound) of current path
+        int u = pq.top().second;     // Index of the node we are visiting
         pq.pop();
 
         // Optimization: If we found a shorter path to 'u' already, skip this entry
-        if (current_dist > distances[u]) continue;
+        const double dist_u = ws.distance(u);
+        if (key > dist_u + ws.aux(u)) continue;
+        stats.nodes_settled++;
         
         // Target optimization: If we reached the destination, we can stop early
-        if (u == end_node) break;
+        if (u == end) break;
 
-        // Explore all roads (edges) leading away from current node 'u'
-        for (const auto& edge : graph.get_neighbors(u)) {
+        // Explore all roads (edges) leading away from current node 'u': a contiguous slice
+        for (int e = graph.edge_begin(u); e < graph.edge_end(u); ++e) {
             // The edge weight here includes both the physical distance AND hazard penalty
-            double weight = edge.get_weight();
+            stats.edges_relaxed++;
+            const int v = graph.edge_target(e);
+            const double candidate = dist_u + Cost::cost(graph, overlay, e);
             
-            // Relaxation Step: If moving through 'u' to 'edge.destination_id' is shorter
+            // Relaxation Step: If moving through 'u' to 'v' is shorter
             // than any path we've seen before, update it.
-            if (distances[u] + weight < distances[edge.destination_id]) {
-                distances[edge.destination_id] = distances[u] + weight;
-                predecessors[edge.destination_id] = u; // Record how we got here
-                pq.push({distances[edge.destination_id], edge.destination_id});
+            if (candidate < ws.distance(v)) {
+                const bool first_visit = !ws.reached(v);
+                ws.set(v, candidate, e); // Record the road we came in on
+                if (first_visit) ws.aux(v) = lower_bound(v);
+                pq.push(v, candidate + ws.aux(v));
+                stats.queue_pushes++;
+                stats.peak_queue_size = std::max(stats.peak_queue_size, pq.size());
             }
         }
     }
 
-    // Path Reconstruction logic: Trace back from destination to start using predecessors
-    if (distances[end_node] == 1e18) {
-        // If the distance is still 'infinity', no path exists
-        return {{}, 0, 0, false};
+    // If the destination was never reached, no path exists
+    if (!ws.reached(end)) {
+        return {{}, 0, 0, false, stats, 0};
     }
 
+    // Path Reconstruction: follow the predecessor edges back to the start
+    return Dijkstra::summarize_path(graph, overlay, start, collect_path_edges(graph, ws, end), ws.distance(end), stats);
+}
+
+/**
+ * search_bidirectional
+ * Runs a forward search from 'start' over outgoing roads and a backward search
+ * from 'end' over incoming roads, always advancing the side with the smaller
+ * queue head. 'best' tracks the cheapest start->end connection seen where the
+ * two searches touch; once the two queue heads together cannot beat it, the
+ * answer is optimal.
+ */
+template <typename Cost, typename Queue>
+PathResult search_bidirectional(const CSRGraph& graph, const WeightOverlay* overlay, int start, int end) {
+    // Forward parent edges lead back to 'start'; backward ones lead on towards 'end'
+    SearchWorkspace& fwd = SearchWorkspace::local(0);
+    SearchWorkspace& bwd = SearchWorkspace::local(1);
+    fwd.begin(graph.node_count());
+    bwd.begin(graph.node_count());
+    Queue& pq_fwd = local_queue<Queue>(0);
+    Queue& pq_bwd = local_queue<Queue>(1);
+    pq_fwd.reset(graph.node_count());
+    pq_bwd.reset(graph.node_count());
+
+    double best = kInfinity;
+    int meeting_node = -1;
+    SearchStats stats;
+
+    // Records a candidate connection through node v
+    auto touch = [&](int v) {
+        if (fwd.distance(v) + bwd.distance(v) < best) {
+            best = fwd.distance(v) + bwd.distance(v);
+            meeting_node = v;
+        }
+    };
+
+    fwd.set(start, 0, -1);
+    bwd.set(end, 0, -1);
+    pq_fwd.push(start, 0);
+    pq_bwd.push(end, 0);
+    stats.queue_pushes = 2;
+    stats.peak_queue_size = 2;
+    touch(start);
+
+    while (!pq_fwd.empty() && !pq_bwd.empty()) {
+        // Stopping criterion: no undiscovered connection can be cheaper than 'best'
+        if (pq_fwd.top().first + pq_bwd.top().first >= best) break;
+
+        const bool forward = pq_fwd.top().first <= pq_bwd.top().first;
+        Queue& pq = forward ? pq_fwd : pq_bwd;
+        SearchWorkspace& ws = forward ? fwd : bwd;
+
+        double current_dist = pq.top().first;
+        int u = pq.top().second;
+        pq.pop();
+        if (current_dist > ws.distance(u)) continue; // Stale entry
+        stats.nodes_settled++;
+
+        if (forward) {
+            // Forward step: relax roads leaving 'u'
+            for (int e = graph.edge_begin(u); e < graph.edge_end(u); ++e) {
+                stats.edges_relaxed++;
+                const int v = graph.edge_target(e);
+                const double candidate = current_dist + Cost::cost(graph, overlay, e);
+                if (candidate < fwd.distance(v)) {
+                    fwd.set(v, candidate, e);
+                    pq_fwd.push(v, candidate);
+                    stats.queue_pushes++;
+                    stats.peak_queue_size = std::max(stats.peak_queue_size, pq_fwd.size() + pq_bwd.size());
+                    touch(v);
+                }
+            }
+        } else {
+            // Backward step: relax roads arriving at 'u', walking them in reverse
+            for (int i = graph.in_edge_begin(u); i < graph.in_edge_end(u); ++i) {
+                const int e = graph.in_edge(i);
+                stats.edges_relaxed++;
+                const int v = graph.edge_source(e);
+                const double candidate = current_dist + Cost::cost(graph, overlay, e);
+                if (candidate < bwd.distance(v)) {
+                    bwd.set(v, candidate, e);
+                    pq_bwd.push(v, candidate);
+                    stats.queue_pushes++;
+                    stats.peak_queue_size = std::max(stats.peak_queue_size, pq_fwd.size() + pq_bwd.size());
+                    touch(v);
+                }
+            }
+        }
+    }
+
+    if (meeting_node < 0) {
+        // The two searches never touched: no path exists
+        return {{}, 0, 0, false, stats, 0};
+    }
+
+    // Stitch the two halves together at the meeting node
+    std::vector<int> edges = collect_path_edges(graph, fwd, meeting_node);
+    for (int e = bwd.parent_edge(meeting_node); e != -1; e = bwd.parent_edge(graph.edge_target(e))) {
+        edges.push_back(e);
+    }
+    return Dijkstra::summarize_path(graph, overlay, start, edges, best, stats);
+}
+
+/**
+ * search_snapped
+ * Dijkstra between two points lying on roads (see EdgeIndex). The start point
+ * acts as a virtual node inside its edge: it reaches the edge's head for the
+ * remaining share of the edge cost and, on a two-way road, the tail through
+ * the twin edge. The end point is reached the same way from the tail of its
+ * edge or of the twin. 'best' is the cheapest complete route seen so far, and
+ * the search stops once the queue head cannot improve on it.
+ */
+template <typename Cost, typename Queue>
+PathResult search_snapped(const CSRGraph& graph, const WeightOverlay* overlay, const RoadSnap& from, const RoadSnap& to) {
+    SearchWorkspace& ws = SearchWorkspace::local();
+    ws.begin(graph.node_count());
+    Queue& pq = local_queue<Queue>();
+    pq.reset(graph.node_count());
+    SearchStats stats;
+
+    // Each snapped point seen from both directions of its road: (edge, fraction along it)
+    const EdgePosition starts[2] = {{from.edge, from.fraction}, {from.reverse_edge, 1.0 - from.fraction}};
+    const EdgePosition ends[2] = {{to.edge, to.fraction}, {to.reverse_edge, 1.0 - to.fraction}};
+    auto partial = [&](int e, double share) { return share * Cost::cost(graph, overlay, e); };
+
+    // Both points on the same directed edge, the end ahead of the start: no intersection needed
+    double best = kInfinity;
+    struct { int edge; double start, fraction; } direct = {-1, 0, 0};
+    for (const EdgePosition& s : starts) {
+        for (const EdgePosition& t : ends) {
+            if (s.edge < 0 || s.edge != t.edge || t.fraction < s.fraction) continue;
+            const double candidate = partial(s.edge, t.fraction - s.fraction);
+            if (candidate < best) {
+                best = candidate;
+                direct = {s.edge, s.fraction, t.fraction - s.fraction};
+            }
+        }
+    }
+
+    // Seed the queue with the ends of the start point's road (and with its tail
+    // itself when the point sits exactly on it, so one-way roads can leave from there)
+    auto seed = [&](int v, double cost) {
+        if (cost < ws.distance(v)) {
+            ws.set(v, cost, -1);
+            pq.push(v, cost);
+            stats.queue_pushes++;
+        }
+    };
+    for (const EdgePosition& s : starts) {
+        if (s.edge < 0) continue;
+        seed(graph.edge_target(s.edge), partial(s.edge, 1.0 - s.fraction));
+        if (s.fraction <= 0.0) seed(graph.edge_source(s.edge), 0.0);
+    }
+    stats.peak_queue_size = pq.size();
+
+    // Where the best route leaves the graph: the intersection, and the partial edge
+    // from there to the end point (edge -1 when the end point is the intersection)
+    int exit_node = -1;
+    EdgePosition exit_piece = {-1, 0};
+    auto finish_at = [&](int u, double cost, const EdgePosition& piece) {
+        if (cost < best) {
+            best = cost;
+            exit_node = u;
+            exit_piece = piece;
+        }
+    };
+
+    while (!pq.empty()) {
+        const double current_dist = pq.top().first;
+        const int u = pq.top().second;
+        pq.pop();
+        if (current_dist > ws.distance(u)) continue; // Stale entry
+        if (current_dist >= best) break;             // No queued node can lead to a cheaper route
+        stats.nodes_settled++;
+
+        // Leaving the graph at 'u' along the end point's road
+        for (const EdgePosition& t : ends) {
+            if (t.edge < 0) continue;
+            if (graph.edge_source(t.edge) == u) finish_at(u, current_dist + partial(t.edge, t.fraction), t);
+            if (t.fraction >= 1.0 && graph.edge_target(t.edge) == u) finish_at(u, current_dist, {-1, 0});
+        }
+
+        for (int e = graph.edge_begin(u); e < graph.edge_end(u); ++e) {
+            stats.edges_relaxed++;
+            const int v = graph.edge_target(e);
+            const double candidate = current_dist + Cost::cost(graph, overlay, e);
+            if (candidate < ws.distance(v)) {
+                ws.set(v, candidate, e);
+                pq.push(v, candidate);
+                stats.queue_pushes++;
+                stats.peak_queue_size = std::max(stats.peak_queue_size, pq.size());
+            }
+        }
+    }
+
+    if (best == kInfinity) {
+        return {{}, 0, 0, false, stats, 0};
+    }
+    if (exit_node < 0) {
+        // Along a single road: list its end points only where the route touches them
+        std::vector<int> nodes;
+        if (direct.start <= 0.0) nodes.push_back(graph.edge_source(direct.edge));
+        if (direct.start + direct.fraction >= 1.0) nodes.push_back(graph.edge_target(direct.edge));
+        return summarize_pieces(graph, overlay, {{direct.edge, direct.fraction}}, nodes, best, stats);
+    }
+
+    // Partial start edge, the intersections between, partial end edge
+    const std::vector<int> edges = collect_path_edges(graph, ws, exit_node);
+    const int first = edges.empty() ? exit_node : graph.edge_source(edges.front());
+
+    std::vector<EdgePosition> pieces;
+    pieces.reserve(edges.size() + 2);
+    for (const EdgePosition& s : starts) {
+        if (s.edge >= 0 && graph.edge_target(s.edge) == first) {
+            pieces.push_back({s.edge, 1.0 - s.fraction});
+            break;
+        }
+    }
+    for (int e : edges) pieces.push_back({e, 1.0});
+    if (exit_piece.edge >= 0) pieces.push_back(exit_piece);
+
+    std::vector<int> nodes;
+    nodes.reserve(edges.size() + 1);
+    nodes.push_back(first);
+    for (int e : edges) nodes.push_back(graph.edge_target(e));
+    return summarize_pieces(graph, overlay, pieces, nodes, best, stats);
+}
+
+/**
+ * run_search
+ * Instantiates the requested strategy for one cost policy and queue type.
+ */
+template <typename Cost, typename Queue>
+PathResult run_search(const CSRGraph& graph, const WeightOverlay* overlay, int start, int end, SearchAlgorithm algorithm) {
+    switch (algorithm) {
+        case SearchAlgorithm::AStar:
+            return search_unidirectional<Cost, Queue>(graph, overlay, start, end, true);
+        case SearchAlgorithm::Bidirectional:
+            return search_bidirectional<Cost, Queue>(graph, overlay, start, end);
+        case SearchAlgorithm::Dijkstra:
+        default:
+            return search_unidirectional<Cost, Queue>(graph, overlay, start, end, false);
+    }
+}
+
+/**
+ * run_with_queue
+ * Resolves the queue type for a cost policy chosen by the caller.
+ */
+template <typename Cost>
+PathResult run_with_queue(const CSRGraph& graph, const WeightOverlay* overlay, int start, int end,
+                          SearchAlgorithm algorithm, QueueType queue) {
+    switch (queue) {
+        case QueueType::FourAryHeap:
+            return run_search<Cost, FourAryHeap>(graph, overlay, start, end, algorithm);
+        case QueueType::RadixHeap:
+            return run_search<Cost, RadixHeap>(graph, overlay, start, end, algorithm);
+        case QueueType::Buckets:
+            return run_search<Cost, BucketQueue>(graph, overlay, start, end, algorithm);
+        case QueueType::BinaryHeap:
+        default:
+            return run_search<Cost, BinaryHeap>(graph, overlay, start, end, algorithm);
+    }
+}
+
+/**
+ * snapped_with_queue
+ * Resolves the queue type of a search between snapped points.
+ */
+template <typename Cost>
+PathResult snapped_with_queue(const CSRGraph& graph, const WeightOverlay* overlay, const RoadSnap& from,
+                              const RoadSnap& to, QueueType queue) {
+    switch (queue) {
+        case QueueType::FourAryHeap:
+            return search_snapped<Cost, FourAryHeap>(graph, overlay, from, to);
+        case QueueType::RadixHeap:
+            return search_snapped<Cost, RadixHeap>(graph, overlay, from, to);
+        case QueueType::Buckets:
+            return search_snapped<Cost, BucketQueue>(graph, overlay, from, to);
+        case QueueType::BinaryHeap:
+        default:
+            return search_snapped<Cost, BinaryHeap>(graph, overlay, from, to);
+    }
+}
+
+/**
+ * search_bounded
+ * Plain Dijkstra under cost policy 'Cost' that never queues a node beyond the
+ * budget. The workspace's aux slot carries the route length of each node, so
+ * no predecessor walk is needed afterwards.
+ */
+template <typename Cost>
+Isochrone search_bounded(const CSRGraph& graph, const WeightOverlay* overlay, int origin, double budget) {
+    Isochrone result;
+    result.origin = graph.node_id(origin);
+    result.success = true;
+
+    SearchWorkspace& ws = SearchWorkspace::local();
+    ws.begin(graph.node_count());
+    BinaryHeap& pq = local_queue<BinaryHeap>();
+    pq.reset(graph.node_count());
+
+    ws.set(origin, 0, -1);
+    ws.aux(origin) = 0;
+    pq.push(origin, 0);
+    SearchStats& stats = result.stats;
+
+    while (!pq.empty()) {
+        stats.peak_queue_size = std::max(stats.peak_queue_size, pq.size());
+        double current_dist = pq.top().first;
+        int u = pq.top().second;
+        pq.pop();
+        if (current_dist > ws.distance(u)) continue; // Stale entry
+        stats.nodes_settled++;
+        result.reached.push_back({graph.node_id(u), current_dist, ws.aux(u)});
+
+        for (int e = graph.edge_begin(u); e < graph.edge_end(u); ++e) {
+            stats.edges_relaxed++;
+            const int v = graph.edge_target(e);
+            const double candidate = current_dist + Cost::cost(graph, overlay, e);
+            if (candidate <= budget && candidate < ws.distance(v)) {
+                ws.set(v, candidate, e);
+                ws.aux(v) = ws.aux(u) + graph.edge_length(e);
+                pq.push(v, candidate);
+                stats.queue_pushes++;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * search_tiled
+ * search_unidirectional over a TiledGraph. Nothing here is sized by the map:
+ * labels live in a hash map holding only the nodes reached, and the queue is a
+ * plain heap with stale entries skipped. Each tile the search reads is pinned
+ * for the rest of the query, so reconstruction never remaps one even if the
+ * cache evicted it meanwhile. Edge penalties follow WeightOverlay: the average
+ * of both end penalties, doubled.
+ */
+PathResult search_tiled(const TiledGraph& graph, const HazardManager* hazards, int start, int end, bool goal_directed) {
+    struct Label {
+        double distance;
+        double lower_bound;
+        int parent;          // Global index of the previous node, -1 at the start
+        int parent_edge;     // Tile-local index of the edge taken, in the parent's tile
+        double penalty;      // Hazard penalty of the node itself
+    };
+    std::unordered_map<int, Label> labels;
+    std::unordered_map<int, std::shared_ptr<const GraphTile>> pinned;
+    SearchStats stats;
+
+    auto tile_for = [&](int v) -> const GraphTile& {
+        const int t = graph.tile_of(v);
+        auto it = pinned.find(t);
+        if (it == pinned.end()) it = pinned.emplace(t, graph.tile(t, &stats)).first;
+        return *it->second;
+    };
+
+    const GraphTile& end_tile = tile_for(end);
+    const double end_lat = end_tile.latitude(end - end_tile.first_node());
+    const double end_lon = end_tile.longitude(end - end_tile.first_node());
+    const double scale = goal_directed ? graph.heuristic_scale() : 0.0;
+    const bool penalized = hazards && hazards->hazard_columns().size() > 0;
+
+    // Label for a node reached for the first time: its lower bound and penalty need its coordinates
+    auto first_label = [&](int v) {
+        const GraphTile& tile = tile_for(v);
+        const double lat = tile.latitude(v - tile.first_node()), lon = tile.longitude(v - tile.first_node());
+        Label label{kInfinity, 0.0, -1, -1, 0.0};
+        if (scale > 0) label.lower_bound = scale * geo::haversine_km(lat, lon, end_lat, end_lon);
+        if (penalized) label.penalty = hazards->get_penalty_for_location(lat, lon);
+        return label;
+    };
+    auto edge_penalty = [](double source_penalty, double target_penalty) {
+        if (source_penalty <= 0 && target_penalty <= 0) return 0.0;
+        return (source_penalty + target_penalty) / 2.0 * 2.0;
+    };
+
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    Label& origin = labels.emplace(start, first_label(start)).first->second;
+    origin.distance = 0;
+    pq.push({origin.lower_bound, start});
+    stats.queue_pushes = 1;
+    stats.peak_queue_size = 1;
+
+    while (!pq.empty()) {
+        const double key = pq.top().first;
+        const int u = pq.top().second;
+        pq.pop();
+
+        const Label label_u = labels.find(u)->second; // Queued nodes always have a label
+        if (key > label_u.distance + label_u.lower_bound) continue;
+        stats.nodes_settled++;
+        if (u == end) break;
+
+        const GraphTile& tile = tile_for(u);
+        const int local = u - tile.first_node();
+        for (int e = tile.edge_begin(local); e < tile.edge_end(local); ++e) {
+            stats.edges_relaxed++;
+            const int v = tile.edge_target(e);
+            auto it = labels.find(v);
+            if (it == labels.end()) it = labels.emplace(v, first_label(v)).first;
+            Label& label_v = it->second;
+
+            double cost = tile.edge_weight(e);
+            if (penalized) cost += edge_penalty(label_u.penalty, label_v.penalty);
+            const double candidate = label_u.distance + cost;
+            if (candidate < label_v.distance) {
+                label_v.distance = candidate;
+                label_v.parent = u;
+                label_v.parent_edge = e;
+                pq.push({candidate + label_v.lower_bound, v});
+                stats.queue_pushes++;
+                stats.peak_queue_size = std::max(stats.peak_queue_size, pq.size());
+            }
+        }
+    }
+
+    stats.tiles_touched = static_cast<int>(pinned.size());
+    // Only nodes the search reached have labels; a missing one must not read as distance 0
+    auto target = labels.find(end);
+    if (target == labels.end() || target->second.distance == kInfinity) return {{}, 0, 0, false, stats, 0};
+
+    // Walk back to the start (the only label with parent -1), then total up in route order like summarize_path
+    std::vector<const Label*> route;
+    for (auto it = target; ; it = labels.find(it->second.parent)) {
+        route.push_back(&it->second);
+        if (it->second.parent == -1) break;
+    }
+    std::reverse(route.begin(), route.end());
+    double real_dist = 0;
+    double hazard_sum = 0;
     std::vector<int> path;
-    int curr = end_node;
-    // Follow the breadcrumbs back to the start
-    while (curr != start_node) {
-        path.push_back(curr);
-        curr = predecessors[curr];
-    }
-    path.push_back(start_node); // Add the starting node
-    
-    // The path was built backwards, so reverse it for the final result
-    std::reverse(path.begin(), path.end());
-
-    // Final Metric Calculation: Calculate the real physical distance and hazard impact
+    path.reserve(route.size());
+    path.push_back(tile_for(start).node_id(start - tile_for(start).first_node()));
+    for (size_t i = 1; i < route.size(); ++i) {
+        const Label& label = *route[i];
+        const GraphTile& tile = tile_for(label.parent);
+        real_dist += tile.edge_length(label.parent_edge);
+        hazard_sum += tile.edge_hazard(label.parent_edge);
+        if (penalized) hazard_sum += edge_penalty(route[i - 1]->penalty, label.penalty);
+        const int v = tile.edge_target(label.parent_edge);
+        const GraphTile& next = tile_for(v);
+        path.push_back(next.node_id(v - next.first_node()));
+    }
+    return {path, real_dist, safety_score_for(hazard_sum, real_dist), true, stats, target->second.distance};
+}
+
+} // namespace
+
+/**
+ * find_safest_path
+ * Core algorithm to find the optimal path through the city graph.
+ * This implementation uses the standard Dijkstra's algorithm but with weights
+ * that are pre-optimized to include hazard penalties.
+ * It runs on the CSR form so that neighbor access and the distance/predecessor
+ * tables are plain array lookups indexed by the dense internal node index.
+ * 'algorithm' selects plain Dijkstra, A* or bidirectional Dijkstra; all three
+ * return an optimal route, they differ in how many nodes they settle.
+ * 'queue' and 'mode' select the priority queue and the cost policy the search
+ * is instantiated with.
+ */
+PathResult Dijkstra::find_safest_path(const CSRGraph& graph, int start_node, int end_node,
+                                      const WeightOverlay* overlay, SearchAlgorithm algorithm, QueueType queue,
+                                      CostModel mode) {
+    // Translate external IDs to dense internal indices
+    const int start = graph.index_of(start_node);
+    const int end = graph.index_of(end_node);
+
+    // Safety check: ensure both locations exist in the graph
+    if (start < 0 || end < 0) return {{}, 0, 0, false, {}, 0};
+
+    switch (mode) {
+        case CostModel::Eta:
+            return run_with_queue<EtaCost>(graph, overlay, start, end, algorithm, queue);
+        case CostModel::Night:
+            return run_with_queue<NightCost>(graph, overlay, start, end, algorithm, queue);
+        case CostModel::Vulnerable:
+            return run_with_queue<VulnerableCost>(graph, overlay, start, end, algorithm, queue);
+        case CostModel::Standard:
+        default:
+            return run_with_queue<StandardCost>(graph, overlay, start, end, algorithm, queue);
+    }
+}
+
+/**
+ * find_safest_path (snapped endpoints)
+ * Routes between two arbitrary points already snapped onto roads. The points
+ * behave as virtual nodes splitting their edges, so the route may begin and
+ * end partway along a road; the graph itself is not modified.
+ */
+PathResult Dijkstra::find_safest_path(const CSRGraph& graph, const RoadSnap& from, const RoadSnap& to,
+                                      const WeightOverlay* overlay, QueueType queue, CostModel mode) {
+    if (!from.found() || !to.found()) return {{}, 0, 0, false, {}, 0};
+
+    switch (mode) {
+        case CostModel::Eta:
+            return snapped_with_queue<EtaCost>(graph, overlay, from, to, queue);
+        case CostModel::Night:
+            return snapped_with_queue<NightCost>(graph, overlay, from, to, queue);
+        case CostModel::Vulnerable:
+            return snapped_with_queue<VulnerableCost>(graph, overlay, from, to, queue);
+        case CostModel::Standard:
+        default:
+            return snapped_with_queue<StandardCost>(graph, overlay, from, to, queue);
+    }
+}
+
+/**
+ * lower_bound_scale
+ * The A* scale of a cost model, exposed for callers that need to bound route
+ * costs geometrically (e.g. the route cache deciding whether a removed hazard
+ * could open up a cheaper route).
+ */
+double Dijkstra::lower_bound_scale(const CSRGraph& graph, CostModel mode) {
+    switch (mode) {
+        case CostModel::Eta: return heuristic_scale_for<EtaCost>(graph);
+        case CostModel::Night: return heuristic_scale_for<NightCost>(graph);
+        case CostModel::Vulnerable: return heuristic_scale_for<VulnerableCost>(graph);
+        case CostModel::Standard:
+        default: return heuristic_scale_for<StandardCost>(graph);
+    }
+}
+
+/**
+ * find_safest_path (tiled map)
+ * Resolves the endpoints through the tile file's ID table and runs the
+ * tiled search; Bidirectional falls back to Dijkstra.
+ */
+PathResult Dijkstra::find_safest_path(const TiledGraph& graph, int start_node, int end_node,
+                                      const HazardManager* hazards, SearchAlgorithm algorithm) {
+    const int start = graph.index_of(start_node);
+    const int end = graph.index_of(end_node);
+    if (start < 0 || end < 0) return {{}, 0, 0, false, {}, 0};
+    return search_tiled(graph, hazards, start, end, algorithm == SearchAlgorithm::AStar);
+}
+
+/**
+ * find_safest_path (adjacency-list overload)
+ * Compiles the Graph into CSR form and runs the array-based search.
+ */
+PathResult Dijkstra::find_safest_path(const Graph& graph, int start_node, int end_node) {
+    return find_safest_path(CSRGraph(graph), start_node, end_node);
+}
+
+/**
+ * summarize_path
+ * Final Metric Calculation shared by all search strategies: given the route as
+ * the sequence of CSR edges taken from 'start', accumulates the real distance
+ * and hazard impact, derives the safety score and translates the nodes back to
+ * external Node IDs. Each edge is read directly; no neighbor lists are scanned.
+ */
+PathResult Dijkstra::summarize_path(const CSRGraph& graph, const WeightOverlay* overlay, int start,
+                                    const std::vector<int>& edges, double total_cost, const SearchStats& stats) {
     double real_dist = 0;
     double hazard_sum = 0;
-    for (size_t i = 0; i < path.size() - 1; ++i) {
-        for (const auto& edge : graph.get_neighbors(path[i])) {
-            if (edge.destination_id == path[i+1]) {
-                real_dist += edge.distance;       // Accumulated real distance (km)
-                hazard_sum += edge.hazard_penalty; // Accumulated hazard impact
-                break;
+    std::vector<int> path;
+    path.reserve(edges.size() + 1);
+    path.push_back(graph.node_id(start));
+    for (int e : edges) {
+        real_dist += graph.edge_length(e);   // Accumulated real distance (km)
+        hazard_sum += graph.edge_hazard(e);  // Accumulated hazard impact
+        if (overlay) hazard_sum += overlay->penalty(e);
+        path.push_back(graph.node_id(graph.edge_target(e))); // Report the route using external Node IDs
+    }
+
+    double safety_score = safety_score_for(hazard_sum, real_dist);
+    return {path, real_dist, safety_score, true, stats, total_cost};
+}
+
+/**
+ * one_to_many
+ * Plain Dijkstra from the source without the single-target early exit: it only
+ * stops once every requested target has been settled (or the reachable graph is
+ * exhausted). Each target's length and hazard impact are then summed along its
+ * predecessor edges; no node sequence is built.
+ */
+std::vector<MatrixCell> Dijkstra::one_to_many(const CSRGraph& graph, int source_node,
+                                              const std::vector<int>& target_nodes,
+                                              const WeightOverlay* overlay) {
+    std::vector<MatrixCell> row(target_nodes.size());
+    const int source = graph.index_of(source_node);
+    if (source < 0) return row;
+
+    // Distinct targets still waiting to be settled, sorted for binary search
+    std::vector<int> pending;
+    for (int id : target_nodes) {
+        int t = graph.index_of(id);
+        if (t >= 0) pending.push_back(t);
+    }
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+    size_t remaining = pending.size();
+
+    SearchWorkspace& ws = SearchWorkspace::local();
+    ws.begin(graph.node_count());
+    BinaryHeap& pq = local_queue<BinaryHeap>();
+    pq.reset(graph.node_count());
+
+    ws.set(source, 0, -1);
+    pq.push(source, 0);
+
+    while (!pq.empty() && remaining > 0) {
+        double current_dist = pq.top().first;
+        int u = pq.top().second;
+        pq.pop();
+        if (current_dist > ws.distance(u)) continue; // Stale entry
+        if (std::binary_search(pending.begin(), pending.end(), u)) remaining--;
+
+        for (int e = graph.edge_begin(u); e < graph.edge_end(u); ++e) {
+            const int v = graph.edge_target(e);
+            const double candidate = current_dist + routing_cost(graph, overlay, e);
+            if (candidate < ws.distance(v)) {
+                ws.set(v, candidate, e);
+                pq.push(v, candidate);
             }
         }
     }
 
-    // Safety score logic: 100 is perfect, subtract based on hazard density
-    // We scale the hazard sum by distance to reflect "safety per km"
-    double safety_score = 100.0 - (hazard_sum / (real_dist + 0.1) * 10.0);
-    if (safety_score < 0) safety_score = 0; // Cap floor at zero
+    for (size_t i = 0; i < target_nodes.size(); ++i) {
+        int t = graph.index_of(target_nodes[i]);
+        if (t < 0 || !ws.reached(t)) continue;
+        double length = 0, hazard_sum = 0;
+        for (int e = ws.parent_edge(t); e != -1; e = ws.parent_edge(graph.edge_source(e))) {
+            length += graph.edge_length(e);
+            hazard_sum += graph.edge_hazard(e);
+            if (overlay) hazard_sum += overlay->penalty(e);
+        }
+        row[i] = {length, safety_score_for(hazard_sum, length), true};
+    }
+    return row;
+}
 
-    return {path, real_dist, safety_score, true};
+/**
+ * many_to_many
+ * Runs one_to_many for every source on the shared worker pool. Each call
+ * writes only its own row, so no locking is needed; the graph and overlay are
+ * only read.
+ */
+std::vector<std::vector<MatrixCell>> Dijkstra::many_to_many(const CSRGraph& graph,
+                                                            const std::vector<int>& source_nodes,
+                                                            const std::vector<int>& target_nodes,
+                                                            const WeightOverlay* overlay,
+                                                            unsigned threads) {
+    std::vector<std::vector<MatrixCell>> matrix(source_nodes.size());
+    WorkerPool::shared().parallel_for(source_nodes.size(), threads, [&](size_t i) {
+        matrix[i] = one_to_many(graph, source_nodes[i], target_nodes, overlay);
+    });
+    return matrix;
+}
+
+/**
+ * reachable_within
+ * Resolves the cost policy and runs the bounded search. A negative budget
+ * reaches nothing, not even the origin.
+ */
+Isochrone Dijkstra::reachable_within(const CSRGraph& graph, int origin_node, double budget,
+                                     const WeightOverlay* overlay, CostModel mode) {
+    const int origin = graph.index_of(origin_node);
+    if (origin < 0 || budget < 0) {
+        Isochrone none;
+        none.origin = origin_node;
+        none.success = origin >= 0;
+        return none;
+    }
+
+    switch (mode) {
+        case CostModel::Eta:
+            return search_bounded<EtaCost>(graph, overlay, origin, budget);
+        case CostModel::Night:
+            return search_bounded<NightCost>(graph, overlay, origin, budget);
+        case CostModel::Vulnerable:
+            return search_bounded<VulnerableCost>(graph, overlay, origin, budget);
+        case CostModel::Standard:
+        default:
+            return search_bounded<StandardCost>(graph, overlay, origin, budget);
+    }
+}
+
+/**
+ * reachable_within (many origins)
+ * Same work distribution as many_to_many: origins run on the shared worker
+ * pool and each writes only its own slot.
+ */
+std::vector<Isochrone> Dijkstra::reachable_within(const CSRGraph& graph, const std::vector<int>& origin_nodes,
+                                                  double budget, const WeightOverlay* overlay,
+                                                  CostModel mode, unsigned threads) {
+    std::vector<Isochrone> results(origin_nodes.size());
+    WorkerPool::shared().parallel_for(origin_nodes.size(), threads, [&](size_t i) {
+        results[i] = reachable_within(graph, origin_nodes[i], budget, overlay, mode);
+    });
+    return results;
 }
@@ -2,10 +2,29 @@
 #define DIJKSTRA_H
 
 #include "graph.h"
+#include "csr_graph.h"
+#include "weight_overlay.h"
+#include "edge_index.h"
 #include <vector>
 #include <queue>
 #include <map>
 
+class HazardManager;
+class TiledGraph;
+
+/**
+ * SearchStats
+ * Work counters of one route search, for profiling (see "route ... stats=1").
+ */
+struct SearchStats {
+    int nodes_settled = 0;        // Nodes permanently labeled by the search (search-space size)
+    long long edges_relaxed = 0;  // Edges (or hierarchy arcs) examined
+    long long queue_pushes = 0;   // Successful relaxations that inserted or decreased a queue entry
+    size_t peak_queue_size = 0;   // Largest number of queued entries at any time (both sides when bidirectional)
+    int tiles_touched = 0;        // Tiles the search read (tiled maps only)
+    int tiles_loaded = 0;         // ... of which had to be mapped because they were not resident
+};
+
 /**
  * PathResult
  * A structure to store the outcome of a route search.
@@ -16,6 +35,87 @@ struct PathResult {
     double total_distance;      // Cumulative length of the route in kilometers
     double safety_score;        // Normalized score (0-100) based on hazard proximity
     bool success;               // True if a path was found, false otherwise
+    SearchStats stats;          // How much work the search did
+    double total_cost;          // Routing cost of the path under the cost model it was searched with
+};
+
+/**
+ * MatrixCell
+ * Cost summary of the best route between one source and one target, as used by
+ * the route matrix. Same metrics as PathResult, but without the node sequence.
+ */
+struct MatrixCell {
+    double total_distance = 0;  // Length of the route in kilometers
+    double safety_score = 0;    // Normalized score (0-100), as in PathResult
+    bool success = false;       // False if the target is unknown or unreachable
+};
+
+/**
+ * ReachedNode
+ * One intersection inside an isochrone: the routing cost of the best route from
+ * the origin (under the query's cost model) and that route's length.
+ */
+struct ReachedNode {
+    int node_id;      // External Node ID
+    double cost;      // Routing cost from the origin, at most the budget
+    double distance;  // Length of that route in kilometers
+};
+
+/**
+ * Isochrone
+ * Everything reachable from one origin within a cost budget.
+ */
+struct Isochrone {
+    int origin = 0;                     // External Node ID of the origin
+    bool success = false;               // False if the origin is not in the graph
+    std::vector<ReachedNode> reached;   // In settling order, i.e. ascending cost (origin first)
+    SearchStats stats;                  // How much work the search did
+};
+
+/**
+ * SearchAlgorithm
+ * Strategy used to explore the graph. All of them return the same optimal cost.
+ * - Dijkstra:      unidirectional, grows a full disc around the start.
+ * - AStar:         goal-directed; orders the queue by cost + geographic lower bound.
+ * - Bidirectional: grows two smaller discs, one from each end, until they meet.
+ */
+enum class SearchAlgorithm {
+    Dijkstra,
+    AStar,
+    Bidirectional
+};
+
+/**
+ * QueueType
+ * Priority queue the search runs on (see priority_queues.h). All of them produce
+ * the same routes; they trade memory traffic and per-operation cost differently.
+ * - BinaryHeap:  std::priority_queue with lazy deletion (stale entries are skipped).
+ * - FourAryHeap: indexed 4-ary heap with decrease-key; one entry per node.
+ * - RadixHeap:   monotone radix heap over the exact bit patterns of the costs.
+ * - Buckets:     Dial-style bucket queue swept in cost order.
+ */
+enum class QueueType {
+    BinaryHeap,
+    FourAryHeap,
+    RadixHeap,
+    Buckets
+};
+
+/**
+ * CostModel
+ * What a route optimizes (see cost_policies.h). Each model is a compile-time
+ * policy, so the searches are specialized per model with no runtime dispatch
+ * inside the relaxation loop.
+ * - Standard:   distance + hazards - safety bonus (the AMAAN default).
+ * - Eta:        pure distance, for travel-time estimates.
+ * - Night:      hazards weighted three times.
+ * - Vulnerable: hazards doubled and safety bonuses tripled.
+ */
+enum class CostModel {
+    Standard,
+    Eta,
+    Night,
+    Vulnerable
 };
 
 /**
@@ -26,8 +126,76 @@ struct PathResult {
  */
 class Dijkstra {
 public:
-    // Core function to find the safest path between two nodes in a given graph.
+    // Core function to find the safest path between two nodes in a compiled CSR graph.
+    // Node IDs are external IDs; the search itself runs on dense internal indices.
+    // An optional overlay adds live hazard penalties on top of the static edge weights;
+    // 'mode' selects how length, hazards and safety bonuses combine into the cost.
+    static PathResult find_safest_path(const CSRGraph& graph, int start_node, int end_node,
+                                       const WeightOverlay* overlay = nullptr,
+                                       SearchAlgorithm algorithm = SearchAlgorithm::Dijkstra,
+                                       QueueType queue = QueueType::BinaryHeap,
+                                       CostModel mode = CostModel::Standard);
+
+    // Route between two coordinates snapped onto roads (see EdgeIndex): the search starts
+    // and ends at virtual nodes splitting the snapped edges. 'path' lists the intersections
+    // passed (empty if both points lie on one road); distance and safety score include
+    // the partial edges at both ends.
+    static PathResult find_safest_path(const CSRGraph& graph, const RoadSnap& from, const RoadSnap& to,
+                                       const WeightOverlay* overlay = nullptr,
+                                       QueueType queue = QueueType::BinaryHeap,
+                                       CostModel mode = CostModel::Standard);
+
+    // Route on a tiled map (see TiledGraph): tiles are mapped as the search frontier
+    // enters them. Standard cost model; hazard penalties are scored per node reached,
+    // giving the same costs as an overlay built from 'hazards'. Bidirectional search
+    // needs incoming edges, which tiles do not store, so only Dijkstra and A* are offered.
+    static PathResult find_safest_path(const TiledGraph& graph, int start_node, int end_node,
+                                       const HazardManager* hazards = nullptr,
+                                       SearchAlgorithm algorithm = SearchAlgorithm::Dijkstra);
+
+    // Convenience overload: compiles the adjacency-list graph first (O(V + E)).
+    // Prefer compiling once and reusing the CSRGraph when running many queries.
     static PathResult find_safest_path(const Graph& graph, int start_node, int end_node);
+
+    // One-to-many search: a single Dijkstra from 'source_node' that keeps going until
+    // every target is settled, returning one cell per target (in the given order).
+    static std::vector<MatrixCell> one_to_many(const CSRGraph& graph, int source_node,
+                                               const std::vector<int>& target_nodes,
+                                               const WeightOverlay* overlay = nullptr);
+
+    // Many-to-many route matrix: row i holds the cells for sources[i]. Sources are
+    // searched in parallel by the caller and up to 'threads' - 1 helpers of the shared
+    // WorkerPool (0 = all of them); the graph and overlay are shared read-only, so the
+    // overlay must be current beforehand.
+    static std::vector<std::vector<MatrixCell>> many_to_many(const CSRGraph& graph,
+                                                             const std::vector<int>& source_nodes,
+                                                             const std::vector<int>& target_nodes,
+                                                             const WeightOverlay* overlay = nullptr,
+                                                             unsigned threads = 0);
+
+    // Bounded one-to-all search: every node whose best route from 'origin_node' costs at
+    // most 'budget' under cost model 'mode'. The search stops as soon as the cheapest
+    // queued node exceeds the budget, so its work grows with the area covered, not the map.
+    static Isochrone reachable_within(const CSRGraph& graph, int origin_node, double budget,
+                                      const WeightOverlay* overlay = nullptr,
+                                      CostModel mode = CostModel::Standard);
+
+    // One isochrone per origin, searched in parallel by the caller and up to 'threads' - 1
+    // pool helpers (0 = all of them) over the shared graph and overlay, like many_to_many.
+    static std::vector<Isochrone> reachable_within(const CSRGraph& graph, const std::vector<int>& origin_nodes,
+                                                   double budget, const WeightOverlay* overlay = nullptr,
+                                                   CostModel mode = CostModel::Standard, unsigned threads = 0);
+
+    // Builds the final PathResult (distance, safety score, external IDs) for a route
+    // given as the CSR edges taken from internal node 'start', whose routing cost the
+    // search found to be 'total_cost'. Shared with other routing back-ends.
+    static PathResult summarize_path(const CSRGraph& graph, const WeightOverlay* overlay, int start,
+                                     const std::vector<int>& edges, double total_cost, const SearchStats& stats);
+
+    // Smallest ratio of routing cost (without live penalties) to straight-line length
+    // over all edges, for the given cost model: scale * haversine_km(a, b) never
+    // exceeds the cost of a route from a to b. Zero when no such bound exists.
+    static double lower_bound_scale(const CSRGraph& graph, CostModel mode);
 };
 
 #endif // DIJKSTRA_H
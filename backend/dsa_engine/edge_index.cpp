@@ -0,0 +1,186 @@
+#include "edge_index.h"
+#include "geo.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/**
+ * find_twin
+ * The edge running the other way along the same road (v -> u for edge u -> v),
+ * or -1 if the road is one-way. Scans the short out-edge slice of v.
+ */
+int find_twin(const CSRGraph& graph, int e) {
+    const int u = graph.edge_source(e), v = graph.edge_target(e);
+    for (int f = graph.edge_begin(v); f < graph.edge_end(v); ++f) {
+        if (graph.edge_target(f) == u) return f;
+    }
+    return -1;
+}
+
+// True if edge e is the copy of its road that gets indexed (each road once)
+bool is_indexed(const CSRGraph& graph, int e) {
+    const int u = graph.edge_source(e), v = graph.edge_target(e);
+    return u < v || find_twin(graph, e) < 0;
+}
+
+} // namespace
+
+/**
+ * EdgeIndex constructor
+ * Chooses a cell size close to the mean segment length, so a typical segment
+ * spans one or two cells and a query finishes after the first ring or two,
+ * then lists every segment in the cells its bounding box overlaps. The cell
+ * count is capped at about two per segment so sparse, wide networks stay small.
+ */
+EdgeIndex::EdgeIndex(const CSRGraph& graph) {
+    const int n = graph.node_count();
+    if (n == 0 || graph.edge_count() == 0) return;
+
+    double lat_sum = 0;
+    for (int v = 0; v < n; ++v) lat_sum += graph.latitude(v);
+    cos_ref = std::cos(lat_sum / n * geo::kDegToRad);
+
+    auto x_of = [&](int v) { return graph.longitude(v) * cos_ref; };
+    auto y_of = [&](int v) { return graph.latitude(v); };
+
+    double max_x = min_x = x_of(0);
+    double max_y = min_y = y_of(0);
+    for (int v = 1; v < n; ++v) {
+        min_x = std::min(min_x, x_of(v));
+        max_x = std::max(max_x, x_of(v));
+        min_y = std::min(min_y, y_of(v));
+        max_y = std::max(max_y, y_of(v));
+    }
+
+    double length_sum = 0;
+    for (int e = 0; e < graph.edge_count(); ++e) {
+        if (!is_indexed(graph, e)) continue;
+        const int u = graph.edge_source(e), v = graph.edge_target(e);
+        length_sum += std::hypot(x_of(v) - x_of(u), y_of(v) - y_of(u));
+        segments++;
+    }
+    if (segments == 0) return;
+
+    // Cell size: the mean segment length, grown until the grid is at most ~2 cells per segment
+    const double width = max_x - min_x, height = max_y - min_y;
+    const double cell_limit = 2.0 * segments + 1;
+    cell_size = std::max(length_sum / segments, 1e-7);
+    while ((std::floor(width / cell_size) + 1) * (std::floor(height / cell_size) + 1) > cell_limit) {
+        cell_size *= 1.5;
+    }
+    columns = static_cast<int>(width / cell_size) + 1;
+    rows = static_cast<int>(height / cell_size) + 1;
+
+    // Two passes over the segments: count per cell, then fill the CSR slices
+    cell_offsets.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    auto for_each_cell = [&](int e, auto&& visit) {
+        const int u = graph.edge_source(e), v = graph.edge_target(e);
+        const int c0 = column_of(std::min(x_of(u), x_of(v))), c1 = column_of(std::max(x_of(u), x_of(v)));
+        const int r0 = row_of(std::min(y_of(u), y_of(v))), r1 = row_of(std::max(y_of(u), y_of(v)));
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) visit(static_cast<size_t>(r) * columns + c);
+        }
+    };
+    for (int e = 0; e < graph.edge_count(); ++e) {
+        if (!is_indexed(graph, e)) continue;
+        for_each_cell(e, [&](size_t cell) { cell_offsets[cell + 1]++; });
+    }
+    for (size_t cell = 0; cell + 1 < cell_offsets.size(); ++cell) cell_offsets[cell + 1] += cell_offsets[cell];
+    cell_edges.resize(cell_offsets.back());
+    std::vector<int> fill(cell_offsets.begin(), cell_offsets.end() - 1);
+    for (int e = 0; e < graph.edge_count(); ++e) {
+        if (!is_indexed(graph, e)) continue;
+        for_each_cell(e, [&](size_t cell) { cell_edges[fill[cell]++] = e; });
+    }
+}
+
+int EdgeIndex::column_of(double x) const {
+    return std::clamp(static_cast<int>(std::floor((x - min_x) / cell_size)), 0, columns - 1);
+}
+
+int EdgeIndex::row_of(double y) const {
+    return std::clamp(static_cast<int>(std::floor((y - min_y) / cell_size)), 0, rows - 1);
+}
+
+/**
+ * snap
+ * Ring search around the query's cell. Every cell in ring r (Chebyshev distance
+ * r from the start cell) lies at least (r - 1) cells away from the query point,
+ * so once the best segment is within r cells after scanning ring r, nothing
+ * further out can beat it. A query outside the network starts from the nearest
+ * border cell; the bound still holds there because clamping to the grid only
+ * brings the point closer to every cell.
+ */
+RoadSnap EdgeIndex::snap(const CSRGraph& graph, double lat, double lon) const {
+    RoadSnap best;
+    if (segments == 0) return best;
+
+    const double px = lon * cos_ref, py = lat;
+    const int start_column = column_of(px), start_row = row_of(py);
+    double best_dist_sq = 1e300;
+
+    auto scan_cell = [&](int column, int row) {
+        const size_t cell = static_cast<size_t>(row) * columns + column;
+        for (int i = cell_offsets[cell]; i < cell_offsets[cell + 1]; ++i) {
+            const int e = cell_edges[i];
+            const int u = graph.edge_source(e), v = graph.edge_target(e);
+            const double ax = graph.longitude(u) * cos_ref, ay = graph.latitude(u);
+            const double dx = graph.longitude(v) * cos_ref - ax, dy = graph.latitude(v) - ay;
+            // Project the query onto the segment and clamp to its end points
+            const double length_sq = dx * dx + dy * dy;
+            double t = length_sq > 0 ? ((px - ax) * dx + (py - ay) * dy) / length_sq : 0.0;
+            t = std::clamp(t, 0.0, 1.0);
+            const double ex = ax + t * dx - px, ey = ay + t * dy - py;
+            const double dist_sq = ex * ex + ey * ey;
+            if (dist_sq < best_dist_sq) {
+                best_dist_sq = dist_sq;
+                best.edge = e;
+                best.fraction = t;
+            }
+        }
+    };
+
+    const int max_ring = std::max(columns, rows);
+    for (int r = 0; r <= max_ring; ++r) {
+        for (int row = start_row - r; row <= start_row + r; ++row) {
+            if (row < 0 || row >= rows) continue;
+            const bool edge_row = row == start_row - r || row == start_row + r;
+            // Full span on the top and bottom rows of the ring, only its two sides elsewhere
+            const int step = (edge_row || r == 0) ? 1 : 2 * r;
+            for (int column = start_column - r; column <= start_column + r; column += step) {
+                if (column >= 0 && column < columns) scan_cell(column, row);
+            }
+        }
+        if (best.found() && std::sqrt(best_dist_sq) <= r * cell_size) break;
+    }
+
+    const int u = graph.edge_source(best.edge), v = graph.edge_target(best.edge);
+    best.reverse_edge = find_twin(graph, best.edge);
+    best.latitude = graph.latitude(u) + best.fraction * (graph.latitude(v) - graph.latitude(u));
+    best.longitude = graph.longitude(u) + best.fraction * (graph.longitude(v) - graph.longitude(u));
+    best.distance_km = geo::haversine_km(lat, lon, best.latitude, best.longitude);
+    return best;
+}
+
+/**
+ * at_node
+ * Places the snap at the tail of one of the node's outgoing edges (fraction 0),
+ * or at the head of an incoming one (fraction 1) for a node only entered.
+ */
+RoadSnap EdgeIndex::at_node(const CSRGraph& graph, int node) {
+    RoadSnap snap;
+    if (graph.edge_begin(node) < graph.edge_end(node)) {
+        snap.edge = graph.edge_begin(node);
+        snap.fraction = 0.0;
+    } else if (graph.in_edge_begin(node) < graph.in_edge_end(node)) {
+        snap.edge = graph.in_edge(graph.in_edge_begin(node));
+        snap.fraction = 1.0;
+    } else {
+        return snap;
+    }
+    snap.reverse_edge = find_twin(graph, snap.edge);
+    snap.latitude = graph.latitude(node);
+    snap.longitude = graph.longitude(node);
+    return snap;
+}
@@ -0,0 +1,72 @@
+#ifndef EDGE_INDEX_H
+#define EDGE_INDEX_H
+
+#include "csr_graph.h"
+#include <vector>
+
+/**
+ * RoadSnap
+ * Where an arbitrary coordinate lands on the road network: a point on one road
+ * segment, given as a directed CSR edge and the fraction of the way along it.
+ * Searches start (or end) at this point as if it were a virtual node splitting
+ * the edge (see Dijkstra::find_safest_path for snapped endpoints).
+ */
+struct RoadSnap {
+    int edge = -1;             // CSR edge u -> v holding the snapped point (-1 if nothing was found)
+    int reverse_edge = -1;     // The v -> u twin of a two-way road, -1 for one-way roads
+    double fraction = 0;       // Position along 'edge': 0 at u, 1 at v
+    double latitude = 0;       // The snapped point itself
+    double longitude = 0;
+    double distance_km = 0;    // From the query coordinate to the snapped point
+
+    bool found() const { return edge >= 0; }
+};
+
+/**
+ * EdgeIndex Class
+ * Uniform grid over the road segments of a CSRGraph, for snapping coordinates
+ * to the nearest road in microseconds.
+ *
+ * Coordinates are projected once to a local equirectangular plane (longitude
+ * scaled by the cosine of the network's mean latitude), where cells are square
+ * and point-to-segment distances are plain 2-D geometry; at city scale the
+ * error against great-circle distance is far below GPS accuracy.
+ * Every segment is listed in each cell its bounding box overlaps (cells are
+ * stored CSR-style, like the graph). A query scans rings of cells around the
+ * query point and stops as soon as no unscanned cell can hold a closer segment.
+ * A two-way road is indexed once; its twin edge is resolved at snap time.
+ */
+class EdgeIndex {
+private:
+    double cos_ref = 1.0;      // Longitude scale of the projection
+    double min_x = 0, min_y = 0;
+    double cell_size = 1.0;    // Side of a cell in projected degrees
+    int columns = 0, rows = 0;
+    std::vector<int> cell_offsets;  // [cells + 1] Slice of 'cell_edges' per cell
+    std::vector<int> cell_edges;    // CSR edge IDs listed per cell
+    size_t segments = 0;            // Distinct segments indexed
+
+    // Grid column / row of a projected coordinate, clamped to the grid
+    int column_of(double x) const;
+    int row_of(double y) const;
+
+public:
+    // Creates an empty index (snaps nothing)
+    EdgeIndex() = default;
+
+    // Indexes every road segment of 'graph'. O(E) plus the cells each segment spans.
+    explicit EdgeIndex(const CSRGraph& graph);
+
+    // Nearest point of the road network to (lat, lon). 'graph' must be the graph the
+    // index was built from. Returns a snap with found() == false for an empty graph.
+    RoadSnap snap(const CSRGraph& graph, double lat, double lon) const;
+
+    // A snap sitting exactly on intersection 'node' (internal index), so a node can be
+    // mixed with coordinates in one query. Not found() if the node has no roads.
+    static RoadSnap at_node(const CSRGraph& graph, int node);
+
+    // Number of distinct road segments indexed
+    size_t segment_count() const { return segments; }
+};
+
+#endif // EDGE_INDEX_H
@@ -0,0 +1,1209 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <memory>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <utility>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <climits>
+#include "graph.h"
+#include "csr_graph.h"
+#include "weight_overlay.h"
+#include "dijkstra.h"
+#include "contraction_hierarchy.h"
+#include "graph_file.h"
+#include "graph_tiles.h"
+#include "kdtree.h"
+#include "hazards.h"
+#include "geo.h"
+#include "latency_histogram.h"
+#include "route_cache.h"
+#include "payload_parser.h"
+#include "json_writer.h"
+#include "edge_index.h"
+#include "node_order.h"
+#include "hull.h"
+#include "rcu.h"
+#include "search_workspace.h"
+#include "worker_pool.h"
+#include "engine.h"
+
+using namespace std;
+
+/**
+ * HazardSnapshot
+ * One immutable version of the live hazard state: the hazard registry and the
+ * penalty overlay derived from it for 'road_network'. A hazard change publishes
+ * a new snapshot (publish_hazards) and every query pins the current one for its
+ * whole run (rcu::ReadGuard), so an update landing mid-query never mixes two
+ * hazard sets and readers never wait for writers.
+ * The overlay is filled in by the first query that needs it (overlay_for), so a
+ * change answered entirely from the route cache never pays for it; it starts
+ * from a retired snapshot's overlay where possible and catches up on just the
+ * hazards changed since (WeightOverlay::update).
+ */
+struct HazardSnapshot {
+    HazardManager hazards;
+    mutable WeightOverlay overlay;
+    mutable once_flag overlay_built;
+
+    ~HazardSnapshot();
+};
+
+// Global engine components initialized at startup
+Graph g;           // The city's spatial graph (Nodes and Edges)
+KDTree qt;         // Persistent KD-Tree (not heavily used in this specific entry-point logic)
+CSRGraph road_network;  // Frozen, shared search topology compiled from 'g' after loading
+unique_ptr<TiledGraph> tiled_network;  // Set instead when the map is a tile file ('road_network' stays empty)
+// Declared before 'hazard_state': the last snapshot returns its overlay here when destroyed at exit
+mutex overlay_pool_mutex; // 'spare_overlays'
+vector<WeightOverlay> spare_overlays;  // Overlays of reclaimed snapshots, reused to skip O(E) allocations
+rcu::Versioned<HazardSnapshot> hazard_state;  // Current hazards + overlay; queries pin it, writers replace it
+unique_ptr<ContractionHierarchy> hierarchy;  // Built on first "search=cch" query, then kept resident
+unsigned long long hierarchy_epoch = 0;      // Hazard epoch the hierarchy was last customized for
+map<string, LatencyHistogram> command_latency; // Serve mode: end-to-end latency per command
+RouteCache route_cache;  // Recent route results, revalidated lazily against hazard changes
+unique_ptr<EdgeIndex> edge_index;  // Built on the first coordinate query, then kept resident
+
+// Mutable shared structures other than the hazard state are guarded for concurrent serve workers
+mutex hazard_writer;      // Serializes snapshot writers (readers never take it)
+mutex hierarchy_mutex;    // The hierarchy is customized in place, so its queries take turns
+mutex route_cache_mutex;  // Lookups reorder the cache's LRU list
+mutex edge_index_mutex;   // First (lazy) build of 'edge_index'
+mutex latency_mutex;      // 'command_latency'
+
+/**
+ * ~HazardSnapshot
+ * Runs once no reader can see the snapshot any more; the overlay's arrays go
+ * back to the pool for the next snapshot (rebuild only resets what was written).
+ */
+HazardSnapshot::~HazardSnapshot() {
+    lock_guard<mutex> lock(overlay_pool_mutex);
+    if (spare_overlays.size() < 2) spare_overlays.push_back(std::move(overlay));
+}
+
+/**
+ * initialize_data
+ * Hardcodes the initial setup for the city of Islamabad.
+ * In a production system, this would load from a SQL database or GeoJSON file.
+ */
+void initialize_data() {
+    /**
+     * DSA: Hash Map Insertion
+     * We populate the graph with known safety intersections.
+     * IDs here must match the ISLAMABAD_NODES in the frontend JavaScript.
+     */
+    g.add_node(1, 33.7103, 73.0571, "Blue Area");
+    g.add_node(2, 33.7297, 73.0746, "F-6 Sector");
+    g.add_node(3, 33.6844, 73.0479, "G-9 Sector");
+    g.add_node(4, 33.7149, 73.0235, "E-9 Air University");
+    g.add_node(5, 33.7077, 73.0501, "Centaurus Mall");
+    g.add_node(6, 33.6934, 73.0102, "F-10 Markaz");
+    g.add_node(7, 33.6844, 73.0751, "Shakar Parian");
+    g.add_node(8, 33.6685, 73.0751, "I-8 Sector");
+
+    /**
+     * DSA: Adjacency List Connectivity
+     * Defining the road network of the city.
+     * Initial edges are added with 0 hazard; penalties are updated dynamically per request.
+     */
+    g.add_edge(1, 2, 2.5); // Blue Area to F-6 (2.5km)
+    g.add_edge(1, 5, 1.2); // Blue Area to Centaurus (1.2km)
+    g.add_edge(5, 3, 3.0); // Centaurus to G-9
+    g.add_edge(3, 6, 2.8); // G-9 to F-10
+    g.add_edge(4, 6, 3.5); // E-9 to F-10
+    g.add_edge(1, 7, 4.0); // Blue Area to Shakar Parian
+    g.add_edge(7, 8, 2.5); // Shakar Parian to I-8
+    g.add_edge(8, 3, 3.5); // I-8 to G-9
+}
+
+/**
+ * load_road_network
+ * Loads the map searched by every command: a prebuilt binary graph file
+ * (memory-mapped, pages fault in lazily) or, for an empty path, the demo data.
+ * Either way the nodes are renumbered along a Hilbert curve for cache locality;
+ * files written by amaan_graph_import already are, and stay mapped as they are.
+ * A tile file (amaan_graph_import --tiles) is opened as a TiledGraph instead:
+ * only its index is mapped now, tiles follow as routes reach them.
+ */
+void load_road_network(const string& graph_path, size_t max_resident_tiles) {
+    if (!graph_path.empty() && TiledGraph::is_tile_file(graph_path)) {
+        auto tiles = make_unique<TiledGraph>(graph_path, max_resident_tiles);
+        use_road_network(CSRGraph());
+        tiled_network = std::move(tiles);
+    } else if (!graph_path.empty()) {
+        use_road_network(node_order::hilbert_reordered(GraphFile::load(graph_path)));
+    } else {
+        initialize_data();
+        use_road_network(node_order::hilbert_reordered(CSRGraph(g)));
+    }
+}
+
+/**
+ * use_road_network
+ * Swaps in a compiled road network. Everything derived from the previous one
+ * (penalty overlay, contraction hierarchy, edge index) is dropped and rebuilt
+ * on demand. Not safe while queries are running.
+ */
+void use_road_network(CSRGraph graph) {
+    road_network = std::move(graph);
+    tiled_network.reset();
+
+    // Same hazards, but an overlay for the new network (pooled overlays fit the old one)
+    lock_guard<mutex> lock(hazard_writer);
+    auto next = make_unique<HazardSnapshot>();
+    if (const HazardSnapshot* current = hazard_state.get()) next->hazards = current->hazards;
+    hazard_state.publish(std::move(next));
+    rcu::reclaim();
+    {
+        lock_guard<mutex> pool_lock(overlay_pool_mutex);
+        spare_overlays.clear();
+    }
+    hierarchy.reset();
+    hierarchy_epoch = 0;
+    route_cache.clear();
+    edge_index.reset();
+}
+
+/**
+ * RouteTimings
+ * Wall-clock breakdown of one route request, in milliseconds.
+ */
+struct RouteTimings {
+    double parse_ms = 0;    // Hazard string -> HazardManager
+    double overlay_ms = 0;  // Overlay rebuild (and hierarchy customization) when hazards changed
+    double search_ms = 0;   // The search itself, including path summary
+    double snap_ms = 0;     // Snapping coordinate endpoints onto roads (and building the edge index)
+};
+
+// Milliseconds elapsed since 'since'
+double elapsed_ms(chrono::steady_clock::time_point since) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * mode_name
+ * Name of a cost model as accepted by the "mode=" option.
+ */
+const char* mode_name(CostModel mode) {
+    switch (mode) {
+        case CostModel::Eta: return "eta";
+        case CostModel::Night: return "night";
+        case CostModel::Vulnerable: return "vulnerable";
+        default: return "standard";
+    }
+}
+
+/**
+ * search_name
+ * Name of a search strategy as accepted by the "search=" option.
+ */
+const char* search_name(const RouteOptions& options) {
+    if (options.use_hierarchy) return "cch";
+    switch (options.algorithm) {
+        case SearchAlgorithm::AStar: return "astar";
+        case SearchAlgorithm::Bidirectional: return "bidirectional";
+        default: return "dijkstra";
+    }
+}
+
+/**
+ * parse_mode
+ * Cost model named by a "mode=" option value.
+ */
+bool parse_mode(const string& value, CostModel& mode) {
+    if (value == "standard") mode = CostModel::Standard;
+    else if (value == "eta") mode = CostModel::Eta;
+    else if (value == "night") mode = CostModel::Night;
+    else if (value == "vulnerable") mode = CostModel::Vulnerable;
+    else return false;
+    return true;
+}
+
+/**
+ * parse_route_options
+ * Reads key=value options from args[first..]. On failure returns false and
+ * describes the offending argument in 'error'.
+ */
+bool parse_route_options(const vector<string>& args, size_t first, RouteOptions& options, string& error) {
+    for (size_t i = first; i < args.size(); ++i) {
+        const string& arg = args[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+        if (key == "search") {
+            if (value == "dijkstra") options.algorithm = SearchAlgorithm::Dijkstra;
+            else if (value == "astar") options.algorithm = SearchAlgorithm::AStar;
+            else if (value == "bidirectional") options.algorithm = SearchAlgorithm::Bidirectional;
+            else if (value == "cch") options.use_hierarchy = true;
+            else { error = "Unknown search algorithm: " + value; return false; }
+        } else if (key == "queue") {
+            if (value == "binary") options.queue = QueueType::BinaryHeap;
+            else if (value == "4ary") options.queue = QueueType::FourAryHeap;
+            else if (value == "radix") options.queue = QueueType::RadixHeap;
+            else if (value == "buckets") options.queue = QueueType::Buckets;
+            else { error = "Unknown queue type: " + value; return false; }
+        } else if (key == "mode") {
+            if (!parse_mode(value, options.mode)) { error = "Unknown route mode: " + value; return false; }
+        } else if (key == "stats") {
+            if (value == "1") options.stats = true;
+            else if (value == "0") options.stats = false;
+            else { error = "Invalid stats flag: " + value; return false; }
+        } else if (key == "cache") {
+            if (value == "1") options.use_cache = true;
+            else if (value == "0") options.use_cache = false;
+            else { error = "Invalid cache flag: " + value; return false; }
+        } else {
+            error = "Unknown route option: " + arg;
+            return false;
+        }
+    }
+    // The hierarchy is customized for the standard metric only
+    if (options.use_hierarchy && options.mode != CostModel::Standard) {
+        error = "search=cch supports mode=standard only";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * parse_isochrone_options
+ * Same key=value form as parse_route_options.
+ */
+bool parse_isochrone_options(const vector<string>& args, size_t first, IsochroneOptions& options, string& error) {
+    for (size_t i = first; i < args.size(); ++i) {
+        const string& arg = args[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+        if (key == "mode") {
+            if (!parse_mode(value, options.mode)) { error = "Unknown route mode: " + value; return false; }
+        } else if (key == "hull") {
+            if (value == "1") options.hull = true;
+            else if (value == "0") options.hull = false;
+            else { error = "Invalid hull flag: " + value; return false; }
+        } else if (key == "concavity") {
+            char* end = nullptr;
+            options.concavity = strtod(value.c_str(), &end);
+            if (value.empty() || *end != '\0' || !(options.concavity > 0)) { error = "Invalid concavity: " + value; return false; }
+        } else if (key == "threads") {
+            char* end = nullptr;
+            options.threads = static_cast<unsigned>(strtoul(value.c_str(), &end, 10));
+            if (value.empty() || *end != '\0') { error = "Invalid thread count: " + value; return false; }
+        } else {
+            error = "Unknown isochrone option: " + arg;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * parse_route_endpoint
+ * A route endpoint is either a node ID or "lat,lon" (the architecture's
+ * start_lat / start_lon). Coordinates must be in range.
+ */
+bool parse_route_endpoint(const string& text, RouteEndpoint& endpoint) {
+    const size_t comma = text.find(',');
+    endpoint = RouteEndpoint();
+    if (comma == string::npos) return parse_int_field(text, endpoint.node_id);
+
+    const string_view field(text);
+    endpoint.is_coordinate = true;
+    return parse_double_field(field.substr(0, comma), endpoint.latitude) &&
+           parse_double_field(field.substr(comma + 1), endpoint.longitude) &&
+           abs(endpoint.latitude) <= 90.0 && abs(endpoint.longitude) <= 180.0;
+}
+
+/**
+ * publish_hazards
+ * Writer side of the hazard state: if 'live' differs from the current snapshot,
+ * builds the next one (a copy of the registry, replaced in place so the epoch
+ * and changelog carry on) and swaps it in atomically. Queries still holding the
+ * previous snapshot finish on it; it is freed after the last one lets go.
+ */
+void publish_hazards(const vector<Hazard>& live) {
+    lock_guard<mutex> lock(hazard_writer);
+    // Writers are serialized, so the current snapshot cannot be retired under us
+    const HazardSnapshot* current = hazard_state.get();
+    if (current->hazards.matches(live)) return;
+
+    auto next = make_unique<HazardSnapshot>();
+    next->hazards = current->hazards;
+    next->hazards.replace_all(live);
+    hazard_state.publish(std::move(next));
+}
+
+// Current Unix time in seconds, the clock hazard expiry times are given in
+long long unix_time() {
+    return chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * publish_hazard_updates
+ * Writer side of the streaming interface: applies a batch of update records to
+ * a copy of the registry and publishes it if anything changed. The copy shares
+ * the changelog and spatial index with the current snapshot (HazardManager keeps
+ * both immutable), so only the ID map and expiry schedule are duplicated. Hazards
+ * already due at 'now' drop out in the same snapshot. Returns the records applied.
+ */
+size_t publish_hazard_updates(const vector<HazardUpdate>& updates, long long now, size_t& expired) {
+    lock_guard<mutex> lock(hazard_writer);
+    auto next = make_unique<HazardSnapshot>();
+    next->hazards = hazard_state.get()->hazards;
+    const size_t applied = next->hazards.apply(updates);
+    expired = next->hazards.expire(now);
+    if (applied > 0 || expired > 0) hazard_state.publish(std::move(next));
+    return applied;
+}
+
+/**
+ * expire_due_hazards
+ * Drops the hazards whose expiry time has passed. Readers only compare the
+ * clock with the earliest expiry (the top of the registry's expiry heap); a
+ * snapshot is copied and published only when something is actually due.
+ */
+size_t expire_due_hazards(long long now) {
+    {
+        rcu::ReadGuard pin;
+        if (hazard_state.get()->hazards.next_expiry() > now) return 0;
+    }
+    lock_guard<mutex> lock(hazard_writer);
+    if (hazard_state.get()->hazards.next_expiry() > now) return 0; // Another writer got there first
+    auto next = make_unique<HazardSnapshot>();
+    next->hazards = hazard_state.get()->hazards;
+    const size_t expired = next->hazards.expire(now);
+    hazard_state.publish(std::move(next));
+    return expired;
+}
+
+/**
+ * update_hazards
+ * Parses the hazard string and publishes it as the live hazard set, or keeps
+ * the resident set for kResidentHazards. Either way hazards past their expiry
+ * drop out first. Malformed records are skipped and returned in the report.
+ */
+ParseReport update_hazards(const string& hazards_str, RouteTimings* timings = nullptr) {
+    auto started = chrono::steady_clock::now();
+    ParseReport report;
+    if (hazards_str != kResidentHazards) {
+        // Input format: id|lat|lon|sev|type;id|lat|lon|sev|type
+        vector<Hazard> live;
+        parse_hazards(hazards_str, live, report);
+
+        // The payload is the complete live hazard list, so it replaces the registry
+        // (a no-op that keeps the epoch when the list is unchanged)
+        publish_hazards(live);
+    }
+    expire_due_hazards(unix_time());
+    if (timings) timings->parse_ms = elapsed_ms(started);
+    return report;
+}
+
+/**
+ * write_error
+ * The error document shared by every command: {"status": "error", "message": ...}.
+ */
+void write_error(JsonWriter& out, string_view message) {
+    out.begin_object().field("status", "error").field("message", message).end_object();
+}
+
+/**
+ * write_parse_report
+ * Adds a '"<key>": {...}' member describing the rejected records of a payload, if
+ * any, so a response can say which entries were ignored.
+ */
+void write_parse_report(JsonWriter& out, const char* key, const ParseReport& report) {
+    if (report.malformed == 0) return;
+    out.key(key).begin_object().field("count", report.malformed).key("records").begin_array();
+    for (const ParseReport::Error& error : report.errors) {
+        out.begin_object().field("index", error.record).field("reason", error.reason).end_object();
+    }
+    out.end_array().end_object();
+}
+
+/**
+ * overlay_for
+ * Edge-Weight Re-Optimization: the road topology is never copied. Penalties live
+ * in an overlay indexed by edge, computed once per hazard snapshot by whichever
+ * query needs it first (concurrent queries on the same snapshot wait for that one).
+ * A pooled overlay is usually just a few epochs behind, so only the roads near the
+ * hazards changed since are recomputed; a fresh one is built in full.
+ */
+const WeightOverlay& overlay_for(const HazardSnapshot& state, RouteTimings* timings = nullptr) {
+    auto started = chrono::steady_clock::now();
+    call_once(state.overlay_built, [&]() {
+        {
+            lock_guard<mutex> lock(overlay_pool_mutex);
+            if (!spare_overlays.empty()) {
+                state.overlay = std::move(spare_overlays.back());
+                spare_overlays.pop_back();
+            }
+        }
+        state.overlay.update(road_network, state.hazards);
+    });
+    if (timings) timings->overlay_ms += elapsed_ms(started);
+    return state.overlay;
+}
+
+/**
+ * snap_endpoint
+ * Places a route endpoint on the road network: coordinates are snapped to the
+ * nearest road segment through the edge index (built on first use), node IDs
+ * sit exactly on their node.
+ */
+RoadSnap snap_endpoint(const RouteEndpoint& endpoint) {
+    if (!endpoint.is_coordinate) {
+        const int index = road_network.index_of(endpoint.node_id);
+        return index < 0 ? RoadSnap() : EdgeIndex::at_node(road_network, index);
+    }
+    const EdgeIndex* index;
+    {
+        lock_guard<mutex> lock(edge_index_mutex);
+        if (!edge_index) edge_index = make_unique<EdgeIndex>(road_network);
+        index = edge_index.get();
+    }
+    return index->snap(road_network, endpoint.latitude, endpoint.longitude);
+}
+
+/**
+ * write_snap
+ * Adds a '"<key>": {...}' member describing where a coordinate was snapped:
+ * the point on the road, how far it moved, and the road (as its two nodes).
+ */
+void write_snap(JsonWriter& out, const char* key, const RoadSnap& snap) {
+    out.key(key).begin_object();
+    out.field("lat", snap.latitude).field("lon", snap.longitude);
+    out.field("distance_m", snap.distance_km * 1000.0);
+    out.key("edge").begin_array();
+    out.value(road_network.node_id(road_network.edge_source(snap.edge)));
+    out.value(road_network.node_id(road_network.edge_target(snap.edge)));
+    out.end_array();
+    out.field("fraction", snap.fraction);
+    out.end_object();
+}
+
+/**
+ * handle_route
+ * Responds to the "route" command from Flask.
+ * Logic:
+ * 1. Parses the hazard string into the registry (update_hazards) and pins the
+ *    resulting hazard snapshot for the rest of the query.
+ * 2. Answers from the route cache if a still-valid result of the same search is
+ *    there ("cached": true; its search counters read 0).
+ * 3. Otherwise refreshes the penalty overlay and runs Dijkstra over the shared
+ *    topology + overlay, and caches the result.
+ * 4. Outputs JSON result.
+ * When either endpoint is a coordinate, step 2-3 become: snap the coordinates
+ * onto the nearest roads and run Dijkstra between the snapped points (the
+ * route cache and the other search strategies apply to node IDs only).
+ * On a tiled map step 2-3 become a search over the tiles (Dijkstra or A*,
+ * standard mode), which scores hazard penalties itself instead of using the
+ * overlay; "stats=1" adds how many tiles it read and how many it had to map.
+ */
+void handle_route(JsonWriter& out, const RouteEndpoint& start, const RouteEndpoint& end,
+                  const string& hazards_str, const RouteOptions& options) {
+    if (tiled_network && (start.is_coordinate || end.is_coordinate || options.use_hierarchy ||
+                          options.algorithm == SearchAlgorithm::Bidirectional || options.mode != CostModel::Standard)) {
+        write_error(out, "A tiled map only routes between node IDs, with search=dijkstra or astar and mode=standard");
+        return;
+    }
+    RouteTimings timings;
+    ParseReport report = update_hazards(hazards_str, &timings);
+    const bool snapped = start.is_coordinate || end.is_coordinate;
+    rcu::ReadGuard pin;
+    const HazardSnapshot& state = *hazard_state.get();
+
+    // 2. Repeated origin/destination pairs skip the search entirely
+    PathResult result;
+    RoadSnap from, to;
+    bool cached = false;
+    const RouteCache::Key cache_key{start.node_id, end.node_id, options.mode,
+                                    options.use_hierarchy ? SearchAlgorithm::Dijkstra : options.algorithm,
+                                    options.use_hierarchy};
+    if (options.use_cache && !snapped && !tiled_network) {
+        auto started = chrono::steady_clock::now();
+        lock_guard<mutex> lock(route_cache_mutex);
+        if (const PathResult* hit = route_cache.lookup(road_network, state.hazards, cache_key)) {
+            result = *hit;
+            cached = true;
+        }
+        timings.search_ms = elapsed_ms(started);
+    }
+
+    // 3. DSA: Execute Dijkstra Pathfinding (or a hierarchy query on the same metric)
+    if (snapped) {
+        const WeightOverlay& overlay = overlay_for(state, &timings);
+        auto started = chrono::steady_clock::now();
+        from = snap_endpoint(start);
+        to = snap_endpoint(end);
+        timings.snap_ms = elapsed_ms(started);
+
+        started = chrono::steady_clock::now();
+        result = Dijkstra::find_safest_path(road_network, from, to, &overlay, options.queue, options.mode);
+        timings.search_ms = elapsed_ms(started);
+    } else if (tiled_network) {
+        auto started = chrono::steady_clock::now();
+        result = Dijkstra::find_safest_path(*tiled_network, start.node_id, end.node_id, &state.hazards, options.algorithm);
+        timings.search_ms = elapsed_ms(started);
+    } else if (!cached) {
+        const int start_id = start.node_id, end_id = end.node_id;
+        const WeightOverlay& overlay = overlay_for(state, &timings);
+        if (options.use_hierarchy) {
+            // Preprocess once per process; re-customize only when the hazard epoch moved
+            auto started = chrono::steady_clock::now();
+            lock_guard<mutex> lock(hierarchy_mutex);
+            if (!hierarchy) {
+                hierarchy = make_unique<ContractionHierarchy>(road_network);
+            }
+            if (!hierarchy->is_customized() || hierarchy_epoch != state.hazards.get_epoch()) {
+                hierarchy->customize(road_network, &overlay);
+                hierarchy_epoch = state.hazards.get_epoch();
+            }
+            timings.overlay_ms += elapsed_ms(started);
+
+            started = chrono::steady_clock::now();
+            result = hierarchy->find_safest_path(road_network, &overlay, start_id, end_id);
+            timings.search_ms = elapsed_ms(started);
+        } else {
+            auto started = chrono::steady_clock::now();
+            result = Dijkstra::find_safest_path(road_network, start_id, end_id, &overlay, options.algorithm, options.queue, options.mode);
+            timings.search_ms = elapsed_ms(started);
+        }
+        if (options.use_cache) {
+            lock_guard<mutex> lock(route_cache_mutex);
+            route_cache.store(road_network, state.hazards.get_epoch(), cache_key, result);
+        }
+    }
+
+    // 4. JSON Serialization for Flask Bridge
+    if (result.success) {
+        out.begin_object().field("status", "success").field("engine", "C++ Dijkstra");
+        out.key("data").begin_object();
+        out.field("safety_score", result.safety_score);
+        out.field("distance", result.total_distance);
+        out.key("path").begin_array();
+        for (int id : result.path) out.value(id);
+        out.end_array();
+        out.field("search", snapped ? "dijkstra" : search_name(options));
+        out.field("mode", mode_name(options.mode));
+        out.field("nodes_settled", result.stats.nodes_settled);
+        out.field("cached", cached);
+        if (start.is_coordinate) write_snap(out, "snapped_start", from);
+        if (end.is_coordinate) write_snap(out, "snapped_end", to);
+        if (options.stats) {
+            out.key("stats").begin_object();
+            out.field("parse_ms", timings.parse_ms);
+            out.field("overlay_ms", timings.overlay_ms);
+            if (snapped) out.field("snap_ms", timings.snap_ms);
+            out.field("search_ms", timings.search_ms);
+            out.field("nodes_settled", result.stats.nodes_settled);
+            out.field("edges_relaxed", result.stats.edges_relaxed);
+            out.field("queue_pushes", result.stats.queue_pushes);
+            out.field("peak_queue_size", result.stats.peak_queue_size);
+            if (tiled_network) {
+                out.field("tiles_touched", result.stats.tiles_touched);
+                out.field("tiles_loaded", result.stats.tiles_loaded);
+            }
+            out.end_object();
+        }
+        out.end_object();
+    } else {
+        out.begin_object().field("status", "error").field("message", "No path found between nodes");
+    }
+    write_parse_report(out, "malformed_hazards", report);
+    out.end_object();
+}
+
+/**
+ * handle_snap
+ * Responds to the "snap" command: where a coordinate lands on the road network,
+ * so the frontend can show the snapped point before asking for a route.
+ */
+void handle_snap(JsonWriter& out, double lat, double lon) {
+    if (tiled_network) {
+        write_error(out, "Snapping is not available on a tiled map");
+        return;
+    }
+    RouteEndpoint endpoint;
+    endpoint.is_coordinate = true;
+    endpoint.latitude = lat;
+    endpoint.longitude = lon;
+    const RoadSnap snap = snap_endpoint(endpoint);
+    if (!snap.found()) {
+        write_error(out, "Road network has no roads to snap to");
+        return;
+    }
+    out.begin_object().field("status", "success");
+    write_snap(out, "data", snap);
+    out.end_object();
+}
+
+/**
+ * handle_hazards
+ * Responds to the "hazards" command: streams add / update / remove / expire /
+ * clear records (see payload_parser.h) into the resident hazard registry as one
+ * new snapshot, so a client pushes only what changed and then routes with
+ * "live" instead of resending the full list. Reports how many records took
+ * effect, how many hazards expired, and the resulting registry.
+ */
+void handle_hazards(JsonWriter& out, const string& updates_str) {
+    vector<HazardUpdate> updates;
+    ParseReport report;
+    parse_hazard_updates(updates_str, updates, report);
+    size_t expired = 0;
+    const size_t applied = publish_hazard_updates(updates, unix_time(), expired);
+
+    rcu::ReadGuard pin;
+    const HazardManager& hazards = hazard_state.get()->hazards;
+    out.begin_object().field("status", "success");
+    out.key("data").begin_object();
+    out.field("applied", applied).field("ignored", updates.size() - applied).field("expired", expired);
+    out.field("active", hazards.size()).field("epoch", hazards.get_epoch());
+    if (hazards.next_expiry() != LLONG_MAX) out.field("next_expiry", hazards.next_expiry());
+    out.end_object();
+    write_parse_report(out, "malformed_updates", report);
+    out.end_object();
+}
+
+/**
+ * handle_route (node IDs)
+ * Shorthand for a route between two graph nodes.
+ */
+void handle_route(JsonWriter& out, int start_id, int end_id, const string& hazards_str, const RouteOptions& options) {
+    RouteEndpoint start, end;
+    start.node_id = start_id;
+    end.node_id = end_id;
+    handle_route(out, start, end, hazards_str, options);
+}
+
+/**
+ * parse_id_list
+ * Reads a comma-separated list of node IDs ("1,2,5").
+ */
+vector<int> parse_id_list(const string& list) {
+    vector<int> ids;
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (!item.empty()) ids.push_back(stoi(item));
+    }
+    return ids;
+}
+
+/**
+ * handle_matrix
+ * Responds to the "matrix" command: distance and safety between every source and
+ * every target. The hazard overlay is refreshed once for the whole batch, then one
+ * one-to-many search per source runs in parallel against the shared graph.
+ * Unreachable or unknown pairs are reported as null.
+ */
+void handle_matrix(JsonWriter& out, const string& sources_str, const string& targets_str, const string& hazards_str, unsigned threads) {
+    if (tiled_network) {
+        write_error(out, "Route matrices are not available on a tiled map");
+        return;
+    }
+    vector<int> sources = parse_id_list(sources_str);
+    vector<int> targets = parse_id_list(targets_str);
+    ParseReport report = update_hazards(hazards_str);
+    rcu::ReadGuard pin; // The matrix workers read the pinned snapshot's overlay
+    const WeightOverlay& overlay = overlay_for(*hazard_state.get());
+
+    vector<vector<MatrixCell>> matrix = Dijkstra::many_to_many(road_network, sources, targets, &overlay, threads);
+
+    auto write_ids = [&](const vector<int>& ids) {
+        out.begin_array();
+        for (int id : ids) out.value(id);
+        out.end_array();
+    };
+    auto write_table = [&](bool distance) {
+        out.begin_array();
+        for (const vector<MatrixCell>& row : matrix) {
+            out.begin_array();
+            for (const MatrixCell& cell : row) {
+                if (!cell.success) out.null();
+                else out.value(distance ? cell.total_distance : cell.safety_score);
+            }
+            out.end_array();
+        }
+        out.end_array();
+    };
+
+    out.begin_object().field("status", "success").field("engine", "C++ Dijkstra");
+    out.key("data").begin_object();
+    out.key("sources");
+    write_ids(sources);
+    out.key("targets");
+    write_ids(targets);
+    out.key("distance");
+    write_table(true);
+    out.key("safety_score");
+    write_table(false);
+    out.end_object();
+    write_parse_report(out, "malformed_hazards", report);
+    out.end_object();
+}
+
+/**
+ * handle_isochrone
+ * Responds to the "isochrone" command: for each origin, every intersection whose
+ * safest route costs at most 'budget' (the cost of find_safest_path under the
+ * chosen mode, i.e. km of safety-weighted cost), with that cost and the route
+ * length. Origins are searched in parallel against the pinned hazard snapshot.
+ * With hull=1 each result also carries a concave outline of the reached nodes
+ * as [lat, lon] pairs, for drawing coverage polygons.
+ */
+void handle_isochrone(JsonWriter& out, const string& origins_str, double budget, const string& hazards_str,
+                      const IsochroneOptions& options) {
+    if (tiled_network) {
+        write_error(out, "Isochrones are not available on a tiled map");
+        return;
+    }
+    vector<int> origins = parse_id_list(origins_str);
+    ParseReport report = update_hazards(hazards_str);
+    rcu::ReadGuard pin; // The search workers read the pinned snapshot's overlay
+    const WeightOverlay& overlay = overlay_for(*hazard_state.get());
+
+    vector<Isochrone> results = Dijkstra::reachable_within(road_network, origins, budget, &overlay,
+                                                           options.mode, options.threads);
+
+    out.begin_object().field("status", "success").field("engine", "C++ Dijkstra");
+    out.key("data").begin_object();
+    out.field("budget", budget).field("mode", mode_name(options.mode));
+    out.key("isochrones").begin_array();
+    for (const Isochrone& iso : results) {
+        out.begin_object().field("origin", iso.origin);
+        if (!iso.success) {
+            out.field("error", "Unknown origin node").end_object();
+            continue;
+        }
+        out.key("reached").begin_array();
+        for (const ReachedNode& r : iso.reached) {
+            out.begin_object().field("id", r.node_id).field("cost", r.cost).field("distance", r.distance).end_object();
+        }
+        out.end_array();
+        out.field("nodes_settled", iso.stats.nodes_settled);
+        if (options.hull) {
+            vector<hull::Point> points;
+            points.reserve(iso.reached.size());
+            for (const ReachedNode& r : iso.reached) {
+                const int v = road_network.index_of(r.node_id);
+                points.push_back({road_network.latitude(v), road_network.longitude(v)});
+            }
+            out.key("hull").begin_array();
+            for (const hull::Point& p : hull::concave_hull(points, options.concavity)) {
+                out.begin_array().value(p.latitude).value(p.longitude).end_array();
+            }
+            out.end_array();
+        }
+        out.end_object();
+    }
+    out.end_array();
+    out.end_object();
+    write_parse_report(out, "malformed_hazards", report);
+    out.end_object();
+}
+
+/**
+ * load_candidates
+ * Reads the candidate list shared by the KD-Tree commands (see payload_parser.h).
+ * Format: name|lat|lon[|type];name|lat|lon[|type]. Entries without a type are "Dynamic".
+ */
+vector<Facility> load_candidates(const string& candidates_str, ParseReport& report) {
+    vector<Facility> candidates;
+    parse_candidates(candidates_str, candidates, report);
+    return candidates;
+}
+
+/**
+ * handle_dynamic_nearest
+ * Demonstration of Global KD-Tree Search.
+ * This function builds a decision tree on the fly from a list of candidates.
+ */
+void handle_dynamic_nearest(JsonWriter& out, double user_lat, double user_lon, const string& candidates_str) {
+    // DSA: O(N log N) bulk build by median splits (balanced for any candidate order)
+    ParseReport report;
+    KDTree dynamic_tree(load_candidates(candidates_str, report)); // Temporary KD-Tree for this specific search
+
+    // DSA: O(log N) Nearest Neighbor search
+    Facility f = dynamic_tree.find_nearest(user_lat, user_lon);
+    
+    // Output JSON back to Flask
+    out.begin_object().field("status", "success").field("engine", "C++ KD-Tree");
+    out.key("data").begin_object();
+    out.field("name", f.name).field("type", "Nearest Identified by C++");
+    out.field("lat", f.latitude).field("lon", f.longitude);
+    out.end_object();
+    write_parse_report(out, "malformed_candidates", report);
+    out.end_object();
+}
+
+/**
+ * write_facility_list
+ * Prints the facilities at the given tree positions (nearest first) as a JSON array,
+ * each with its great-circle distance from the user, plus any rejected candidates.
+ */
+void write_facility_list(JsonWriter& out, const KDTree& tree, const vector<int>& hits, double user_lat, double user_lon,
+                         const ParseReport& report) {
+    out.begin_object().field("status", "success").field("engine", "C++ KD-Tree");
+    out.key("data").begin_array();
+    for (int index : hits) {
+        const Facility& f = tree.facility(index);
+        out.begin_object().field("name", f.name).field("type", f.type);
+        out.field("lat", f.latitude).field("lon", f.longitude);
+        out.field("distance_km", geo::haversine_km(user_lat, user_lon, f.latitude, f.longitude));
+        out.end_object();
+    }
+    out.end_array();
+    write_parse_report(out, "malformed_candidates", report);
+    out.end_object();
+}
+
+/**
+ * handle_k_nearest
+ * "The 5 closest hospitals": the k nearest candidates, optionally of one type only.
+ */
+void handle_k_nearest(JsonWriter& out, double user_lat, double user_lon, int k, const string& candidates_str, const string& type) {
+    ParseReport report;
+    KDTree tree(load_candidates(candidates_str, report));
+    vector<int> hits = tree.find_k_nearest(user_lat, user_lon, k > 0 ? static_cast<size_t>(k) : 0, type);
+    write_facility_list(out, tree, hits, user_lat, user_lon, report);
+}
+
+/**
+ * handle_within_radius
+ * "All police posts within 2 km". The tree works in coordinate degrees, so the
+ * radius is widened to a degree box that surely contains the circle (longitude
+ * degrees shrink with cos(latitude)), and the hits are then filtered by haversine.
+ */
+void handle_within_radius(JsonWriter& out, double user_lat, double user_lon, double radius_km, const string& candidates_str, const string& type) {
+    ParseReport report;
+    KDTree tree(load_candidates(candidates_str, report));
+
+    const double km_per_degree = geo::kEarthRadiusKm * geo::kDegToRad;
+    double lat_span = radius_km / km_per_degree;
+    double widest_lat = min(90.0, fabs(user_lat) + lat_span);
+    double cos_lat = cos(widest_lat * geo::kDegToRad);
+    double radius_deg = cos_lat > 1e-6 ? lat_span / cos_lat : 360.0;
+
+    vector<pair<double, int>> inside;
+    for (int index : tree.find_within_radius(user_lat, user_lon, radius_deg, type)) {
+        const Facility& f = tree.facility(index);
+        double km = geo::haversine_km(user_lat, user_lon, f.latitude, f.longitude);
+        if (km <= radius_km) inside.push_back({km, index});
+    }
+
+    // Re-rank by true distance; degree order can differ slightly away from the equator
+    sort(inside.begin(), inside.end());
+    vector<int> hits;
+    for (const auto& entry : inside) hits.push_back(entry.second);
+    write_facility_list(out, tree, hits, user_lat, user_lon, report);
+}
+
+/**
+ * dispatch_command
+ * Routes one command (name + arguments, exactly as they would appear on the
+ * command line after the executable name) to its handler.
+ * Shared by the one-shot CLI mode and the long-running serve mode so both
+ * speak the same command language.
+ */
+void dispatch_command(JsonWriter& out, const vector<string>& args) {
+    if (args.empty()) {
+        write_error(out, "No command provided");
+        out.newline();
+        return;
+    }
+
+    const string& cmd = args[0];
+    try {
+        if (cmd == "dynamic_nearest" && args.size() == 4) {
+            // Find nearest facility using KD-Tree
+            handle_dynamic_nearest(out, stod(args[1]), stod(args[2]), args[3]);
+        } else if (cmd == "k_nearest" && (args.size() == 5 || args.size() == 6)) {
+            // Command signature: amaan_engine k_nearest <lat> <lon> <k> <candidates> [type]
+            handle_k_nearest(out, stod(args[1]), stod(args[2]), stoi(args[3]), args[4], args.size() == 6 ? args[5] : "");
+        } else if (cmd == "within_radius" && (args.size() == 5 || args.size() == 6)) {
+            // Command signature: amaan_engine within_radius <lat> <lon> <radius_km> <candidates> [type]
+            handle_within_radius(out, stod(args[1]), stod(args[2]), stod(args[3]), args[4], args.size() == 6 ? args[5] : "");
+        } else if (cmd == "route" && args.size() >= 4) {
+            // Command signature: amaan_engine route <start_id|lat,lon> <end_id|lat,lon> <hazards_str|live> [search=dijkstra|astar|bidirectional|cch] [queue=binary|4ary|radix|buckets] [mode=standard|eta|night|vulnerable] [stats=1] [cache=0]
+            RouteOptions options;
+            RouteEndpoint start, end;
+            string error;
+            if (!parse_route_endpoint(args[1], start) || !parse_route_endpoint(args[2], end)) {
+                write_error(out, "Invalid route endpoint: expected a node ID or lat,lon");
+            } else if (!parse_route_options(args, 4, options, error)) {
+                write_error(out, error);
+            } else {
+                handle_route(out, start, end, args[3], options);
+            }
+        } else if (cmd == "hazards" && args.size() == 2) {
+            // Command signature: amaan_engine hazards <updates> (add|..;update|..;remove|id;expire|id|t;clear)
+            handle_hazards(out, args[1]);
+        } else if (cmd == "snap" && args.size() == 3) {
+            // Command signature: amaan_engine snap <lat> <lon>
+            handle_snap(out, stod(args[1]), stod(args[2]));
+        } else if (cmd == "matrix" && (args.size() == 4 || args.size() == 5)) {
+            // Command signature: amaan_engine matrix <source_ids> <target_ids> <hazards_str|live> [threads=N]
+            if (args.size() == 5 && args[4].compare(0, 8, "threads=") != 0) {
+                write_error(out, "Unknown matrix option: " + args[4]);
+            } else {
+                unsigned threads = args.size() == 5 ? static_cast<unsigned>(stoul(args[4].substr(8))) : 0;
+                handle_matrix(out, args[1], args[2], args[3], threads);
+            }
+        } else if (cmd == "isochrone" && args.size() >= 4) {
+            // Command signature: amaan_engine isochrone <origin_ids> <budget> <hazards_str|live> [mode=standard|eta|night|vulnerable] [hull=1] [concavity=X] [threads=N]
+            IsochroneOptions options;
+            string error;
+            if (!parse_isochrone_options(args, 4, options, error)) {
+                write_error(out, error);
+            } else {
+                handle_isochrone(out, args[1], stod(args[2]), args[3], options);
+            }
+        } else if (cmd == "ping") {
+            // Liveness probe used by the Flask worker pool
+            out.begin_object().field("status", "success").field("data", "pong").end_object();
+        } else {
+            // Error handling for invalid calls (argument count includes the executable name)
+            write_error(out, "Invalid command or arguments. Provided: " + cmd + " with " + to_string(args.size() + 1) + " args.");
+        }
+    } catch (const exception&) {
+        // Malformed numbers (stoi/stod) must not take down a resident worker;
+        // drop whatever part of the document was written before the failure
+        out.clear();
+        write_error(out, "Malformed arguments for " + cmd);
+    }
+    out.newline();
+}
+
+/**
+ * split_payload
+ * Splits a serve-mode request payload into its tab-separated arguments.
+ */
+vector<string> split_payload(const string& payload) {
+    vector<string> args;
+    size_t begin = 0;
+    while (begin <= payload.size()) {
+        size_t end = payload.find('\t', begin);
+        if (end == string::npos) end = payload.size();
+        args.push_back(payload.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return args;
+}
+
+/**
+ * latency_label
+ * Histogram a command is recorded under. Unknown commands share one bucket so a
+ * misbehaving client cannot grow the table without bound.
+ */
+string latency_label(const string& cmd) {
+    static const char* const known[] = {"route", "matrix", "isochrone", "hazards", "dynamic_nearest", "k_nearest", "within_radius", "ping"};
+    for (const char* name : known) {
+        if (cmd == name) return cmd;
+    }
+    return "other";
+}
+
+/**
+ * handle_stats
+ * Responds to the serve-mode "stats" command with a latency summary of every
+ * command this worker has answered so far (microseconds, from the histograms),
+ * plus the route cache counters and the state of the hazard snapshots (and of
+ * the tile cache on a tiled map).
+ */
+void handle_stats(JsonWriter& out) {
+    out.begin_object().field("status", "success").key("data").begin_object();
+    {
+        lock_guard<mutex> lock(latency_mutex);
+        for (const auto& entry : command_latency) {
+            const LatencyHistogram& h = entry.second;
+            out.key(entry.first).begin_object();
+            out.field("count", h.count());
+            out.field("mean_us", h.mean());
+            out.field("p50_us", h.percentile(50));
+            out.field("p90_us", h.percentile(90));
+            out.field("p99_us", h.percentile(99));
+            out.field("p999_us", h.percentile(99.9));
+            out.field("max_us", h.max());
+            out.end_object();
+        }
+    }
+    {
+        lock_guard<mutex> lock(route_cache_mutex);
+        const RouteCache::Counters& cache = route_cache.stats();
+        out.key("route_cache").begin_object();
+        out.field("entries", route_cache.size());
+        out.field("hits", cache.hits).field("misses", cache.misses);
+        out.field("invalidated", cache.invalidated).field("evictions", cache.evictions);
+        out.end_object();
+    }
+    {
+        rcu::ReadGuard pin;
+        out.key("hazard_snapshot").begin_object();
+        out.field("epoch", hazard_state.get()->hazards.get_epoch());
+        out.field("retired_pending", rcu::pending()); // Old snapshots still held by running queries
+        out.end_object();
+    }
+    out.key("search_workspaces").begin_object();
+    out.field("allocations", SearchWorkspace::allocations()); // Flat once every thread has searched this map
+    out.field("pool_helpers", WorkerPool::shared().helper_count());
+    out.end_object();
+    if (tiled_network) {
+        const TiledGraph::CacheCounters tiles = tiled_network->cache_counters();
+        out.key("tiles").begin_object();
+        out.field("tile_count", tiled_network->tile_count());
+        out.field("resident", tiles.resident).field("resident_bytes", tiles.resident_bytes);
+        out.field("max_resident", tiles.max_resident);
+        out.field("requests", tiles.requests).field("loads", tiles.loads).field("evictions", tiles.evictions);
+        out.end_object();
+    }
+    out.end_object().end_object().newline();
+}
+
+/**
+ * serve_request
+ * Executes one serve-mode request into 'response': "@file" arguments are read
+ * first (stdin carries the frames, so "-" is refused), and every command except
+ * "stats" is timed into its latency histogram.
+ */
+void serve_request(JsonWriter& response, vector<string>& args) {
+    response.clear();
+    string error;
+    for (size_t i = 1; i < args.size() && error.empty(); ++i) {
+        load_payload_argument(args[i], false, error);
+    }
+    if (!error.empty()) {
+        write_error(response, error);
+        response.newline();
+        return;
+    }
+    if (args[0] == "stats") {
+        handle_stats(response);
+        return;
+    }
+
+    auto started = chrono::steady_clock::now();
+    dispatch_command(response, args);
+    auto micros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started).count();
+    lock_guard<mutex> lock(latency_mutex);
+    command_latency[latency_label(args[0])].record(static_cast<uint64_t>(micros));
+}
+
+// Sends one length-prefixed response frame with a single flush
+void write_frame(ostream& out, const string& request_id, const JsonWriter& response) {
+    const string frame_header = request_id + ' ' + to_string(response.size()) + '\n';
+    out.write(frame_header.data(), static_cast<streamsize>(frame_header.size()));
+    response.write_to(out);
+    out.flush();
+}
+
+/**
+ * run_server
+ * Long-running mode: the graph, hazard registry and indexes stay resident and
+ * requests are answered in a loop until stdin closes or "shutdown" arrives.
+ *
+ * Framing (both directions): a header line "<request_id> <byte_count>\n"
+ * followed by exactly byte_count bytes of body.
+ * - Request body: the command and its arguments separated by '\t'.
+ * - Response body: the JSON document the CLI mode would have printed.
+ * Length-prefixing means payloads may contain any byte except '\t' and are
+ * never limited by the OS argv size.
+ * Every request's latency is recorded per command; "stats" reports them.
+ *
+ * With 'threads' > 1 this thread only reads frames and hands them to a pool of
+ * workers, so many queries run at once while hazard updates carried by other
+ * requests are published as new snapshots. Responses are written whole, in
+ * completion order; clients match them to requests by request_id.
+ */
+int run_server(istream& in, ostream& out, unsigned threads) {
+    // Every frame is flushed explicitly; a tied 'out' would also be flushed by each
+    // read here, outside the workers' output lock
+    in.tie(nullptr);
+
+    struct Request {
+        string id;
+        vector<string> args;
+    };
+    deque<Request> pending;
+    mutex pending_mutex, out_mutex;
+    condition_variable pending_ready;
+    bool input_done = false;
+
+    auto worker = [&]() {
+        JsonWriter response(64 * 1024); // Grows to the largest response seen, then stays
+        for (;;) {
+            Request request;
+            {
+                unique_lock<mutex> lock(pending_mutex);
+                pending_ready.wait(lock, [&]() { return input_done || !pending.empty(); });
+                if (pending.empty()) return;
+                request = std::move(pending.front());
+                pending.pop_front();
+            }
+            serve_request(response, request.args);
+            lock_guard<mutex> lock(out_mutex);
+            write_frame(out, request.id, response);
+        }
+    };
+    vector<thread> pool;
+    for (unsigned t = 0; threads > 1 && t < threads; ++t) pool.emplace_back(worker);
+    JsonWriter response(64 * 1024); // Single-threaded mode answers inline
+
+    int status = 0;
+    string header;
+    while (getline(in, header)) {
+        if (header.empty()) continue;
+
+        // 1. Read the frame header
+        string request_id;
+        size_t length = 0;
+        stringstream hs(header);
+        if (!(hs >> request_id >> length)) {
+            cerr << "amaan_engine: malformed frame header: " << header << endl;
+            status = 1;
+            break;
+        }
+
+        // 2. Read exactly 'length' bytes of payload
+        string payload(length, '\0');
+        if (length > 0 && !in.read(&payload[0], length)) {
+            cerr << "amaan_engine: truncated frame " << request_id << endl;
+            status = 1;
+            break;
+        }
+
+        vector<string> args = split_payload(payload);
+        if (args[0] == "shutdown") break;
+
+        // 3. Execute (inline, or on the next free worker) and send the response frame
+        if (pool.empty()) {
+            serve_request(response, args);
+            write_frame(out, request_id, response);
+        } else {
+            lock_guard<mutex> lock(pending_mutex);
+            pending.push_back({request_id, std::move(args)});
+            pending_ready.notify_one();
+        }
+    }
+
+    // Requests already read are still answered before exiting
+    {
+        lock_guard<mutex> lock(pending_mutex);
+        input_done = true;
+    }
+    pending_ready.notify_all();
+    for (thread& t : pool) t.join();
+    return status;
+}
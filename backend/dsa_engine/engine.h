@@ -0,0 +1,104 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "csr_graph.h"
+#include "dijkstra.h"
+#include "graph_tiles.h"
+#include "json_writer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * AMAAN Engine Front-End
+ * The command layer shared by the CLI entry point (main.cpp), the resident
+ * serve mode and the benchmarks. It owns the process-wide state: the road
+ * network, the hazard snapshot (registry + penalty overlay, replaced atomically
+ * on every hazard change, see rcu.h) and the lazily built contraction hierarchy
+ * and edge index. Handlers may run concurrently. Every handler writes one JSON
+ * document to 'out' (without the trailing newline, which dispatch_command adds).
+ */
+
+/**
+ * RouteOptions
+ * Optional per-query settings for the "route" command, passed as trailing
+ * key=value arguments (e.g. "search=astar").
+ */
+struct RouteOptions {
+    SearchAlgorithm algorithm = SearchAlgorithm::Dijkstra;
+    bool use_hierarchy = false; // "search=cch": answer from the contraction hierarchy
+    QueueType queue = QueueType::BinaryHeap; // "queue=": priority queue for the graph searches
+    CostModel mode = CostModel::Standard;    // "mode=": what the route optimizes
+    bool stats = false;                      // "stats=1": append a timing / work breakdown
+    bool use_cache = true;                   // "cache=0": always search, bypassing the route cache
+};
+
+/**
+ * IsochroneOptions
+ * Optional settings for the "isochrone" command, passed as trailing key=value
+ * arguments (e.g. "mode=night hull=1").
+ */
+struct IsochroneOptions {
+    CostModel mode = CostModel::Standard; // "mode=": cost model the budget is measured in
+    bool hull = false;                    // "hull=1": add a concave outline of each reached set
+    double concavity = 2.0;               // "concavity=": hull tightness (see hull::concave_hull)
+    unsigned threads = 0;                 // "threads=": cap on threads for many origins (0 = all cores)
+};
+
+/**
+ * RouteEndpoint
+ * One end of a "route" query: a node ID ("5"), or a raw coordinate ("33.71,73.05")
+ * that is snapped to the nearest road segment.
+ */
+struct RouteEndpoint {
+    bool is_coordinate = false;
+    int node_id = 0;
+    double latitude = 0;
+    double longitude = 0;
+};
+
+// Loads the map from a binary graph file or a tile file, or the built-in Islamabad demo map
+// if 'graph_path' is empty. 'max_resident_tiles' caps the tiles kept mapped (tile files only).
+void load_road_network(const std::string& graph_path,
+                       size_t max_resident_tiles = TiledGraph::kDefaultResidentTiles);
+
+// Replaces the map with an already compiled network (e.g. a synthetic benchmark city)
+void use_road_network(CSRGraph graph);
+
+// Reads key=value route options from args[first..]; false (with 'error' set) on a bad option
+bool parse_route_options(const std::vector<std::string>& args, size_t first, RouteOptions& options, std::string& error);
+
+// Reads key=value isochrone options from args[first..]; false (with 'error' set) on a bad option
+bool parse_isochrone_options(const std::vector<std::string>& args, size_t first, IsochroneOptions& options, std::string& error);
+
+// Reads a route endpoint (node ID or "lat,lon"); false if it is neither
+bool parse_route_endpoint(const std::string& text, RouteEndpoint& endpoint);
+
+// Passed as the hazard list of route / matrix / isochrone to keep the resident hazard set
+// (maintained with the "hazards" command) instead of replacing it
+constexpr const char* kResidentHazards = "live";
+
+// Command handlers (see engine.cpp for the argument formats)
+void handle_route(JsonWriter& out, const RouteEndpoint& start, const RouteEndpoint& end,
+                  const std::string& hazards_str, const RouteOptions& options);
+void handle_route(JsonWriter& out, int start_id, int end_id, const std::string& hazards_str, const RouteOptions& options);
+void handle_snap(JsonWriter& out, double lat, double lon);
+void handle_hazards(JsonWriter& out, const std::string& updates_str);
+void handle_matrix(JsonWriter& out, const std::string& sources_str, const std::string& targets_str,
+                   const std::string& hazards_str, unsigned threads);
+void handle_isochrone(JsonWriter& out, const std::string& origins_str, double budget,
+                      const std::string& hazards_str, const IsochroneOptions& options);
+void handle_dynamic_nearest(JsonWriter& out, double user_lat, double user_lon, const std::string& candidates_str);
+void handle_k_nearest(JsonWriter& out, double user_lat, double user_lon, int k,
+                      const std::string& candidates_str, const std::string& type);
+void handle_within_radius(JsonWriter& out, double user_lat, double user_lon, double radius_km,
+                          const std::string& candidates_str, const std::string& type);
+
+// Routes one command (name + arguments, as on the command line) to its handler
+void dispatch_command(JsonWriter& out, const std::vector<std::string>& args);
+
+// Long-running worker loop over length-prefixed frames, answering on 'threads'
+// concurrent workers (1 = in order, inline); returns the process exit code
+int run_server(std::istream& in, std::ostream& out, unsigned threads = 1);
+
+#endif // ENGINE_H
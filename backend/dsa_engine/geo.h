@@ -0,0 +1,31 @@
+#ifndef GEO_H
+#define GEO_H
+
+#include <cmath>
+
+/**
+ * Geographic helpers shared by the engine components.
+ * Coordinates are WGS84 degrees; distances are kilometers.
+ */
+namespace geo {
+
+// Mean Earth radius used by the haversine formula
+constexpr double kEarthRadiusKm = 6371.0088;
+constexpr double kDegToRad = 3.14159265358979323846 / 180.0;
+
+/**
+ * haversine_km
+ * Great-circle distance between two coordinates. No road between two points
+ * can be shorter than this, which makes it a safe lower bound for searches.
+ */
+inline double haversine_km(double lat1, double lon1, double lat2, double lon2) {
+    double d_lat = (lat2 - lat1) * kDegToRad;
+    double d_lon = (lon2 - lon1) * kDegToRad;
+    double a = std::sin(d_lat / 2) * std::sin(d_lat / 2) +
+               std::cos(lat1 * kDegToRad) * std::cos(lat2 * kDegToRad) * std::sin(d_lon / 2) * std::sin(d_lon / 2);
+    return 2.0 * kEarthRadiusKm * std::asin(std::sqrt(std::fmin(1.0, a)));
+}
+
+} // namespace geo
+
+#endif // GEO_H
@@ -1,18 +1,6 @@
 #include "graph.h"
 #include <stdexcept>
 
-/**
- * Edge::get_weight
- * This is the 'Cost Function' for our Dijkstra algorithm.
- * It determines how 'expensive' it is to travel a road.
- * Calculation: Distance (km) + Danger Penalty - Safety Bonus
- * Rationale: Allows the engine to prefer a slightly longer but safer route.
- */
-double Edge::get_weight() const {
-    // AMAAN Formula: We integrate safety variables directly into the pathfinding cost.
-    return distance + hazard_penalty - safety_bonus;
-}
-
 /**
  * Graph::add_node
  * Adds a new geographic location (Node) to our internal city map.
@@ -37,6 +25,14 @@ void Graph::add_edge(int u, int v, double dist, double hazard, double safety) {
     adjacency_list[v].push_back({u, dist, hazard, safety});
 }
 
+/**
+ * Graph::add_one_way_edge
+ * Creates a single directed connection from U to V.
+ */
+void Graph::add_one_way_edge(int u, int v, double dist, double hazard, double safety) {
+    adjacency_list[u].push_back({v, dist, hazard, safety});
+}
+
 /**
  * Graph::get_neighbors
  * Returns a list of all roads connected to the specified node.
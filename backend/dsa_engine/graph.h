@@ -31,8 +31,14 @@ struct Edge {
      * get_weight
      * Calculates the 'cost' of traversing this road.
      * We aim for: MIN(Distance + Danger - Safety)
+     * Rationale: Allows the engine to prefer a slightly longer but safer route.
+     * Defined inline so the compiler can fold it into the loops that call it.
+     * (The per-mode routing costs live in cost_policies.h.)
      */
-    double get_weight() const;
+    double get_weight() const {
+        // AMAAN Formula: We integrate safety variables directly into the pathfinding cost.
+        return distance + hazard_penalty - safety_bonus;
+    }
 };
 
 /**
@@ -54,6 +60,9 @@ public:
     
     // Connects two nodes with a physical road and optional predefined safety metrics
     void add_edge(int u, int v, double dist, double hazard = 0.0, double safety = 0.0);
+
+    // Connects U to V in one direction only (one-way streets from imported road data)
+    void add_one_way_edge(int u, int v, double dist, double hazard = 0.0, double safety = 0.0);
     
     // Returns all outward-bound roads from a specific node
     const std::vector<Edge>& get_neighbors(int node_id) const;
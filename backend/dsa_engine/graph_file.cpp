@@ -0,0 +1,236 @@
+#include "graph_file.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[8] = {'A', 'M', 'A', 'A', 'N', 'G', 'R', '\0'};
+const uint32_t kByteOrderMark = 0x01020304;
+
+// Section indices inside GraphFileHeader::section
+enum Section {
+    kNodeIds, kSortedIds, kSortedIndex, kLatitudes, kLongitudes, kNameOffsets, kNameChars,
+    kOffsets, kSources, kTargets, kWeights, kLengths, kHazards, kInOffsets, kInEdges, kSectionCount
+};
+
+/**
+ * section_sizes
+ * Byte size of every section for a graph of the given dimensions.
+ */
+std::vector<uint64_t> section_sizes(uint64_t nodes, uint64_t edges, uint64_t name_bytes) {
+    std::vector<uint64_t> size(kSectionCount);
+    size[kNodeIds] = size[kSortedIds] = size[kSortedIndex] = nodes * sizeof(int32_t);
+    size[kLatitudes] = size[kLongitudes] = nodes * sizeof(double);
+    size[kNameOffsets] = (nodes + 1) * sizeof(uint32_t);
+    size[kNameChars] = name_bytes;
+    size[kOffsets] = size[kInOffsets] = (nodes + 1) * sizeof(int32_t);
+    size[kSources] = size[kTargets] = size[kInEdges] = edges * sizeof(int32_t);
+    size[kWeights] = size[kLengths] = size[kHazards] = edges * sizeof(double);
+    return size;
+}
+
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+} // namespace
+
+/**
+ * MappedFile::MappedFile
+ * Opens the file read-only and maps all of it into the address space.
+ */
+MappedFile::MappedFile(const std::string& path) : MappedFile(path, 0, 0) {}
+
+/**
+ * MappedFile::MappedFile (range)
+ * Mappings must start on the OS granularity (page size on POSIX, allocation
+ * granularity on Windows), so the view begins at the range start rounded down
+ * and 'base' points at the requested byte inside it. bytes == 0 with offset 0
+ * means the whole file.
+ */
+MappedFile::MappedFile(const std::string& path, uint64_t offset, size_t bytes) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open graph file: " + path);
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    const uint64_t total = static_cast<uint64_t>(file_size.QuadPart);
+    if (offset == 0 && bytes == 0) bytes = static_cast<size_t>(total);
+    if (offset > total || bytes > total - offset) {
+        CloseHandle(file);
+        throw std::runtime_error("Range outside graph file: " + path);
+    }
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    const uint64_t start = offset - offset % system.dwAllocationGranularity;
+    length = bytes;
+    view_length = static_cast<size_t>(offset - start) + bytes;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot map graph file: " + path);
+    }
+    view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, static_cast<DWORD>(start >> 32),
+                                                  static_cast<DWORD>(start & 0xffffffffu), view_length));
+    file_handle = file;
+    mapping_handle = mapping;
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        mapping_handle = file_handle = nullptr;
+        throw std::runtime_error("Cannot map graph file: " + path);
+    }
+    base = view + (offset - start);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open graph file: " + path);
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Cannot read graph file: " + path);
+    }
+    const uint64_t total = static_cast<uint64_t>(info.st_size);
+    if (offset == 0 && bytes == 0) bytes = static_cast<size_t>(total);
+    if (offset > total || bytes > total - offset) {
+        close(fd);
+        throw std::runtime_error("Range outside graph file: " + path);
+    }
+    const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t start = offset - offset % page;
+    length = bytes;
+    view_length = static_cast<size_t>(offset - start) + bytes;
+    void* mapped = mmap(nullptr, view_length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(start));
+    close(fd); // The mapping stays valid after the descriptor is closed
+    if (mapped == MAP_FAILED) throw std::runtime_error("Cannot map graph file: " + path);
+    view = static_cast<const char*>(mapped);
+    base = view + (offset - start);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (view) UnmapViewOfFile(view);
+    if (mapping_handle) CloseHandle(static_cast<HANDLE>(mapping_handle));
+    if (file_handle) CloseHandle(static_cast<HANDLE>(file_handle));
+#else
+    if (view) munmap(const_cast<char*>(view), view_length);
+#endif
+}
+
+/**
+ * GraphFile::write
+ * Lays the sections out back to back (8-byte aligned) after the header and
+ * streams every column straight from the graph's arrays.
+ */
+void GraphFile::write(const CSRGraph& graph, const std::string& path) {
+    const CSRGraph::Columns& c = graph.columns();
+    const uint64_t nodes = graph.node_count();
+    const uint64_t edges = graph.edge_count();
+    const uint64_t name_bytes = nodes > 0 ? c.name_offsets[nodes] : 0;
+
+    GraphFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    header.node_count = nodes;
+    header.edge_count = edges;
+    header.name_bytes = name_bytes;
+    header.heuristic_scale = graph.heuristic_scale();
+
+    std::vector<uint64_t> size = section_sizes(nodes, edges, name_bytes);
+    uint64_t cursor = align8(sizeof(GraphFileHeader));
+    for (int s = 0; s < kSectionCount; ++s) {
+        header.section[s] = cursor;
+        cursor = align8(cursor + size[s]);
+    }
+
+    // An empty graph has no name table; write a single zero offset for it
+    const uint32_t zero = 0;
+    const void* source[kSectionCount] = {
+        c.node_ids, c.sorted_ids, c.sorted_index, c.latitudes, c.longitudes,
+        nodes > 0 ? static_cast<const void*>(c.name_offsets) : &zero, c.name_chars,
+        nodes > 0 ? static_cast<const void*>(c.offsets) : &zero, c.sources, c.targets,
+        c.weights, c.lengths, c.hazards,
+        nodes > 0 ? static_cast<const void*>(c.in_offsets) : &zero, c.in_edges
+    };
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot create graph file: " + path);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t written = sizeof(header);
+    const char padding[8] = {0};
+    for (int s = 0; s < kSectionCount; ++s) {
+        out.write(padding, header.section[s] - written);
+        if (size[s] > 0) out.write(static_cast<const char*>(source[s]), size[s]);
+        written = header.section[s] + size[s];
+    }
+    out.write(padding, cursor - written);
+    if (!out) throw std::runtime_error("Failed while writing graph file: " + path);
+}
+
+/**
+ * GraphFile::load
+ * Maps the file and checks everything that can be checked without touching
+ * the column data (so startup stays O(1)): magic, version, byte order, and that
+ * every section lies inside the file. The edge slices are trusted as written.
+ */
+CSRGraph GraphFile::load(const std::string& path) {
+    auto file = std::make_shared<MappedFile>(path);
+    if (file->size() < sizeof(GraphFileHeader)) throw std::runtime_error("Graph file too small: " + path);
+
+    GraphFileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) throw std::runtime_error("Not an AMAAN graph file: " + path);
+    if (header.byte_order != kByteOrderMark) throw std::runtime_error("Graph file has foreign byte order: " + path);
+    if (header.version != kVersion) throw std::runtime_error("Unsupported graph file version " + std::to_string(header.version) + ": " + path);
+    if (header.node_count > 0x7fffffff || header.edge_count > 0x7fffffff) throw std::runtime_error("Graph file too large for 32-bit indices: " + path);
+
+    std::vector<uint64_t> size = section_sizes(header.node_count, header.edge_count, header.name_bytes);
+    for (int s = 0; s < kSectionCount; ++s) {
+        if (header.section[s] % 8 != 0 || header.section[s] > file->size() || size[s] > file->size() - header.section[s]) {
+            throw std::runtime_error("Corrupt section table in graph file: " + path);
+        }
+    }
+
+    const char* base = file->data();
+    auto at = [&](int s) { return base + header.section[s]; };
+    CSRGraph::Columns c;
+    c.node_ids = reinterpret_cast<const int32_t*>(at(kNodeIds));
+    c.sorted_ids = reinterpret_cast<const int32_t*>(at(kSortedIds));
+    c.sorted_index = reinterpret_cast<const int32_t*>(at(kSortedIndex));
+    c.latitudes = reinterpret_cast<const double*>(at(kLatitudes));
+    c.longitudes = reinterpret_cast<const double*>(at(kLongitudes));
+    c.name_offsets = reinterpret_cast<const uint32_t*>(at(kNameOffsets));
+    c.name_chars = at(kNameChars);
+    c.offsets = reinterpret_cast<const int32_t*>(at(kOffsets));
+    c.sources = reinterpret_cast<const int32_t*>(at(kSources));
+    c.targets = reinterpret_cast<const int32_t*>(at(kTargets));
+    c.weights = reinterpret_cast<const double*>(at(kWeights));
+    c.lengths = reinterpret_cast<const double*>(at(kLengths));
+    c.hazards = reinterpret_cast<const double*>(at(kHazards));
+    c.in_offsets = reinterpret_cast<const int32_t*>(at(kInOffsets));
+    c.in_edges = reinterpret_cast<const int32_t*>(at(kInEdges));
+
+    // Cheap consistency checks on the two ends of each offset array
+    const uint64_t nodes = header.node_count;
+    if (c.offsets[0] != 0 || static_cast<uint64_t>(c.offsets[nodes]) != header.edge_count ||
+        c.in_offsets[0] != 0 || static_cast<uint64_t>(c.in_offsets[nodes]) != header.edge_count ||
+        c.name_offsets[nodes] != header.name_bytes) {
+        throw std::runtime_error("Corrupt offsets in graph file: " + path);
+    }
+
+    return CSRGraph(static_cast<int>(nodes), static_cast<int>(header.edge_count), c,
+                    header.heuristic_scale, file);
+}
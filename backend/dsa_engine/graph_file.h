@@ -0,0 +1,82 @@
+#ifndef GRAPH_FILE_H
+#define GRAPH_FILE_H
+
+#include "csr_graph.h"
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * MappedFile Class
+ * Read-only memory mapping of a whole file, or of one byte range of it (mmap on
+ * POSIX, MapViewOfFile on Windows). Pages are loaded lazily by the OS on first
+ * access, so opening is O(1).
+ */
+class MappedFile {
+private:
+    const char* base = nullptr;   // First requested byte
+    size_t length = 0;            // Requested bytes
+    const char* view = nullptr;   // Start of the mapping (the range start rounded down to the OS granularity)
+    size_t view_length = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+
+public:
+    // Maps 'path'; throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const std::string& path);
+
+    // Maps only bytes [offset, offset + bytes) of 'path'; throws like the whole-file form,
+    // and if the range does not lie inside the file
+    MappedFile(const std::string& path, uint64_t offset, size_t bytes);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+/**
+ * GraphFileHeader
+ * Fixed-size header at offset 0 of an AMAAN binary graph file (".amgr").
+ *
+ * Layout: the header, then one section per CSRGraph column. Every section starts
+ * on an 8-byte boundary and is located by its byte offset from the file start:
+ *   node_ids, sorted_ids, sorted_index (int32 x V), latitudes, longitudes (f64 x V),
+ *   name_offsets (u32 x V+1), name_chars (bytes), offsets (int32 x V+1),
+ *   sources, targets (int32 x E), weights, lengths, hazards (f64 x E),
+ *   in_offsets (int32 x V+1), in_edges (int32 x E).
+ * All values are little-endian; 'byte_order' guards against foreign files.
+ */
+struct GraphFileHeader {
+    char magic[8];              // "AMAANGR\0"
+    uint32_t version;           // Format version (see GraphFile::kVersion)
+    uint32_t byte_order;        // 0x01020304 written natively
+    uint64_t node_count;
+    uint64_t edge_count;
+    uint64_t name_bytes;        // Size of the string table
+    double heuristic_scale;     // CSRGraph::heuristic_scale() of the stored graph
+    uint64_t section[15];       // Byte offset of each column, in the order listed above
+};
+
+/**
+ * GraphFile Class
+ * Writes a CSRGraph to the binary format and opens it again by memory mapping,
+ * so the engine starts in O(1) regardless of city size.
+ */
+class GraphFile {
+public:
+    static const uint32_t kVersion = 1;
+
+    // Serializes 'graph' to 'path'; throws std::runtime_error on I/O failure
+    static void write(const CSRGraph& graph, const std::string& path);
+
+    // Maps 'path' and returns a CSRGraph viewing the file's columns directly.
+    // Validates the header and section bounds; throws std::runtime_error on a bad file.
+    static CSRGraph load(const std::string& path);
+};
+
+#endif // GRAPH_FILE_H
@@ -0,0 +1,392 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <stdexcept>
+#include <cctype>
+#include <cstdlib>
+#include "graph.h"
+#include "csr_graph.h"
+#include "graph_file.h"
+#include "graph_tiles.h"
+#include "node_order.h"
+#include "geo.h"
+
+using namespace std;
+
+/**
+ * amaan_graph_import
+ * Converts a city road network export into the engine's binary graph format.
+ *
+ * Usage:
+ *   amaan_graph_import --nodes nodes.csv --edges edges.csv -o city.amgr
+ *   amaan_graph_import --geojson roads.geojson -o city.amgr
+ *   amaan_graph_import ... --tiles 0.05 -o country.amtl
+ *
+ * CSV input (a header line is allowed; fields may be double-quoted):
+ *   nodes.csv: id,lat,lon[,name]
+ *   edges.csv: u,v[,length_km[,hazard[,safety[,oneway]]]]
+ *              An empty length is filled with the straight-line distance.
+ *              oneway = 1/yes/true keeps only u -> v.
+ * GeoJSON input: a FeatureCollection of LineString / MultiLineString roads
+ *   ([lon, lat] coordinates). Every distinct vertex becomes an intersection and
+ *   consecutive vertices become road segments. Optional feature properties:
+ *   "oneway" (yes/true/1, or -1 for reversed), "hazard", "safety".
+ * Nodes are stored in Hilbert-curve order (node_order.h), so the engine can map
+ * the file and search it without reordering at load time.
+ * --tiles DEG writes a tile file instead (graph_tiles.h): the network cut into
+ * DEG-degree tiles that the engine maps on demand, for maps too large to keep
+ * resident.
+ */
+
+/**
+ * JsonValue
+ * Minimal JSON document model, just enough to walk a GeoJSON export.
+ */
+struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object } type = Null;
+    bool boolean = false;
+    double number = 0;
+    string text;
+    vector<JsonValue> items;                     // Array elements
+    vector<pair<string, JsonValue>> members;     // Object members, in file order
+
+    // Object member lookup; nullptr if absent or not an object
+    const JsonValue* get(const string& key) const {
+        if (type != Object) return nullptr;
+        for (const auto& member : members) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * JsonParser
+ * Recursive-descent parser over an in-memory document.
+ * Throws std::runtime_error with the byte offset on malformed input.
+ */
+class JsonParser {
+private:
+    const string& src;
+    size_t pos = 0;
+
+    [[noreturn]] void fail(const string& what) {
+        throw runtime_error("GeoJSON parse error at byte " + to_string(pos) + ": " + what);
+    }
+
+    void skip_space() {
+        while (pos < src.size() && isspace(static_cast<unsigned char>(src[pos]))) pos++;
+    }
+
+    void expect(char c) {
+        skip_space();
+        if (pos >= src.size() || src[pos] != c) fail(string("expected '") + c + "'");
+        pos++;
+    }
+
+    string parse_string() {
+        expect('"');
+        string out;
+        while (pos < src.size() && src[pos] != '"') {
+            char c = src[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= src.size()) fail("unterminated escape");
+            char e = src[pos++];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    // Basic Multilingual Plane code point -> UTF-8
+                    if (pos + 4 > src.size()) fail("short \\u escape");
+                    unsigned code = stoul(src.substr(pos, 4), nullptr, 16);
+                    pos += 4;
+                    if (code < 0x80) {
+                        out += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        out += static_cast<char>(0xC0 | (code >> 6));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        out += static_cast<char>(0xE0 | (code >> 12));
+                        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: out += e; break; // \" \\ \/
+            }
+        }
+        if (pos >= src.size()) fail("unterminated string");
+        pos++;
+        return out;
+    }
+
+public:
+    explicit JsonParser(const string& text) : src(text) {}
+
+    JsonValue parse_value() {
+        skip_space();
+        if (pos >= src.size()) fail("unexpected end of input");
+
+        JsonValue value;
+        char c = src[pos];
+        if (c == '{') {
+            value.type = JsonValue::Object;
+            pos++;
+            skip_space();
+            if (pos < src.size() && src[pos] == '}') { pos++; return value; }
+            while (true) {
+                string key = parse_string();
+                expect(':');
+                value.members.emplace_back(key, parse_value());
+                skip_space();
+                if (pos < src.size() && src[pos] == ',') { pos++; continue; }
+                expect('}');
+                return value;
+            }
+        }
+        if (c == '[') {
+            value.type = JsonValue::Array;
+            pos++;
+            skip_space();
+            if (pos < src.size() && src[pos] == ']') { pos++; return value; }
+            while (true) {
+                value.items.push_back(parse_value());
+                skip_space();
+                if (pos < src.size() && src[pos] == ',') { pos++; continue; }
+                expect(']');
+                return value;
+            }
+        }
+        if (c == '"') {
+            value.type = JsonValue::String;
+            value.text = parse_string();
+            return value;
+        }
+        if (src.compare(pos, 4, "true") == 0) { pos += 4; value.type = JsonValue::Bool; value.boolean = true; return value; }
+        if (src.compare(pos, 5, "false") == 0) { pos += 5; value.type = JsonValue::Bool; return value; }
+        if (src.compare(pos, 4, "null") == 0) { pos += 4; return value; }
+
+        // Number
+        size_t used = 0;
+        try {
+            value.number = stod(src.substr(pos, 32), &used);
+        } catch (const exception&) {
+            fail("unexpected character");
+        }
+        pos += used;
+        value.type = JsonValue::Number;
+        return value;
+    }
+};
+
+/**
+ * split_csv_line
+ * Splits one CSV record, honoring double-quoted fields ("" is a literal quote).
+ */
+vector<string> split_csv_line(const string& line) {
+    vector<string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') { fields.back() += '"'; i++; }
+            else if (c == '"') quoted = false;
+            else fields.back() += c;
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else if (c != '\r') {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+// True for values that mean "yes" in road exports (1, yes, true)
+bool is_truthy(const string& value) {
+    return value == "1" || value == "yes" || value == "true" || value == "True" || value == "YES";
+}
+
+/**
+ * for_each_csv_record
+ * Calls 'handle(fields, line_number)' for every data line. A first line whose
+ * first field is not numeric is treated as a header and skipped.
+ */
+template <typename Handler>
+void for_each_csv_record(const string& path, Handler handle) {
+    ifstream in(path);
+    if (!in) throw runtime_error("Cannot open " + path);
+    string line;
+    int line_number = 0;
+    while (getline(in, line)) {
+        line_number++;
+        if (line.empty() || line == "\r") continue;
+        vector<string> fields = split_csv_line(line);
+        if (line_number == 1) {
+            try { stod(fields[0]); } catch (const exception&) { continue; } // Header row
+        }
+        try {
+            handle(fields, line_number);
+        } catch (const exception& e) {
+            throw runtime_error(path + ":" + to_string(line_number) + ": " + e.what());
+        }
+    }
+}
+
+/**
+ * load_csv
+ * Builds the graph from a node list and an edge list.
+ */
+void load_csv(Graph& graph, const string& nodes_path, const string& edges_path) {
+    for_each_csv_record(nodes_path, [&](const vector<string>& f, int) {
+        if (f.size() < 3) throw runtime_error("expected id,lat,lon[,name]");
+        graph.add_node(stoi(f[0]), stod(f[1]), stod(f[2]), f.size() > 3 ? f[3] : "");
+    });
+
+    for_each_csv_record(edges_path, [&](const vector<string>& f, int) {
+        if (f.size() < 2) throw runtime_error("expected u,v[,length_km[,hazard[,safety[,oneway]]]]");
+        int u = stoi(f[0]), v = stoi(f[1]);
+        if (!graph.has_node(u) || !graph.has_node(v)) throw runtime_error("edge references an unknown node");
+
+        double length;
+        if (f.size() > 2 && !f[2].empty()) {
+            length = stod(f[2]);
+        } else {
+            const Node& a = graph.get_node(u);
+            const Node& b = graph.get_node(v);
+            length = geo::haversine_km(a.latitude, a.longitude, b.latitude, b.longitude);
+        }
+        double hazard = f.size() > 3 && !f[3].empty() ? stod(f[3]) : 0.0;
+        double safety = f.size() > 4 && !f[4].empty() ? stod(f[4]) : 0.0;
+
+        if (f.size() > 5 && is_truthy(f[5])) graph.add_one_way_edge(u, v, length, hazard, safety);
+        else graph.add_edge(u, v, length, hazard, safety);
+    });
+}
+
+/**
+ * load_geojson
+ * Builds the graph from LineString / MultiLineString features. Vertices are
+ * deduplicated on a 1e-7 degree grid (about 1 cm) so shared road ends connect.
+ */
+void load_geojson(Graph& graph, const string& path) {
+    ifstream in(path, ios::binary);
+    if (!in) throw runtime_error("Cannot open " + path);
+    stringstream buffer;
+    buffer << in.rdbuf();
+    const string text = buffer.str();
+    JsonValue root = JsonParser(text).parse_value();
+
+    const JsonValue* features = root.get("features");
+    if (!features || features->type != JsonValue::Array) throw runtime_error(path + ": expected a FeatureCollection");
+
+    map<pair<long long, long long>, int> vertex_ids;
+    auto vertex = [&](const JsonValue& position) {
+        if (position.type != JsonValue::Array || position.items.size() < 2) throw runtime_error(path + ": bad coordinate");
+        double lon = position.items[0].number, lat = position.items[1].number;
+        pair<long long, long long> key(llround(lat * 1e7), llround(lon * 1e7));
+        auto it = vertex_ids.find(key);
+        if (it != vertex_ids.end()) return it->second;
+        int id = static_cast<int>(vertex_ids.size()) + 1;
+        vertex_ids[key] = id;
+        graph.add_node(id, lat, lon);
+        return id;
+    };
+
+    auto number_property = [](const JsonValue* props, const string& key) {
+        const JsonValue* v = props ? props->get(key) : nullptr;
+        if (!v) return 0.0;
+        if (v->type == JsonValue::Number) return v->number;
+        if (v->type == JsonValue::String && !v->text.empty()) return stod(v->text);
+        return 0.0;
+    };
+
+    for (const JsonValue& feature : features->items) {
+        const JsonValue* geometry = feature.get("geometry");
+        const JsonValue* props = feature.get("properties");
+        if (!geometry) continue;
+        const JsonValue* type = geometry->get("type");
+        const JsonValue* coords = geometry->get("coordinates");
+        if (!type || !coords) continue;
+
+        // Normalize LineString and MultiLineString into a list of polylines
+        vector<const JsonValue*> lines;
+        if (type->text == "LineString") lines.push_back(coords);
+        else if (type->text == "MultiLineString") for (const auto& line : coords->items) lines.push_back(&line);
+        else continue; // Points / polygons are not roads
+
+        // Direction: 0 = both ways, 1 = along the geometry, -1 = against it
+        int direction = 0;
+        if (const JsonValue* oneway = props ? props->get("oneway") : nullptr) {
+            if (oneway->type == JsonValue::Bool) direction = oneway->boolean ? 1 : 0;
+            else if (oneway->type == JsonValue::Number) direction = static_cast<int>(oneway->number);
+            else if (oneway->text == "-1") direction = -1;
+            else direction = is_truthy(oneway->text) ? 1 : 0;
+        }
+        double hazard = number_property(props, "hazard");
+        double safety = number_property(props, "safety");
+
+        for (const JsonValue* line : lines) {
+            for (size_t i = 1; i < line->items.size(); ++i) {
+                int u = vertex(line->items[i - 1]);
+                int v = vertex(line->items[i]);
+                if (u == v) continue;
+                const Node& a = graph.get_node(u);
+                const Node& b = graph.get_node(v);
+                double length = geo::haversine_km(a.latitude, a.longitude, b.latitude, b.longitude);
+                if (direction == 1) graph.add_one_way_edge(u, v, length, hazard, safety);
+                else if (direction == -1) graph.add_one_way_edge(v, u, length, hazard, safety);
+                else graph.add_edge(u, v, length, hazard, safety);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    string nodes_path, edges_path, geojson_path, output_path;
+    double tile_size = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--nodes") nodes_path = argv[i + 1];
+        else if (flag == "--edges") edges_path = argv[i + 1];
+        else if (flag == "--geojson") geojson_path = argv[i + 1];
+        else if (flag == "-o" || flag == "--output") output_path = argv[i + 1];
+        else if (flag == "--tiles") tile_size = atof(argv[i + 1]);
+        else { cerr << "Unknown option: " << flag << endl; return 2; }
+    }
+
+    bool csv = !nodes_path.empty() && !edges_path.empty();
+    if (output_path.empty() || csv == !geojson_path.empty() || tile_size < 0) {
+        cerr << "Usage: amaan_graph_import (--nodes nodes.csv --edges edges.csv | --geojson roads.geojson) [--tiles DEG] -o city.amgr" << endl;
+        return 2;
+    }
+
+    try {
+        Graph graph;
+        if (csv) load_csv(graph, nodes_path, edges_path);
+        else load_geojson(graph, geojson_path);
+
+        CSRGraph compiled = node_order::hilbert_reordered(CSRGraph(graph));
+        if (tile_size > 0) TiledGraph::write(compiled, output_path, tile_size);
+        else GraphFile::write(compiled, output_path);
+        cout << "Wrote " << compiled.node_count() << " nodes and " << compiled.edge_count()
+             << " directed edges to " << output_path;
+        if (tile_size > 0) cout << " (" << TiledGraph(output_path, 0).tile_count() << " tiles)";
+        cout << endl;
+    } catch (const exception& e) {
+        cerr << "amaan_graph_import: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,348 @@
+#include "graph_tiles.h"
+#include "dijkstra.h"
+#include "node_order.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+namespace {
+
+const char kMagic[8] = {'A', 'M', 'A', 'A', 'N', 'T', 'L', '\0'};
+const uint32_t kByteOrderMark = 0x01020304;
+const uint64_t kTileAlignment = 4096;
+
+uint64_t align_to(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * BlobLayout
+ * Byte offset of every section inside a tile blob, relative to the blob start,
+ * for a tile of n nodes, m edges and b boundary nodes.
+ */
+struct BlobLayout {
+    uint64_t latitudes, longitudes, weights, lengths, hazards;
+    uint64_t node_ids, offsets, targets, boundary;
+    uint64_t bytes;
+
+    BlobLayout(uint64_t n, uint64_t m, uint64_t b) {
+        uint64_t cursor = 0;
+        auto next = [&](uint64_t size) {
+            uint64_t at = cursor;
+            cursor = align_to(cursor + size, 8);
+            return at;
+        };
+        latitudes = next(n * sizeof(double));
+        longitudes = next(n * sizeof(double));
+        weights = next(m * sizeof(double));
+        lengths = next(m * sizeof(double));
+        hazards = next(m * sizeof(double));
+        node_ids = next(n * sizeof(int32_t));
+        offsets = next((n + 1) * sizeof(int32_t));
+        targets = next(m * sizeof(int32_t));
+        boundary = next(b * sizeof(int32_t));
+        bytes = cursor;
+    }
+};
+
+/**
+ * TileColumns
+ * A tile being assembled by TiledGraph::write, in blob order.
+ */
+struct TileColumns {
+    std::vector<double> latitudes, longitudes, weights, lengths, hazards;
+    std::vector<int32_t> node_ids, offsets, targets, boundary;
+};
+
+template <typename T>
+void write_section(std::ofstream& out, uint64_t& written, uint64_t at, const std::vector<T>& column) {
+    // Gaps before a tile blob run up to kTileAlignment - 1 bytes: zero-fill them in chunks
+    static const char padding[kTileAlignment] = {0};
+    for (uint64_t gap = at - written; gap > 0;) {
+        const uint64_t chunk = std::min<uint64_t>(gap, sizeof(padding));
+        out.write(padding, static_cast<std::streamsize>(chunk));
+        gap -= chunk;
+    }
+    if (!column.empty()) out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+    written = at + column.size() * sizeof(T);
+}
+
+} // namespace
+
+/**
+ * GraphTile::GraphTile
+ * Maps one blob and points the columns into it. Checks the blob size and both
+ * ends of the offset array; the edge data is trusted as written.
+ */
+GraphTile::GraphTile(const std::string& path, const TileEntry& entry)
+    : first(static_cast<int>(entry.first_node)), nodes(static_cast<int>(entry.node_count)),
+      edges(static_cast<int>(entry.edge_count)), boundaries(static_cast<int>(entry.boundary_count)) {
+    const BlobLayout layout(entry.node_count, entry.edge_count, entry.boundary_count);
+    if (layout.bytes != entry.bytes) throw std::runtime_error("Corrupt tile directory in tile file: " + path);
+    file = std::make_unique<MappedFile>(path, entry.offset, static_cast<size_t>(entry.bytes));
+
+    const char* base = file->data();
+    latitudes = reinterpret_cast<const double*>(base + layout.latitudes);
+    longitudes = reinterpret_cast<const double*>(base + layout.longitudes);
+    weights = reinterpret_cast<const double*>(base + layout.weights);
+    lengths = reinterpret_cast<const double*>(base + layout.lengths);
+    hazards = reinterpret_cast<const double*>(base + layout.hazards);
+    node_ids = reinterpret_cast<const int32_t*>(base + layout.node_ids);
+    offsets = reinterpret_cast<const int32_t*>(base + layout.offsets);
+    targets = reinterpret_cast<const int32_t*>(base + layout.targets);
+    boundary = reinterpret_cast<const int32_t*>(base + layout.boundary);
+    if (offsets[0] != 0 || offsets[nodes] != edges) throw std::runtime_error("Corrupt offsets in tile file: " + path);
+}
+
+/**
+ * TiledGraph::write
+ * 1. Assigns every node to the tile its coordinates fall in.
+ * 2. Orders the tiles along a Hilbert curve over the tile grid and numbers the
+ *    nodes tile by tile (keeping the graph's order inside a tile), so each
+ *    tile owns one consecutive range of global indices.
+ * 3. Writes the ID table and directory, then every tile's columns, with edge
+ *    targets translated to the new global indices.
+ */
+void TiledGraph::write(const CSRGraph& graph, const std::string& path, double tile_size) {
+    if (!(tile_size > 0)) throw std::runtime_error("Tile size must be positive");
+    const int n = graph.node_count();
+
+    TileFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    header.node_count = static_cast<uint64_t>(n);
+    header.edge_count = static_cast<uint64_t>(graph.edge_count());
+    header.tile_size = tile_size;
+    header.heuristic_scale = graph.heuristic_scale();
+
+    // 1. Grid position of every node
+    double min_lat = 0, min_lon = 0;
+    for (int v = 0; v < n; ++v) {
+        if (v == 0 || graph.latitude(v) < min_lat) min_lat = graph.latitude(v);
+        if (v == 0 || graph.longitude(v) < min_lon) min_lon = graph.longitude(v);
+    }
+    header.origin_latitude = std::floor(min_lat / tile_size) * tile_size;
+    header.origin_longitude = std::floor(min_lon / tile_size) * tile_size;
+
+    std::map<std::pair<int, int>, int> tile_ids; // (row, column) -> tile
+    std::vector<int> tile_of(n);
+    for (int v = 0; v < n; ++v) {
+        const int row = static_cast<int>(std::floor((graph.latitude(v) - header.origin_latitude) / tile_size));
+        const int column = static_cast<int>(std::floor((graph.longitude(v) - header.origin_longitude) / tile_size));
+        tile_of[v] = tile_ids.emplace(std::make_pair(row, column), static_cast<int>(tile_ids.size())).first->second;
+    }
+
+    // 2. Tiles along the curve, then nodes tile by tile
+    std::vector<TileEntry> directory(tile_ids.size());
+    std::vector<uint64_t> curve(tile_ids.size());
+    for (const auto& [cell, t] : tile_ids) {
+        std::memset(&directory[t], 0, sizeof(TileEntry));
+        directory[t].row = cell.first;
+        directory[t].column = cell.second;
+        curve[t] = node_order::hilbert_index(static_cast<uint32_t>(cell.second), static_cast<uint32_t>(cell.first));
+    }
+    std::vector<int> rank(directory.size());
+    for (size_t t = 0; t < rank.size(); ++t) rank[t] = static_cast<int>(t);
+    std::sort(rank.begin(), rank.end(), [&](int a, int b) { return curve[a] < curve[b]; });
+    std::vector<int> position(directory.size());
+    for (size_t i = 0; i < rank.size(); ++i) position[rank[i]] = static_cast<int>(i);
+    std::vector<TileEntry> ordered(directory.size());
+    for (size_t t = 0; t < directory.size(); ++t) ordered[position[t]] = directory[t];
+    directory.swap(ordered);
+    for (int v = 0; v < n; ++v) tile_of[v] = position[tile_of[v]];
+
+    std::vector<int> order(n);
+    for (int v = 0; v < n; ++v) order[v] = v;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return tile_of[a] < tile_of[b]; });
+    std::vector<int> global(n);
+    for (int i = 0; i < n; ++i) global[order[i]] = i;
+    for (int i = n - 1; i >= 0; --i) directory[tile_of[order[i]]].first_node = static_cast<uint32_t>(i);
+
+    // 3a. Tile columns and sizes
+    std::vector<TileColumns> tiles(directory.size());
+    for (int i = 0; i < n; ++i) {
+        const int v = order[i];
+        TileColumns& tile = tiles[tile_of[v]];
+        if (tile.offsets.empty()) tile.offsets.push_back(0);
+        const int local = static_cast<int>(tile.node_ids.size());
+        tile.node_ids.push_back(graph.node_id(v));
+        tile.latitudes.push_back(graph.latitude(v));
+        tile.longitudes.push_back(graph.longitude(v));
+        bool crosses = false;
+        for (int e = graph.edge_begin(v); e < graph.edge_end(v); ++e) {
+            tile.targets.push_back(global[graph.edge_target(e)]);
+            tile.weights.push_back(graph.edge_weight(e));
+            tile.lengths.push_back(graph.edge_length(e));
+            tile.hazards.push_back(graph.edge_hazard(e));
+            crosses |= tile_of[graph.edge_target(e)] != tile_of[v];
+        }
+        for (int k = graph.in_edge_begin(v); k < graph.in_edge_end(v); ++k) {
+            crosses |= tile_of[graph.edge_source(graph.in_edge(k))] != tile_of[v];
+        }
+        tile.offsets.push_back(static_cast<int32_t>(tile.targets.size()));
+        if (crosses) tile.boundary.push_back(local);
+    }
+
+    header.tile_count = directory.size();
+    header.sorted_ids = align_to(sizeof(TileFileHeader), 8);
+    header.sorted_index = align_to(header.sorted_ids + n * sizeof(int32_t), 8);
+    header.directory = align_to(header.sorted_index + n * sizeof(int32_t), 8);
+    uint64_t cursor = align_to(header.directory + directory.size() * sizeof(TileEntry), kTileAlignment);
+    for (size_t t = 0; t < directory.size(); ++t) {
+        TileEntry& entry = directory[t];
+        entry.node_count = static_cast<uint32_t>(tiles[t].node_ids.size());
+        entry.edge_count = static_cast<uint32_t>(tiles[t].targets.size());
+        entry.boundary_count = static_cast<uint32_t>(tiles[t].boundary.size());
+        entry.offset = cursor;
+        entry.bytes = BlobLayout(entry.node_count, entry.edge_count, entry.boundary_count).bytes;
+        cursor = align_to(cursor + entry.bytes, kTileAlignment);
+    }
+
+    // ID table, in the new numbering
+    std::vector<int32_t> sorted_ids(n), sorted_index(n);
+    const CSRGraph::Columns& c = graph.columns();
+    for (int i = 0; i < n; ++i) {
+        sorted_ids[i] = c.sorted_ids[i];
+        sorted_index[i] = global[c.sorted_index[i]];
+    }
+
+    // 3b. Everything in file order
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot create tile file: " + path);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t written = sizeof(header);
+    write_section(out, written, header.sorted_ids, sorted_ids);
+    write_section(out, written, header.sorted_index, sorted_index);
+    write_section(out, written, header.directory, directory);
+    for (size_t t = 0; t < directory.size(); ++t) {
+        const uint64_t base = directory[t].offset;
+        const BlobLayout layout(directory[t].node_count, directory[t].edge_count, directory[t].boundary_count);
+        const TileColumns& tile = tiles[t];
+        write_section(out, written, base + layout.latitudes, tile.latitudes);
+        write_section(out, written, base + layout.longitudes, tile.longitudes);
+        write_section(out, written, base + layout.weights, tile.weights);
+        write_section(out, written, base + layout.lengths, tile.lengths);
+        write_section(out, written, base + layout.hazards, tile.hazards);
+        write_section(out, written, base + layout.node_ids, tile.node_ids);
+        write_section(out, written, base + layout.offsets, tile.offsets);
+        write_section(out, written, base + layout.targets, tile.targets);
+        write_section(out, written, base + layout.boundary, tile.boundary);
+    }
+    write_section(out, written, cursor, std::vector<char>());
+    if (!out) throw std::runtime_error("Failed while writing tile file: " + path);
+}
+
+bool TiledGraph::is_tile_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(kMagic)] = {0};
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+/**
+ * TiledGraph::TiledGraph
+ * Reads the header, checks it like GraphFile::load checks its own, then maps
+ * just the ID table and directory. No tile is touched until a search asks.
+ */
+TiledGraph::TiledGraph(const std::string& path, size_t max_resident) : path(path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("Cannot open tile file: " + path);
+    const uint64_t file_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+    if (file_size < sizeof(TileFileHeader) || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Tile file too small: " + path);
+    }
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) throw std::runtime_error("Not an AMAAN tile file: " + path);
+    if (header.byte_order != kByteOrderMark) throw std::runtime_error("Tile file has foreign byte order: " + path);
+    if (header.version != kVersion) throw std::runtime_error("Unsupported tile file version " + std::to_string(header.version) + ": " + path);
+    if (header.node_count > 0x7fffffff || header.edge_count > 0x7fffffff) throw std::runtime_error("Tile file too large for 32-bit indices: " + path);
+
+    const uint64_t index_end = header.directory + header.tile_count * sizeof(TileEntry);
+    if (header.sorted_ids % 8 != 0 || header.sorted_index % 8 != 0 || header.directory % 8 != 0 ||
+        header.sorted_ids + header.node_count * sizeof(int32_t) > header.sorted_index ||
+        header.sorted_index + header.node_count * sizeof(int32_t) > header.directory ||
+        header.tile_count > header.node_count || index_end > file_size) {
+        throw std::runtime_error("Corrupt section table in tile file: " + path);
+    }
+    index = std::make_unique<MappedFile>(path, 0, static_cast<size_t>(index_end));
+    sorted_ids = reinterpret_cast<const int32_t*>(index->data() + header.sorted_ids);
+    sorted_index = reinterpret_cast<const int32_t*>(index->data() + header.sorted_index);
+
+    const TileEntry* entries = reinterpret_cast<const TileEntry*>(index->data() + header.directory);
+    directory.assign(entries, entries + header.tile_count);
+    uint64_t next_node = 0;
+    for (const TileEntry& entry : directory) {
+        if (entry.first_node != next_node || entry.offset % kTileAlignment != 0 ||
+            entry.offset > file_size || entry.bytes > file_size - entry.offset) {
+            throw std::runtime_error("Corrupt tile directory in tile file: " + path);
+        }
+        first_nodes.push_back(entry.first_node);
+        next_node += entry.node_count;
+    }
+    if (next_node != header.node_count) throw std::runtime_error("Corrupt tile directory in tile file: " + path);
+    first_nodes.push_back(static_cast<uint32_t>(next_node));
+    counters.max_resident = max_resident;
+}
+
+int TiledGraph::index_of(int node_id) const {
+    const int32_t* last = sorted_ids + header.node_count;
+    const int32_t* it = std::lower_bound(sorted_ids, last, node_id);
+    return (it != last && *it == node_id) ? sorted_index[it - sorted_ids] : -1;
+}
+
+int TiledGraph::tile_of(int node) const {
+    auto it = std::upper_bound(first_nodes.begin(), first_nodes.end(), static_cast<uint32_t>(node));
+    return static_cast<int>(it - first_nodes.begin()) - 1;
+}
+
+/**
+ * TiledGraph::tile
+ * Cache hit: moves the tile to the front of the LRU list. Miss: maps the blob
+ * (O(1); pages fault in as the search reads them), inserts it at the front and
+ * evicts from the back while over the cap.
+ */
+std::shared_ptr<const GraphTile> TiledGraph::tile(int tile, SearchStats* stats) const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    counters.requests++;
+    auto it = resident.find(tile);
+    if (it != resident.end()) {
+        recency.splice(recency.begin(), recency, it->second.position);
+        return it->second.tile;
+    }
+
+    auto loaded = std::make_shared<const GraphTile>(path, directory[tile]);
+    recency.push_front(tile);
+    resident[tile] = {loaded, recency.begin()};
+    counters.loads++;
+    counters.resident_bytes += loaded->mapped_bytes();
+    if (stats) stats->tiles_loaded++;
+    evict_over_cap();
+    return loaded;
+}
+
+void TiledGraph::evict_over_cap() const {
+    while (counters.max_resident > 0 && resident.size() > counters.max_resident) {
+        auto victim = resident.find(recency.back());
+        counters.resident_bytes -= victim->second.tile->mapped_bytes();
+        resident.erase(victim);
+        recency.pop_back();
+        counters.evictions++;
+    }
+}
+
+TiledGraph::CacheCounters TiledGraph::cache_counters() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    CacheCounters snapshot = counters;
+    snapshot.resident = resident.size();
+    return snapshot;
+}
+
+void TiledGraph::set_max_resident(size_t max_resident) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    counters.max_resident = max_resident;
+    evict_over_cap();
+}
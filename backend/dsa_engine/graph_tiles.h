@@ -0,0 +1,199 @@
+#ifndef GRAPH_TILES_H
+#define GRAPH_TILES_H
+
+#include "csr_graph.h"
+#include "graph_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct SearchStats;
+
+/**
+ * TileFileHeader
+ * Fixed-size header at offset 0 of an AMAAN tile file (".amtl"), the sharded
+ * form of a road network for maps too large to keep resident.
+ *
+ * The map is cut into square tiles of 'tile_size' degrees. Each tile stores
+ * its nodes as one consecutive range of global indices, so an edge target is
+ * a plain global index whichever tile it lies in.
+ *
+ * Layout: the header, the ID table (sorted_ids, sorted_index: int32 x V, as in
+ * CSRGraph), the tile directory (TileEntry x tile_count), then one blob per
+ * tile starting on a 4 KiB boundary so each can be mapped on its own:
+ *   latitudes, longitudes (f64 x n), weights, lengths, hazards (f64 x m),
+ *   node_ids (int32 x n), offsets (int32 x n+1, tile-local edge indices),
+ *   targets (int32 x m, global indices), boundary (int32 x b, tile-local).
+ * Every blob section starts on an 8-byte boundary. Node names are not stored.
+ */
+struct TileFileHeader {
+    char magic[8];              // "AMAANTL\0"
+    uint32_t version;           // Format version (see TiledGraph::kVersion)
+    uint32_t byte_order;        // 0x01020304 written natively
+    uint64_t node_count;
+    uint64_t edge_count;
+    uint64_t tile_count;
+    double tile_size;           // Tile edge in degrees
+    double origin_latitude;     // South-west corner of tile row 0, column 0
+    double origin_longitude;
+    double heuristic_scale;     // CSRGraph::heuristic_scale() of the whole network
+    uint64_t sorted_ids;        // Byte offsets of the ID table and the directory
+    uint64_t sorted_index;
+    uint64_t directory;
+};
+
+/**
+ * TileEntry
+ * Directory record of one tile. Tiles are stored along a Hilbert curve over
+ * their grid position, so neighboring tiles tend to sit close in the file.
+ */
+struct TileEntry {
+    int32_t row;                // Grid position: latitude band ...
+    int32_t column;             // ... and longitude band
+    uint32_t first_node;        // Global index of the tile's first node
+    uint32_t node_count;
+    uint32_t edge_count;        // Edges leaving the tile's nodes
+    uint32_t boundary_count;    // Nodes with an edge to or from another tile
+    uint64_t offset;            // Byte offset of the blob (4 KiB aligned)
+    uint64_t bytes;
+};
+
+/**
+ * GraphTile Class
+ * One tile mapped into memory. Node accessors take tile-local indices
+ * (global index - first_node()); edge accessors take tile-local edge indices
+ * from edge_begin() / edge_end(), and edge_target() returns a global index.
+ */
+class GraphTile {
+private:
+    std::unique_ptr<MappedFile> file;
+    int first = 0;
+    int nodes = 0;
+    int edges = 0;
+    int boundaries = 0;
+    const double* latitudes = nullptr;
+    const double* longitudes = nullptr;
+    const double* weights = nullptr;
+    const double* lengths = nullptr;
+    const double* hazards = nullptr;
+    const int32_t* node_ids = nullptr;
+    const int32_t* offsets = nullptr;
+    const int32_t* targets = nullptr;
+    const int32_t* boundary = nullptr;
+
+public:
+    // Maps the blob described by 'entry'; throws std::runtime_error on a bad tile
+    GraphTile(const std::string& path, const TileEntry& entry);
+
+    int first_node() const { return first; }
+    int node_count() const { return nodes; }
+    int edge_count() const { return edges; }
+    size_t mapped_bytes() const { return file->size(); }
+
+    int node_id(int local) const { return node_ids[local]; }
+    double latitude(int local) const { return latitudes[local]; }
+    double longitude(int local) const { return longitudes[local]; }
+
+    int edge_begin(int local) const { return offsets[local]; }
+    int edge_end(int local) const { return offsets[local + 1]; }
+    int edge_target(int e) const { return targets[e]; }
+    double edge_weight(int e) const { return weights[e]; }
+    double edge_length(int e) const { return lengths[e]; }
+    double edge_hazard(int e) const { return hazards[e]; }
+
+    // Tile-local indices of the nodes where routes cross into or out of the tile
+    int boundary_count() const { return boundaries; }
+    int boundary_node(int i) const { return boundary[i]; }
+};
+
+/**
+ * TiledGraph Class
+ * A road network opened from a tile file. Only the header, the ID table and the
+ * directory are mapped up front; a tile is mapped the first time a search asks
+ * for it and stays resident until the least recently used tiles are evicted to
+ * respect the resident cap. Tiles are handed out as shared pointers, so a tile
+ * evicted while a search still holds it is unmapped when that search finishes.
+ * Thread-safe: concurrent searches share the cache.
+ */
+class TiledGraph {
+public:
+    static const uint32_t kVersion = 1;
+    static constexpr double kDefaultTileSize = 0.05;        // About 5.5 km north-south
+    static constexpr size_t kDefaultResidentTiles = 64;
+
+    // Cuts 'graph' into tiles of 'tile_size' degrees and writes them to 'path';
+    // throws std::runtime_error on I/O failure
+    static void write(const CSRGraph& graph, const std::string& path, double tile_size = kDefaultTileSize);
+
+    // True if 'path' starts with the tile file magic
+    static bool is_tile_file(const std::string& path);
+
+    // Maps the index of 'path' and validates it; throws std::runtime_error on a bad file.
+    // 'max_resident' caps the tiles kept mapped between searches (0 = no cap).
+    explicit TiledGraph(const std::string& path, size_t max_resident = kDefaultResidentTiles);
+
+    TiledGraph(const TiledGraph&) = delete;
+    TiledGraph& operator=(const TiledGraph&) = delete;
+
+    int node_count() const { return static_cast<int>(header.node_count); }
+    int edge_count() const { return static_cast<int>(header.edge_count); }
+    int tile_count() const { return static_cast<int>(directory.size()); }
+    double tile_size() const { return header.tile_size; }
+    double heuristic_scale() const { return header.heuristic_scale; }
+    const TileEntry& tile_entry(int tile) const { return directory[tile]; }
+
+    // Global index of an external Node ID, or -1 if the ID is unknown (binary search)
+    int index_of(int node_id) const;
+
+    // Tile holding global index 'node' (binary search over the directory)
+    int tile_of(int node) const;
+
+    // The tile, mapping it if it is not resident. Counts the request in 'stats'
+    // (tiles_loaded when the tile had to be mapped).
+    std::shared_ptr<const GraphTile> tile(int tile, SearchStats* stats = nullptr) const;
+
+    /**
+     * CacheCounters
+     * Totals since the graph was opened, for "stats".
+     */
+    struct CacheCounters {
+        uint64_t requests = 0;      // tile() calls
+        uint64_t loads = 0;         // ... that had to map the tile
+        uint64_t evictions = 0;     // Tiles dropped to respect the cap
+        size_t resident = 0;        // Tiles currently mapped by the cache
+        size_t resident_bytes = 0;
+        size_t max_resident = 0;
+    };
+    CacheCounters cache_counters() const;
+
+    // Changes the cap, evicting at once if the cache is over it (0 = no cap)
+    void set_max_resident(size_t max_resident);
+
+private:
+    std::string path;
+    std::unique_ptr<MappedFile> index;   // Header, ID table and directory
+    TileFileHeader header;
+    const int32_t* sorted_ids = nullptr;
+    const int32_t* sorted_index = nullptr;
+    std::vector<TileEntry> directory;
+    std::vector<uint32_t> first_nodes;   // Tile t holds [first_nodes[t], first_nodes[t + 1])
+
+    // LRU cache: most recently used tile at the front of 'recency'
+    struct Resident {
+        std::shared_ptr<const GraphTile> tile;
+        std::list<int>::iterator position;
+    };
+    mutable std::mutex cache_mutex;
+    mutable std::list<int> recency;
+    mutable std::unordered_map<int, Resident> resident;
+    mutable CacheCounters counters;
+
+    void evict_over_cap() const;
+};
+
+#endif // GRAPH_TILES_H
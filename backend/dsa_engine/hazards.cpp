@@ -1,5 +1,7 @@
 #include "hazards.h"
 #include <cmath>
+#include <algorithm>
+#include <climits>
 
 /**
  * add_hazard
@@ -7,8 +9,350 @@
  * DSA Complexity: O(log N) for insertion into a Balanced Binary Search Tree (std::map).
  */
 void HazardManager::add_hazard(Hazard h) {
-    // Stores the hazard using its unique ID as the key
+    epoch++;
+
+    auto it = hazards.find(h.id);
+    if (it != hazards.end()) {
+        log_change(&it->second, &h);
+    } else {
+        log_change(nullptr, &h);
+    }
+
+    // Stores the hazard using its unique ID as the key; an update may move it to
+    // another cell, so the columns are regrouped
     hazards[h.id] = h;
+    rebuild_index();
+}
+
+/**
+ * log_change
+ * Records one change under the current epoch. The newest batch is extended in
+ * place only while no copy shares it; otherwise the change goes into a new batch
+ * (copying the shared one if it is for the same epoch). An epoch with more than
+ * kChangelogLimit changes is dropped as a whole, like trimming does.
+ */
+void HazardManager::log_change(const Hazard* before, const Hazard* after) {
+    if (epoch <= changelog_floor) return; // This epoch outgrew the log and was dropped
+    HazardChange change{epoch, before != nullptr, before ? *before : Hazard{}, after != nullptr, after ? *after : Hazard{}};
+    if (!changelog || changelog->epoch != epoch) {
+        changelog = std::make_shared<ChangeBatch>(ChangeBatch{epoch, {}, changelog});
+    } else if (changelog.use_count() > 1) {
+        changelog = std::make_shared<ChangeBatch>(*changelog);
+    }
+    changelog->changes.push_back(change);
+    changelog_entries++;
+    if (changelog->changes.size() > kChangelogLimit) {
+        // A single epoch larger than the whole log: nothing up to it can be replayed
+        changelog_floor = epoch;
+        changelog.reset();
+        changelog_entries = 0;
+    } else if (changelog_entries > 2 * kChangelogLimit) {
+        trim_changelog();
+    }
+}
+
+/**
+ * trim_changelog
+ * Keeps the newest whole epochs holding at most kChangelogLimit changes, so a
+ * caller is never handed half of an epoch. The kept batches are relinked as new
+ * batches (older copies of the manager still hold the old chain). Trimming only
+ * once the log has doubled keeps its cost at O(1) per change.
+ */
+void HazardManager::trim_changelog() {
+    std::vector<const ChangeBatch*> kept;
+    size_t total = 0;
+    for (const ChangeBatch* batch = changelog.get(); batch; batch = batch->previous.get()) {
+        if (total + batch->changes.size() > kChangelogLimit) {
+            changelog_floor = batch->epoch;
+            break;
+        }
+        total += batch->changes.size();
+        kept.push_back(batch);
+    }
+    std::shared_ptr<ChangeBatch> relinked;
+    for (auto it = kept.rbegin(); it != kept.rend(); ++it) {
+        auto batch = std::make_shared<ChangeBatch>(ChangeBatch{(*it)->epoch, (*it)->changes, relinked});
+        relinked = std::move(batch);
+    }
+    changelog = std::move(relinked);
+    changelog_entries = total;
+}
+
+/**
+ * changes_since
+ * Batches are linked newest first, so the walk stops at the first batch at or
+ * before 'since'; the batches found are then appended oldest first.
+ */
+bool HazardManager::changes_since(unsigned long long since, std::vector<HazardChange>& out) const {
+    if (since < changelog_floor) return false;
+    std::vector<const ChangeBatch*> newer;
+    for (const ChangeBatch* batch = changelog.get(); batch && batch->epoch > since; batch = batch->previous.get()) {
+        newer.push_back(batch);
+    }
+    for (auto it = newer.rbegin(); it != newer.rend(); ++it) {
+        out.insert(out.end(), (*it)->changes.begin(), (*it)->changes.end());
+    }
+    return true;
+}
+
+/**
+ * Grid helpers
+ * A hazard lives in the cell containing its center. Cell coordinates are packed
+ * into one 64-bit key: high 32 bits latitude cell, low 32 bits longitude cell.
+ */
+long long HazardManager::cell_of(double degrees) const {
+    return static_cast<long long>(std::floor(degrees / cell_size));
+}
+
+long long HazardManager::cell_key(long long lat_cell, long long lon_cell) {
+    return static_cast<long long>((static_cast<unsigned long long>(lat_cell) << 32) ^
+                                  (static_cast<unsigned long long>(lon_cell) & 0xffffffffULL));
+}
+
+/**
+ * rebuild_index
+ * Sorts the hazards by cell (stable, so a cell keeps ID order) and copies them
+ * into the columns of a new index; each cell then records its run of rows.
+ */
+void HazardManager::rebuild_index() {
+    std::vector<std::pair<long long, const Hazard*>> order;
+    order.reserve(hazards.size());
+    for (auto const& [id, h] : hazards) {
+        order.push_back({cell_key(cell_of(h.latitude), cell_of(h.longitude)), &h});
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    auto next = std::make_shared<SpatialIndex>();
+    HazardColumns& columns = next->columns;
+    for (const auto& [key, h] : order) {
+        auto cell = next->grid.try_emplace(key, CellRange{columns.size(), columns.size()}).first;
+        columns.push_back(h->latitude, h->longitude, h->severity);
+        cell->second.end = columns.size();
+    }
+    index = std::move(next);
+}
+
+/**
+ * clear
+ * Empties the registry.
+ */
+void HazardManager::clear() {
+    epoch++;
+    for (auto const& [id, h] : hazards) log_change(&h, nullptr);
+    hazards.clear();
+    index = std::make_shared<SpatialIndex>();
+    expiry.clear();
+    expiry_queue = {};
+}
+
+/**
+ * replace_all
+ * A resident engine receives the full live hazard list with each request.
+ * Stale incidents must not survive between requests, but an unchanged list
+ * must not invalidate anything either, so we only swap (and bump the epoch)
+ * when the contents differ.
+ */
+bool HazardManager::replace_all(const std::vector<Hazard>& live) {
+    std::map<int, Hazard> next = index_by_id(live);
+    if (same_as(next)) return false;
+
+    // Log the difference: walk both ID-ordered maps in step
+    epoch++;
+    auto it = hazards.begin();
+    auto jt = next.begin();
+    while (it != hazards.end() || jt != next.end()) {
+        if (jt == next.end() || (it != hazards.end() && it->first < jt->first)) {
+            log_change(&it->second, nullptr);  // Removed
+            ++it;
+        } else if (it == hazards.end() || jt->first < it->first) {
+            log_change(nullptr, &jt->second);  // Added
+            ++jt;
+        } else {
+            const Hazard& a = it->second;
+            const Hazard& b = jt->second;
+            if (a.latitude != b.latitude || a.longitude != b.longitude || a.severity != b.severity || a.type != b.type) {
+                log_change(&a, &b);            // Updated in place
+            }
+            ++it;
+            ++jt;
+        }
+    }
+
+    hazards.swap(next);
+    rebuild_index();
+
+    // Hazards that left the list take their expiry with them
+    for (auto it = expiry.begin(); it != expiry.end();) {
+        it = hazards.count(it->first) ? std::next(it) : expiry.erase(it);
+    }
+    drop_stale_expiries();
+    return true;
+}
+
+/**
+ * erase_hazard
+ * Shared by the removal paths of apply() and expire().
+ */
+bool HazardManager::erase_hazard(int id) {
+    auto it = hazards.find(id);
+    if (it == hazards.end()) return false;
+    log_change(&it->second, nullptr);
+    hazards.erase(it);
+    expiry.erase(id);
+    return true;
+}
+
+/**
+ * apply
+ * Streams deliver small deltas, so each record costs O(log N) against the
+ * registry; the O(N log N) regrouping of the columns runs once per batch, and
+ * only if a hazard changed. The epoch is advanced lazily by the first record
+ * that changes a hazard, so every change of the batch is logged under it.
+ */
+size_t HazardManager::apply(const std::vector<HazardUpdate>& updates) {
+    size_t applied = 0;
+    bool bumped = false;
+    auto begin_change = [&]() {
+        if (!bumped) epoch++;
+        bumped = true;
+    };
+
+    for (const HazardUpdate& update : updates) {
+        const int id = update.hazard.id;
+        auto it = hazards.find(id);
+        switch (update.op) {
+            case HazardUpdate::Op::Add:
+            case HazardUpdate::Op::Update: {
+                if (it == hazards.end() && update.op == HazardUpdate::Op::Update) break;
+                const Hazard& h = update.hazard;
+                const bool same = it != hazards.end() && it->second.latitude == h.latitude &&
+                                  it->second.longitude == h.longitude && it->second.severity == h.severity &&
+                                  it->second.type == h.type;
+                auto scheduled = expiry.find(id);
+                const long long previous = scheduled == expiry.end() ? 0 : scheduled->second;
+                if (same && previous == update.expires_at) break;
+                if (!same) {
+                    begin_change();
+                    log_change(it != hazards.end() ? &it->second : nullptr, &h);
+                    hazards[id] = h;
+                }
+                schedule_expiry(id, update.expires_at);
+                applied++;
+                break;
+            }
+            case HazardUpdate::Op::Remove:
+                if (it == hazards.end()) break;
+                begin_change();
+                erase_hazard(id);
+                applied++;
+                break;
+            case HazardUpdate::Op::ExpireAt:
+                if (it == hazards.end()) break;
+                schedule_expiry(id, update.expires_at);
+                applied++;
+                break;
+            case HazardUpdate::Op::Clear:
+                if (hazards.empty()) break;
+                begin_change();
+                for (auto const& [hazard_id, h] : hazards) log_change(&h, nullptr);
+                hazards.clear();
+                expiry.clear();
+                applied++;
+                break;
+        }
+    }
+
+    if (bumped) rebuild_index();
+    drop_stale_expiries();
+    return applied;
+}
+
+/**
+ * expire
+ * The heap top is always a live entry (see drop_stale_expiries), so checking
+ * for due hazards is one comparison.
+ */
+size_t HazardManager::expire(long long now) {
+    size_t expired = 0;
+    while (!expiry_queue.empty() && expiry_queue.top().first <= now) {
+        const ExpiryEntry due = expiry_queue.top();
+        expiry_queue.pop();
+        auto it = expiry.find(due.second);
+        if (it == expiry.end() || it->second != due.first) continue; // Rescheduled or removed
+        if (expired == 0) epoch++;
+        erase_hazard(due.second);
+        expired++;
+    }
+    if (expired > 0) rebuild_index();
+    drop_stale_expiries();
+    return expired;
+}
+
+long long HazardManager::next_expiry() const {
+    return expiry_queue.empty() ? LLONG_MAX : expiry_queue.top().first;
+}
+
+/**
+ * schedule_expiry
+ * Records the hazard's expiry (0 cancels it) and pushes a heap entry for it.
+ */
+void HazardManager::schedule_expiry(int id, long long expires_at) {
+    if (expires_at <= 0) {
+        expiry.erase(id);
+        return;
+    }
+    auto it = expiry.find(id);
+    if (it != expiry.end() && it->second == expires_at) return;
+    expiry[id] = expires_at;
+    expiry_queue.push({expires_at, id});
+}
+
+/**
+ * drop_stale_expiries
+ * Pops stale entries off the top, and rebuilds the heap from 'expiry' in O(K)
+ * once stale entries make up more than half of it.
+ */
+void HazardManager::drop_stale_expiries() {
+    if (expiry_queue.size() > 2 * expiry.size() + 64) {
+        std::vector<ExpiryEntry> live;
+        live.reserve(expiry.size());
+        for (auto const& [id, at] : expiry) live.push_back({at, id});
+        expiry_queue = decltype(expiry_queue)(std::greater<ExpiryEntry>(), std::move(live));
+    }
+    while (!expiry_queue.empty()) {
+        auto it = expiry.find(expiry_queue.top().second);
+        if (it != expiry.end() && it->second == expiry_queue.top().first) break;
+        expiry_queue.pop();
+    }
+}
+
+/**
+ * matches
+ * Read-only form of replace_all's change check.
+ */
+bool HazardManager::matches(const std::vector<Hazard>& live) const {
+    return same_as(index_by_id(live));
+}
+
+std::map<int, Hazard> HazardManager::index_by_id(const std::vector<Hazard>& live) {
+    std::map<int, Hazard> next;
+    for (const auto& h : live) {
+        next[h.id] = h;
+    }
+    return next;
+}
+
+// Compares field by field against the current registry
+bool HazardManager::same_as(const std::map<int, Hazard>& next) const {
+    bool same = next.size() == hazards.size();
+    for (auto it = next.begin(), jt = hazards.begin(); same && it != next.end(); ++it, ++jt) {
+        const Hazard& a = it->second;
+        const Hazard& b = jt->second;
+        same = a.id == b.id && a.latitude == b.latitude && a.longitude == b.longitude &&
+               a.severity == b.severity && a.type == b.type;
+    }
+    return same;
 }
 
 /**
@@ -19,25 +363,36 @@ void HazardManager::add_hazard(Hazard h) {
  * Parameters:
  * - lat, lon: The coordinates of the location to evaluate.
  * - radius: The maximum distance (in coordinate units) at which a hazard affects a location.
+ *
+ * DSA Rationale: Only the grid cells overlapping the radius can hold a hazard in
+ * range, so the cost is O(hazards nearby) instead of O(all hazards).
  */
 double HazardManager::get_penalty_for_location(double lat, double lon, double radius) const {
     double total_penalty = 0;
-    
-    // Iterate through every active hazard in the database
-    // DSA Rationale: For a small number of hazards (demo scale), linear iteration is acceptable.
-    for (auto const& [id, h] : hazards) {
-        // Calculate the straight-line (Euclidean) distance to the hazard center
-        double dist = std::sqrt(std::pow(lat - h.latitude, 2) + std::pow(lon - h.longitude, 2));
-        
-        // If the location is within the hazard's 'zone of influence'
-        if (dist < radius) {
-            /**
-             * Linear Decay Penalty Formula:
-             * Penalty = Severity * (1.0 - RelativeDistance)
-             * This ensures that being right on top of a hazard yields the maximum penalty,
-             * while being at the edge of the radius yields a penalty near zero.
-             */
-            total_penalty += h.severity * (1.0 - (dist / radius));
+    const HazardColumns& columns = index->columns;
+    const auto& grid = index->grid;
+    if (grid.empty()) return total_penalty;
+
+    // Number of neighboring cells the radius can reach in each direction
+    const long long reach = static_cast<long long>(std::ceil(radius / cell_size));
+    const long long lat_cell = cell_of(lat);
+    const long long lon_cell = cell_of(lon);
+
+    /**
+     * Linear Decay Penalty Formula (applied by penalty_kernel::accumulate):
+     * Penalty = Severity * (1.0 - RelativeDistance)
+     * This ensures that being right on top of a hazard yields the maximum penalty,
+     * while being at the edge of the radius yields a penalty near zero.
+     */
+    for (long long dy = -reach; dy <= reach; ++dy) {
+        for (long long dx = -reach; dx <= reach; ++dx) {
+            auto cell = grid.find(cell_key(lat_cell + dy, lon_cell + dx));
+            if (cell == grid.end()) continue;
+
+            const CellRange& rows = cell->second;
+            penalty_kernel::accumulate(&lat, &lon, 1, columns.latitudes.data() + rows.begin,
+                                       columns.longitudes.data() + rows.begin, columns.severities.data() + rows.begin,
+                                       rows.end - rows.begin, radius, &total_penalty, penalty_kernel::Isa::Scalar);
         }
     }
     
@@ -45,6 +400,78 @@ double HazardManager::get_penalty_for_location(double lat, double lon, double ra
     return total_penalty;
 }
 
+/**
+ * get_penalties_for_locations
+ * Scores a whole column of coordinates (e.g. every graph node) in one pass.
+ * Points outside the bounding box of all hazards (grown by the radius) cannot
+ * be affected and are rejected with four comparisons, so on a large map only
+ * the nodes near live incidents pay for anything more.
+ * The remaining points are grouped by grid cell. Every point of a cell sees the
+ * same neighboring cells, so each group is copied into a small coordinate block
+ * and scored against each neighboring cell's run of hazard rows with one kernel
+ * call, in the same cell order get_penalty_for_location uses.
+ */
+void HazardManager::get_penalties_for_locations(const double* lats, const double* lons, size_t count,
+                                                std::vector<double>& out, double radius) const {
+    out.assign(count, 0.0);
+    if (hazards.empty()) return;
+    const HazardColumns& columns = index->columns;
+    const auto& grid = index->grid;
+
+    // Bounding box of every hazard's zone of influence
+    double min_lat = 1e18, max_lat = -1e18, min_lon = 1e18, max_lon = -1e18;
+    for (size_t j = 0; j < columns.size(); ++j) {
+        min_lat = std::min(min_lat, columns.latitudes[j]);
+        max_lat = std::max(max_lat, columns.latitudes[j]);
+        min_lon = std::min(min_lon, columns.longitudes[j]);
+        max_lon = std::max(max_lon, columns.longitudes[j]);
+    }
+    min_lat -= radius; max_lat += radius;
+    min_lon -= radius; max_lon += radius;
+
+    // 1. Candidate points, grouped by the cell they fall in
+    std::vector<std::pair<long long, size_t>> members;
+    for (size_t i = 0; i < count; ++i) {
+        if (lats[i] < min_lat || lats[i] > max_lat || lons[i] < min_lon || lons[i] > max_lon) continue;
+        members.push_back({cell_key(cell_of(lats[i]), cell_of(lons[i])), i});
+    }
+    std::sort(members.begin(), members.end());
+
+    // 2. One block per cell: gather, score against the neighborhood, scatter
+    const long long reach = static_cast<long long>(std::ceil(radius / cell_size));
+    std::vector<double> block_lats, block_lons, block_penalties;
+    for (size_t first = 0; first < members.size();) {
+        size_t last = first;
+        while (last < members.size() && members[last].first == members[first].first) ++last;
+
+        block_lats.clear();
+        block_lons.clear();
+        for (size_t m = first; m < last; ++m) {
+            block_lats.push_back(lats[members[m].second]);
+            block_lons.push_back(lons[members[m].second]);
+        }
+        block_penalties.assign(block_lats.size(), 0.0);
+
+        const long long lat_cell = cell_of(block_lats[0]);
+        const long long lon_cell = cell_of(block_lons[0]);
+        for (long long dy = -reach; dy <= reach; ++dy) {
+            for (long long dx = -reach; dx <= reach; ++dx) {
+                auto cell = grid.find(cell_key(lat_cell + dy, lon_cell + dx));
+                if (cell == grid.end()) continue;
+
+                const CellRange& rows = cell->second;
+                penalty_kernel::accumulate(block_lats.data(), block_lons.data(), block_lats.size(),
+                                           columns.latitudes.data() + rows.begin, columns.longitudes.data() + rows.begin,
+                                           columns.severities.data() + rows.begin, rows.end - rows.begin,
+                                           radius, block_penalties.data());
+            }
+        }
+
+        for (size_t m = first; m < last; ++m) out[members[m].second] = block_penalties[m - first];
+        first = last;
+    }
+}
+
 /**
  * get_all_hazards
  * Transforms the internal map into a flat vector for easier processing or JSON serialization.
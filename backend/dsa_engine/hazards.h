@@ -4,6 +4,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <memory>
+#include <queue>
+#include <utility>
+#include "penalty_kernel.h"
 
 /**
  * Hazard Structure
@@ -17,6 +22,36 @@ struct Hazard {
     std::string type;     // Classification (e.g., "Traffic", "Construction", "Protest")
 };
 
+/**
+ * HazardChange
+ * One entry of the HazardManager changelog: a hazard as it was before and after
+ * the change that produced 'epoch'. An addition has no 'before', a removal no 'after'.
+ */
+struct HazardChange {
+    unsigned long long epoch;
+    bool has_before;
+    Hazard before;
+    bool has_after;
+    Hazard after;
+};
+
+/**
+ * HazardUpdate
+ * One record of a streamed hazard change (see HazardManager::apply):
+ * - Add:      registers 'hazard', replacing any hazard with the same ID
+ * - Update:   replaces the tracked hazard with that ID; ignored if there is none
+ * - Remove:   drops hazard 'hazard.id'
+ * - ExpireAt: reschedules when hazard 'hazard.id' drops out ('expires_at', 0 = never)
+ * - Clear:    drops every hazard
+ * Add and Update also set the hazard's expiry from 'expires_at'.
+ */
+struct HazardUpdate {
+    enum class Op { Add, Update, Remove, ExpireAt, Clear };
+    Op op;
+    Hazard hazard;
+    long long expires_at = 0;   // Unix time in seconds; 0 = no expiry
+};
+
 /**
  * HazardManager Class
  * Responsibility: Tracks all active hazards and calculates their spatial impact on roads.
@@ -24,17 +59,143 @@ struct Hazard {
  */
 class HazardManager {
 private:
+    /**
+     * CellRange
+     * The hazards of one grid cell: rows [begin, end) of 'columns'.
+     */
+    struct CellRange {
+        size_t begin;
+        size_t end;
+    };
+
+    /**
+     * SpatialIndex
+     * The penalty fields of every hazard as columns (penalty_kernel.h), ordered
+     * cell by cell so each grid cell is one contiguous run of rows, and the uniform
+     * spatial grid: cell key -> rows of the hazards whose center lies in that cell.
+     * Cells are 'cell_size' degrees wide (the default influence radius), so a lookup
+     * only needs the 3x3 block of cells around the query point.
+     */
+    struct SpatialIndex {
+        HazardColumns columns;
+        std::unordered_map<long long, CellRange> grid;
+    };
+
     // Internal registry of all active hazards, indexed by ID for O(log N) access
     std::map<int, Hazard> hazards;
+    // Never modified once built (a change builds a new one), so copies of the
+    // manager share it until one of them changes (never null)
+    std::shared_ptr<const SpatialIndex> index = std::make_shared<SpatialIndex>();
+    double cell_size;
+    // Incremented on every change to the registry, so derived data (such as
+    // edge penalty overlays) can tell whether it is still up to date
+    unsigned long long epoch = 0;
+
+    /**
+     * ChangeBatch
+     * The logged changes of one epoch, linked to the batch of the epoch before.
+     * A batch is frozen once a copy of the manager shares it, so copies (such as
+     * successive hazard snapshots) share their history instead of duplicating it.
+     */
+    struct ChangeBatch {
+        unsigned long long epoch;
+        std::vector<HazardChange> changes;
+        std::shared_ptr<const ChangeBatch> previous;
+    };
+
+    // Recent changes, newest epoch first, so derived data can catch up incrementally
+    // instead of starting over. At least the last kChangelogLimit entries are kept;
+    // changes up to 'changelog_floor' are no longer available.
+    std::shared_ptr<ChangeBatch> changelog;
+    size_t changelog_entries = 0;   // Changes reachable from 'changelog'
+    unsigned long long changelog_floor = 0;
+    static const size_t kChangelogLimit = 4096;
+    void log_change(const Hazard* before, const Hazard* after);
+    void trim_changelog();
+
+    // Grid helpers: cell coordinate of a degree value, and the packed key of a cell
+    long long cell_of(double degrees) const;
+    static long long cell_key(long long lat_cell, long long lon_cell);
+    // The live list keyed by ID (a later duplicate wins), and whether it equals the registry
+    static std::map<int, Hazard> index_by_id(const std::vector<Hazard>& live);
+    bool same_as(const std::map<int, Hazard>& next) const;
+
+    // Builds a new spatial index from the registry, O(N log N)
+    void rebuild_index();
+
+    // Expiry times of the hazards that have one, and a min-heap of (time, ID) over
+    // them. Rescheduling or removing a hazard leaves its old heap entry behind; stale
+    // entries are popped once they reach the top (so the top is always live) and the
+    // heap is rebuilt when they outnumber the live ones.
+    typedef std::pair<long long, int> ExpiryEntry;
+    std::unordered_map<int, long long> expiry;
+    std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<ExpiryEntry>> expiry_queue;
+    void schedule_expiry(int id, long long expires_at);
+    void drop_stale_expiries();
+
+    // Removes one hazard and logs it under the current epoch; false if it is not tracked
+    bool erase_hazard(int id);
 
 public:
-    // Registers a new live hazard into the system
+    // Default zone of influence around a hazard center, in coordinate degrees (~500 m)
+    static constexpr double kInfluenceRadius = 0.005;
+
+    // Creates an empty manager; 'grid_cell_size' should match the usual influence radius
+    explicit HazardManager(double grid_cell_size = kInfluenceRadius) : cell_size(grid_cell_size) {}
+
+    // Registers a new live hazard into the system (replaces any hazard with the same ID)
     void add_hazard(Hazard h);
     
+    // Drops every tracked hazard
+    void clear();
+
+    // Replaces the registry with a fresh live list. Returns true (and advances
+    // the epoch) only if the list actually differs from what is tracked.
+    bool replace_all(const std::vector<Hazard>& live);
+
+    // Applies a batch of streamed changes in order, as one epoch, and regroups the
+    // index once for the whole batch. Returns how many records changed something
+    // (the epoch only advances if a hazard itself changed, not just its expiry).
+    size_t apply(const std::vector<HazardUpdate>& updates);
+
+    // Drops every hazard whose expiry time is <= 'now' (Unix seconds), as one epoch.
+    // Pops only the due entries off the expiry heap, so nothing is scanned when
+    // none is due. Returns how many hazards expired.
+    size_t expire(long long now);
+
+    // Earliest scheduled expiry, or LLONG_MAX if no hazard has one; O(1)
+    long long next_expiry() const;
+
+    // Number of tracked hazards
+    size_t size() const { return hazards.size(); }
+
+    // True if 'live' holds exactly the tracked hazards, i.e. replace_all(live) would
+    // be a no-op. Lets a caller skip copying the manager for an unchanged list.
+    bool matches(const std::vector<Hazard>& live) const;
+
+    // Current version of the hazard set
+    unsigned long long get_epoch() const { return epoch; }
+
+    // Appends every change made after epoch 'since' to 'out', oldest first. Returns
+    // false if the changelog no longer reaches back that far (the caller must then
+    // treat everything as changed).
+    bool changes_since(unsigned long long since, std::vector<HazardChange>& out) const;
+    
     // Core logic: Evaluates the cumulative danger penalty for a specific coordinate
     // The 'radius' parameter defines the area of effect for each hazard.
-    double get_penalty_for_location(double lat, double lon, double radius = 0.005) const;
+    // Only hazards in grid cells within 'radius' of the point are inspected.
+    double get_penalty_for_location(double lat, double lon, double radius = kInfluenceRadius) const;
+
+    // Batch variant: evaluates every (lats[i], lons[i]) pair, i < count, in one pass and
+    // writes the penalties into 'out' (resized to match). Used to score all graph nodes at once.
+    // Points are scored a grid cell at a time by the vectorized penalty kernel; the
+    // results equal get_penalty_for_location's exactly.
+    void get_penalties_for_locations(const double* lats, const double* lons, size_t count,
+                                     std::vector<double>& out, double radius = kInfluenceRadius) const;
     
+    // Structure-of-arrays view of the tracked hazards (grouped by grid cell)
+    const HazardColumns& hazard_columns() const { return index->columns; }
+
     // Returns a flat list of all currently tracked hazards
     std::vector<Hazard> get_all_hazards() const;
 };
@@ -0,0 +1,212 @@
+#include "hull.h"
+#include "geo.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <list>
+
+namespace {
+
+/**
+ * Flat
+ * A point on the local flat projection: x = longitude * cos(mean latitude), y = latitude.
+ */
+struct Flat {
+    double x;
+    double y;
+};
+
+// > 0 if o -> a -> b turns counter-clockwise
+double cross(const Flat& o, const Flat& a, const Flat& b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+double distance_sq(const Flat& a, const Flat& b) {
+    const double dx = a.x - b.x, dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+// Squared distance from p to the segment a-b
+double segment_distance_sq(const Flat& p, const Flat& a, const Flat& b) {
+    const double dx = b.x - a.x, dy = b.y - a.y;
+    const double length_sq = dx * dx + dy * dy;
+    double t = length_sq > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length_sq : 0.0;
+    t = std::max(0.0, std::min(1.0, t));
+    return distance_sq(p, {a.x + t * dx, a.y + t * dy});
+}
+
+/**
+ * project_unique
+ * Projects the points and drops exact duplicates. 'flat' is sorted by (x, y);
+ * origin[i] is the input index of flat[i].
+ */
+void project_unique(const std::vector<hull::Point>& points, std::vector<Flat>& flat, std::vector<int>& origin) {
+    double mean_lat = 0;
+    for (const hull::Point& p : points) mean_lat += p.latitude;
+    if (!points.empty()) mean_lat /= static_cast<double>(points.size());
+    const double scale = std::cos(mean_lat * geo::kDegToRad);
+
+    std::vector<int> order(points.size());
+    for (size_t i = 0; i < points.size(); ++i) order[i] = static_cast<int>(i);
+    auto flat_of = [&](int i) { return Flat{points[i].longitude * scale, points[i].latitude}; };
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        const Flat fa = flat_of(a), fb = flat_of(b);
+        return fa.x < fb.x || (fa.x == fb.x && fa.y < fb.y);
+    });
+
+    flat.clear();
+    origin.clear();
+    for (int i : order) {
+        const Flat f = flat_of(i);
+        if (!flat.empty() && flat.back().x == f.x && flat.back().y == f.y) continue;
+        flat.push_back(f);
+        origin.push_back(i);
+    }
+}
+
+/**
+ * convex_ring
+ * Andrew's monotone chain over points sorted by (x, y): lower then upper hull,
+ * collinear points dropped. Returns indices into 'flat', counter-clockwise.
+ */
+std::vector<int> convex_ring(const std::vector<Flat>& flat) {
+    const int n = static_cast<int>(flat.size());
+    if (n < 3) {
+        std::vector<int> all(n);
+        for (int i = 0; i < n; ++i) all[i] = i;
+        return all;
+    }
+    std::vector<int> ring(2 * n);
+    int k = 0;
+    for (int i = 0; i < n; ++i) {
+        while (k >= 2 && cross(flat[ring[k - 2]], flat[ring[k - 1]], flat[i]) <= 0) k--;
+        ring[k++] = i;
+    }
+    for (int i = n - 2, lower = k + 1; i >= 0; --i) {
+        while (k >= lower && cross(flat[ring[k - 2]], flat[ring[k - 1]], flat[i]) <= 0) k--;
+        ring[k++] = i;
+    }
+    ring.resize(k - 1); // The last point repeats the first
+    return ring;
+}
+
+// True if segments a-b and c-d cross at a point interior to both
+bool segments_cross(const Flat& a, const Flat& b, const Flat& c, const Flat& d) {
+    const double d1 = cross(a, b, c), d2 = cross(a, b, d);
+    const double d3 = cross(c, d, a), d4 = cross(c, d, b);
+    return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
+std::vector<hull::Point> to_points(const std::vector<hull::Point>& points, const std::vector<int>& origin,
+                                   const std::vector<int>& ring) {
+    std::vector<hull::Point> out;
+    out.reserve(ring.size());
+    for (int i : ring) out.push_back(points[origin[i]]);
+    return out;
+}
+
+} // namespace
+
+namespace hull {
+
+std::vector<Point> convex_hull(const std::vector<Point>& points) {
+    std::vector<Flat> flat;
+    std::vector<int> origin;
+    project_unique(points, flat, origin);
+    return to_points(points, origin, convex_ring(flat));
+}
+
+/**
+ * concave_hull
+ * Walks the ring, one edge a -> b at a time. A point p can only dig into the
+ * edge if |ab| / min(|pa|, |pb|) > concavity, i.e. p lies within |ab| / concavity
+ * of an end, so candidates come from a sweep over the x-sorted points. They are
+ * tried nearest to the edge first; one is taken if it lies inside the edge, is
+ * not nearer to a neighboring edge, leaves no other point in the triangle a-p-b
+ * it cuts away, and its new edges cross no edge of the ring. The new edges
+ * a -> p and p -> b are examined next; the walk ends after a full lap without changes.
+ */
+std::vector<Point> concave_hull(const std::vector<Point>& points, double concavity) {
+    std::vector<Flat> flat;
+    std::vector<int> origin;
+    project_unique(points, flat, origin);
+    std::vector<int> convex = convex_ring(flat);
+    if (convex.size() < 3 || concavity <= 0) return to_points(points, origin, convex);
+
+    std::list<int> ring(convex.begin(), convex.end());
+    std::vector<char> on_ring(flat.size(), 0);
+    std::vector<char> settled(flat.size(), 0); // settled[a]: edge from a to its successor is final
+    for (int i : convex) on_ring[i] = 1;
+
+    auto next_of = [&](std::list<int>::iterator it) { return ++it == ring.end() ? ring.begin() : it; };
+    auto prev_of = [&](std::list<int>::iterator it) { return it == ring.begin() ? std::prev(ring.end()) : --it; };
+
+    size_t unchanged = 0;
+    for (auto it = ring.begin(); unchanged < ring.size();) {
+        const int a = *it;
+        const auto next_it = next_of(it);
+        const int b = *next_it;
+        if (settled[a]) {
+            unchanged++;
+            it = next_it;
+            continue;
+        }
+
+        const Flat& fa = flat[a];
+        const Flat& fb = flat[b];
+        const Flat& before = flat[*prev_of(it)];
+        const Flat& after = flat[*next_of(next_it)];
+        const double reach = std::sqrt(distance_sq(fa, fb)) / concavity;
+        const double reach_sq = reach * reach;
+
+        // Candidates: x within reach of the edge's x-extent (flat is sorted by x)
+        const double x_lo = std::min(fa.x, fb.x) - reach, x_hi = std::max(fa.x, fb.x) + reach;
+        auto first = std::lower_bound(flat.begin(), flat.end(), x_lo, [](const Flat& f, double x) { return f.x < x; });
+        std::vector<std::pair<double, int>> candidates;
+        for (auto p = first; p != flat.end() && p->x <= x_hi; ++p) {
+            const int k = static_cast<int>(p - flat.begin());
+            if (on_ring[k] || cross(fa, fb, *p) <= 0) continue;
+            if (distance_sq(*p, fa) >= reach_sq && distance_sq(*p, fb) >= reach_sq) continue;
+            const double d = segment_distance_sq(*p, fa, fb);
+            if (segment_distance_sq(*p, before, fa) < d || segment_distance_sq(*p, fb, after) < d) continue;
+            candidates.push_back({d, k});
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        int best = -1;
+        for (const auto& [d, k] : candidates) {
+            const Flat& fp = flat[k];
+            // No point may be left outside: the triangle a-p-b must be empty
+            bool clear = true;
+            for (auto q = first; clear && q != flat.end() && q->x <= x_hi; ++q) {
+                if (q - flat.begin() == k) continue;
+                clear = !(cross(fa, fb, *q) > 0 && cross(fb, fp, *q) > 0 && cross(fp, fa, *q) > 0);
+            }
+            // ...and the ring must stay simple
+            for (auto e = ring.begin(); clear && e != ring.end(); ++e) {
+                const int u = *e, w = *next_of(e);
+                if (u == a) continue;
+                clear = !segments_cross(fa, fp, flat[u], flat[w]) && !segments_cross(fp, fb, flat[u], flat[w]);
+            }
+            if (clear) {
+                best = k;
+                break;
+            }
+        }
+
+        if (best < 0) {
+            settled[a] = 1;
+            unchanged++;
+            it = next_it;
+        } else {
+            ring.insert(next_it, best);
+            on_ring[best] = 1;
+            unchanged = 0; // Stay on 'a': its edge now ends at 'best'
+        }
+    }
+
+    std::vector<int> result(ring.begin(), ring.end());
+    return to_points(points, origin, result);
+}
+
+} // namespace hull
@@ -0,0 +1,35 @@
+#ifndef HULL_H
+#define HULL_H
+
+#include <vector>
+
+/**
+ * Hull
+ * Outlines of point sets, used to turn the intersections reached by an
+ * isochrone into a coverage polygon for the map.
+ * Coordinates are WGS84 degrees; the geometry runs on a local flat projection
+ * (longitudes scaled by cos(latitude)), which is accurate at city scale.
+ * Rings are returned counter-clockwise without repeating the first point.
+ */
+namespace hull {
+
+struct Point {
+    double latitude;
+    double longitude;
+};
+
+// Smallest convex polygon containing every point (Andrew's monotone chain, O(N log N))
+std::vector<Point> convex_hull(const std::vector<Point>& points);
+
+/**
+ * concave_hull
+ * Digs into the convex hull edge by edge (Park & Oh): an edge is replaced by two
+ * edges through an interior point when the edge is more than 'concavity' times
+ * longer than that point's distance to the nearer end of the edge. Smaller
+ * values follow the points more tightly; large values give the convex hull.
+ */
+std::vector<Point> concave_hull(const std::vector<Point>& points, double concavity = 2.0);
+
+} // namespace hull
+
+#endif // HULL_H
@@ -0,0 +1,128 @@
+#include "json_writer.h"
+#include <charconv>
+#include <cmath>
+
+void JsonWriter::separate() {
+    if (after_key) {
+        after_key = false;
+        return;
+    }
+    if (first_in_scope.empty()) return;
+    if (first_in_scope.back()) first_in_scope.back() = false;
+    else buffer.append(", ");
+}
+
+JsonWriter& JsonWriter::begin_object() {
+    separate();
+    buffer.push_back('{');
+    first_in_scope.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    buffer.push_back('}');
+    first_in_scope.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array() {
+    separate();
+    buffer.push_back('[');
+    first_in_scope.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    buffer.push_back(']');
+    first_in_scope.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    write_escaped(name);
+    buffer.append(": ");
+    after_key = true;
+    return *this;
+}
+
+/**
+ * write_escaped
+ * Copies runs of plain characters in bulk and escapes only what JSON requires.
+ * Bytes >= 0x80 (UTF-8 sequences) pass through unchanged.
+ */
+void JsonWriter::write_escaped(std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    buffer.push_back('"');
+    size_t run = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        buffer.append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"': buffer.append("\\\""); break;
+            case '\\': buffer.append("\\\\"); break;
+            case '\n': buffer.append("\\n"); break;
+            case '\r': buffer.append("\\r"); break;
+            case '\t': buffer.append("\\t"); break;
+            case '\b': buffer.append("\\b"); break;
+            case '\f': buffer.append("\\f"); break;
+            default: {
+                const char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                buffer.append(escape, sizeof(escape));
+            }
+        }
+    }
+    buffer.append(text.data() + run, text.size() - run);
+    buffer.push_back('"');
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    write_escaped(text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    if (!std::isfinite(number)) return null(); // JSON has no NaN / Infinity
+    separate();
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long long number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    buffer.append(flag ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    buffer.append("null");
+    return *this;
+}
+
+void JsonWriter::clear() {
+    buffer.clear();
+    first_in_scope.clear();
+    after_key = false;
+}
@@ -0,0 +1,79 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+/**
+ * JsonWriter Class
+ * Serializes one JSON document into a growable buffer that is reused between
+ * responses, then hands it to the stream in a single write.
+ * - Numbers go through std::to_chars: doubles in the shortest form that reads back
+ *   to the same value (no iostream locale or precision state), non-finite as null.
+ * - Strings are escaped (quotes, backslashes, control characters), so names
+ *   coming from user payloads cannot break the document.
+ * - Commas between members / elements are inserted automatically.
+ * Output keeps the engine's usual spacing: {"key": value, "key": [1, 2]}.
+ *
+ * Usage:
+ *   json.begin_object().key("status").value("success").key("data").begin_array();
+ *   ...
+ *   json.end_array().end_object();
+ */
+class JsonWriter {
+private:
+    std::string buffer;
+    // One flag per open object / array: true until its first member or element
+    std::vector<bool> first_in_scope;
+    // Set by key(): the next value completes a member, so no separator goes before it
+    bool after_key = false;
+
+    // Writes ", " before every member or element except the first of its scope
+    void separate();
+    void write_escaped(std::string_view text);
+
+public:
+    explicit JsonWriter(size_t reserve_bytes = 4096) { buffer.reserve(reserve_bytes); }
+
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    JsonWriter& begin_array();
+    JsonWriter& end_array();
+
+    // Member name inside an object; must be followed by exactly one value or scope
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(const std::string& text) { return value(std::string_view(text)); }
+    JsonWriter& value(double number);
+    JsonWriter& value(int number) { return value(static_cast<long long>(number)); }
+    JsonWriter& value(long number) { return value(static_cast<long long>(number)); }
+    JsonWriter& value(long long number);
+    JsonWriter& value(unsigned long long number);
+    JsonWriter& value(unsigned long number) { return value(static_cast<unsigned long long>(number)); }
+    JsonWriter& value(unsigned number) { return value(static_cast<unsigned long long>(number)); }
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+
+    // Shorthand for key(name).value(v)
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& v) { return key(name).value(v); }
+
+    // Ends the document with a newline (the line-oriented CLI contract)
+    JsonWriter& newline() { buffer.push_back('\n'); return *this; }
+
+    // Empties the writer but keeps its capacity for the next response
+    void clear();
+
+    const std::string& str() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+
+    // Sends the whole document with one write call
+    void write_to(std::ostream& out) const { out.write(buffer.data(), static_cast<std::streamsize>(buffer.size())); }
+};
+
+#endif // JSON_WRITER_H
@@ -10,97 +10,219 @@
  */
 double KDTree::calculate_distance(double lat1, double lon1, double lat2, double lon2) {
     // Standard Euclidean distance formula: Δx² + Δy²
-    return std::pow(lat1 - lat2, 2) + std::pow(lon1 - lon2, 2);
+    double d_lat = lat1 - lat2;
+    double d_lon = lon1 - lon2;
+    return d_lat * d_lat + d_lon * d_lon;
 }
 
 /**
- * insert_recursive
- * A recursive function that inserts a Facility into the KD-Tree.
+ * KDTree (bulk constructor)
+ * Takes ownership of the whole facility list and builds the tree once.
+ */
+KDTree::KDTree(std::vector<Facility> list) : facilities(std::move(list)) {
+    build();
+}
+
+/**
+ * build
+ * Sizes the implicit node array for the deepest level the median splits can
+ * reach, then partitions recursively from the root.
+ */
+void KDTree::build() {
+    dirty = false;
+    nodes.clear();
+    if (facilities.empty()) return;
+
+    // Halving the largest slice until it fits a bucket gives the tree depth
+    int depth = 0;
+    for (size_t n = facilities.size(); n > static_cast<size_t>(kLeafSize); n = (n + 1) / 2) depth++;
+    nodes.assign((size_t(1) << (depth + 1)) - 1, KDNode{0.0, 0, 0});
+
+    build_recursive(0, 0, static_cast<int>(facilities.size()), 0);
+}
+
+/**
+ * build_recursive
  * The tree alternates the splitting axis at each level of depth:
  * Even depth: Split by Latitude (X-axis)
  * Odd depth: Split by Longitude (Y-axis)
+ * std::nth_element moves the median facility to 'mid' with every lesser one
+ * before it and every greater one after it, in O(n) per level.
  */
-std::unique_ptr<KDNode> KDTree::insert_recursive(std::unique_ptr<KDNode> node, Facility f, int depth) {
-    // Base Case: If we reach a null pointer, create a new leaf node here
-    if (!node) {
-        return std::make_unique<KDNode>(f);
-    }
+void KDTree::build_recursive(size_t index, int begin, int end, int depth) {
+    KDNode& node = nodes[index];
+    node.begin = begin;
+    node.end = end;
 
-    // Determine current splitting axis: 0 for Latitude, 1 for Longitude
-    int axis = depth % 2; 
-    
-    if (axis == 0) {
-        // Splitting by Latitude
-        if (f.latitude < node->facility.latitude)
-            // Recurse into the left child if the new point is 'less' than the current node
-            node->left = insert_recursive(std::move(node->left), f, depth + 1);
-        else
-            // Recurse into the right child if it's 'greater' or equal
-            node->right = insert_recursive(std::move(node->right), f, depth + 1);
-    } else {
-        // Splitting by Longitude
-        if (f.longitude < node->facility.longitude)
-            // Recurse into the left child for lesser longitude
-            node->left = insert_recursive(std::move(node->left), f, depth + 1);
-        else
-            // Recurse into the right child for greater longitude
-            node->right = insert_recursive(std::move(node->right), f, depth + 1);
-    }
+    // Base Case: small slices become leaf buckets
+    if (end - begin <= kLeafSize) return;
 
-    // Return the (potentially modified) node pointer to rebuild the tree structure
-    return node;
+    int axis = depth % 2;
+    int mid = begin + (end - begin) / 2;
+    std::nth_element(facilities.begin() + begin, facilities.begin() + mid, facilities.begin() + end,
+                     [axis](const Facility& a, const Facility& b) {
+                         return axis == 0 ? a.latitude < b.latitude : a.longitude < b.longitude;
+                     });
+    node.split = axis == 0 ? facilities[mid].latitude : facilities[mid].longitude;
+
+    // Lesser half [begin, mid) on the left, greater-or-equal half [mid, end) on the right
+    build_recursive(2 * index + 1, begin, mid, depth + 1);
+    build_recursive(2 * index + 2, mid, end, depth + 1);
 }
 
-// Public entry point for insertion
+// Public entry point for insertion: the balanced tree is rebuilt lazily
 void KDTree::insert(Facility f) {
-    root = insert_recursive(std::move(root), f, 0);
+    facilities.push_back(std::move(f));
+    dirty = true;
 }
 
 /**
  * find_nearest_recursive
- * The heart of the KD-Tree: explores the spatial tree to find the point with the 
- * smallest distance to the target query (lat, lon).
+ * The heart of the KD-Tree: explores the spatial tree to find the point with the
+ * smallest distance to the target query (lat, lon). Only the index of the best
+ * facility is tracked, so no Facility (or its strings) is copied during the search.
  */
-void KDTree::find_nearest_recursive(KDNode* node, double lat, double lon, int depth, Facility& best, double& best_dist) {
-    // Termination: If we exceed leaf nodes, just return
-    if (!node) return;
-
-    // 1. Evaluate current node as a candidate for the 'best' (nearest)
-    double d = calculate_distance(lat, lon, node->facility.latitude, node->facility.longitude);
-    if (d < best_dist) {
-        best_dist = d;      // Update minimum distance found so far
-        best = node->facility; // Keep track of the facility details
+void KDTree::find_nearest_recursive(size_t index, double lat, double lon, int depth, int& best, double& best_dist) const {
+    const KDNode& node = nodes[index];
+
+    // 1. Leaf bucket: evaluate every facility in the slice as a candidate
+    if (node.end - node.begin <= kLeafSize) {
+        for (int i = node.begin; i < node.end; ++i) {
+            double d = calculate_distance(lat, lon, facilities[i].latitude, facilities[i].longitude);
+            if (d < best_dist) {
+                best_dist = d;  // Update minimum distance found so far
+                best = i;       // Keep track of the facility position
+            }
+        }
+        return;
     }
 
     // 2. Decide which subtree (left/right) is most likely to contain the nearest neighbor
     int axis = depth % 2;
-    KDNode* next = (axis == 0) ? (lat < node->facility.latitude ? node->left.get() : node->right.get()) 
-                               : (lon < node->facility.longitude ? node->left.get() : node->right.get());
-    
+    double diff = (axis == 0 ? lat : lon) - node.split;
+    size_t next = diff < 0 ? 2 * index + 1 : 2 * index + 2;
     // Store the other branch as a secondary option for potential backtracking
-    KDNode* other = (next == node->left.get()) ? node->right.get() : node->left.get();
+    size_t other = diff < 0 ? 2 * index + 2 : 2 * index + 1;
 
     // 3. Recurse down the 'ideal' branch first
     find_nearest_recursive(next, lat, lon, depth + 1, best, best_dist);
 
     // 4. Pruning Logic: Check if it's even POSSIBLE for a closer point to exist in the other branch.
-    // We calculate the distance from the query point to the hyper-plane (the line) splitting this node.
-    double axis_dist = (axis == 0) ? std::pow(lat - node->facility.latitude, 2) 
-                                   : std::pow(lon - node->facility.longitude, 2);
-    
-    // If the distance to the splitting line is LESS than our current best distance, 
+    // If the distance to the splitting line is LESS than our current best distance,
     // there might be a closer point on the other side of the line.
-    if (axis_dist < best_dist) {
+    if (diff * diff < best_dist) {
         find_nearest_recursive(other, lat, lon, depth + 1, best, best_dist);
     }
 }
 
 // Public entry point for nearest-neighbor search
 Facility KDTree::find_nearest(double lat, double lon) {
-    Facility best = {-1, "None", "None", 0, 0};
+    if (dirty) build();
+    if (facilities.empty()) return {-1, "None", "None", 0, 0};
+
+    int best = -1;
     double best_dist = 1e18; // Start with 'infinity' to ensure the first node is accepted
-    
+
     // Search starting from the root at depth 0
-    find_nearest_recursive(root.get(), lat, lon, 0, best, best_dist);
-    return best;
+    find_nearest_recursive(0, lat, lon, 0, best, best_dist);
+    return facilities[best];
+}
+
+/**
+ * find_k_nearest_recursive
+ * Same descent as find_nearest_recursive, but the pruning bound is the k-th best
+ * distance found so far (the top of the bounded max-heap) instead of the single best.
+ * Until k candidates are known nothing can be pruned.
+ */
+void KDTree::find_k_nearest_recursive(size_t index, double lat, double lon, int depth, size_t k, const std::string& type,
+                                      std::vector<std::pair<double, int>>& heap) const {
+    const KDNode& node = nodes[index];
+
+    if (node.end - node.begin <= kLeafSize) {
+        for (int i = node.begin; i < node.end; ++i) {
+            if (!matches(i, type)) continue;
+            double d = calculate_distance(lat, lon, facilities[i].latitude, facilities[i].longitude);
+            if (heap.size() < k) {
+                heap.push_back({d, i});
+                std::push_heap(heap.begin(), heap.end());
+            } else if (d < heap.front().first) {
+                // Evict the current k-th best to make room for the closer facility
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = {d, i};
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+
+    int axis = depth % 2;
+    double diff = (axis == 0 ? lat : lon) - node.split;
+    size_t next = diff < 0 ? 2 * index + 1 : 2 * index + 2;
+    size_t other = diff < 0 ? 2 * index + 2 : 2 * index + 1;
+
+    find_k_nearest_recursive(next, lat, lon, depth + 1, k, type, heap);
+    if (heap.size() < k || diff * diff < heap.front().first) {
+        find_k_nearest_recursive(other, lat, lon, depth + 1, k, type, heap);
+    }
+}
+
+// Public entry point for k-nearest search
+std::vector<int> KDTree::find_k_nearest(double lat, double lon, size_t k, const std::string& type) {
+    if (dirty) build();
+    std::vector<int> result;
+    if (facilities.empty() || k == 0) return result;
+
+    std::vector<std::pair<double, int>> heap;
+    heap.reserve(k);
+    find_k_nearest_recursive(0, lat, lon, 0, k, type, heap);
+
+    // Heap sort leaves the candidates in ascending distance order
+    std::sort_heap(heap.begin(), heap.end());
+    result.reserve(heap.size());
+    for (const auto& entry : heap) result.push_back(entry.second);
+    return result;
+}
+
+/**
+ * find_within_radius_recursive
+ * Range search: a subtree is skipped only when the splitting line itself is
+ * farther than the radius, since then nothing on that side can be inside it.
+ */
+void KDTree::find_within_radius_recursive(size_t index, double lat, double lon, int depth, double radius_sq, const std::string& type,
+                                          std::vector<std::pair<double, int>>& hits) const {
+    const KDNode& node = nodes[index];
+
+    if (node.end - node.begin <= kLeafSize) {
+        for (int i = node.begin; i < node.end; ++i) {
+            if (!matches(i, type)) continue;
+            double d = calculate_distance(lat, lon, facilities[i].latitude, facilities[i].longitude);
+            if (d <= radius_sq) hits.push_back({d, i});
+        }
+        return;
+    }
+
+    int axis = depth % 2;
+    double diff = (axis == 0 ? lat : lon) - node.split;
+    size_t next = diff < 0 ? 2 * index + 1 : 2 * index + 2;
+    size_t other = diff < 0 ? 2 * index + 2 : 2 * index + 1;
+
+    find_within_radius_recursive(next, lat, lon, depth + 1, radius_sq, type, hits);
+    if (diff * diff <= radius_sq) {
+        find_within_radius_recursive(other, lat, lon, depth + 1, radius_sq, type, hits);
+    }
+}
+
+// Public entry point for radius search
+std::vector<int> KDTree::find_within_radius(double lat, double lon, double radius, const std::string& type) {
+    if (dirty) build();
+    std::vector<int> result;
+    if (facilities.empty() || radius < 0) return result;
+
+    std::vector<std::pair<double, int>> hits;
+    find_within_radius_recursive(0, lat, lon, 0, radius * radius, type, hits);
+
+    std::sort(hits.begin(), hits.end());
+    result.reserve(hits.size());
+    for (const auto& entry : hits) result.push_back(entry.second);
+    return result;
 }
@@ -3,7 +3,7 @@
 
 #include <vector>
 #include <string>
-#include <memory>
+#include <utility>
 
 /**
  * Facility structure
@@ -20,46 +20,87 @@ struct Facility {
 
 /**
  * KD-Node
- * A fundamental building block of the KD-Tree (K-Dimensional Tree).
- * It stores a Facility and owns its child nodes using smart pointers.
+ * One entry of the flat tree array. Nodes are stored in implicit (heap) order:
+ * the children of node i live at 2i + 1 (lesser half) and 2i + 2 (greater half),
+ * so the tree needs no pointers and no per-node heap allocation.
+ * Every node covers the slice [begin, end) of the facility array; a node whose
+ * slice holds at most KDTree::kLeafSize facilities is a leaf bucket.
  */
 struct KDNode {
-    Facility facility;              // The spatial data stored at this node
-    std::unique_ptr<KDNode> left;   // Subtree representing the 'lesser' half-space
-    std::unique_ptr<KDNode> right;  // Subtree representing the 'greater' half-space
-
-    // Constructor to initialize a leaf node with facility data
-    KDNode(Facility f) : facility(f), left(nullptr), right(nullptr) {}
+    double split;         // Coordinate of the median facility on this node's axis
+    int begin;            // First facility of this subtree
+    int end;              // One past the last facility of this subtree
 };
 
 /**
  * KD-Tree Class
- * Purpose: Provides O(log N) average-case complexity for nearest-neighbor searches.
+ * Purpose: Provides O(log N) complexity for nearest-neighbor searches.
  * This is significantly faster than O(N) linear search as it partitions space.
  * For 2D spatial data (Lat/Lon), this is a 2-D Tree.
+ *
+ * The tree is bulk-built by median partitioning (std::nth_element), alternating
+ * Latitude / Longitude by depth. Splitting at the median guarantees O(log N)
+ * depth for any input order (sorted or clustered lists included), and facilities
+ * are reordered so each leaf bucket is contiguous in memory.
  */
 class KDTree {
 private:
-    std::unique_ptr<KDNode> root; // The root of the spatial tree
-
-    // Recursive helper to insert a new facility into the appropriate quadrant
-    std::unique_ptr<KDNode> insert_recursive(std::unique_ptr<KDNode> node, Facility f, int depth);
-    
-    // Recursive search logic for finding the closest node to a query point
-    void find_nearest_recursive(KDNode* node, double lat, double lon, int depth, Facility& best, double& best_dist);
-    
+    std::vector<Facility> facilities; // Reordered so every subtree is a contiguous slice
+    std::vector<KDNode> nodes;        // Flat implicit tree (see KDNode)
+    bool dirty = false;               // Facilities were inserted since the last build
+
+    // Median-partitions facilities[begin, end) and fills node 'index' and its subtree
+    void build_recursive(size_t index, int begin, int end, int depth);
+
+    // (Re)builds the whole tree from the current facility list. O(N log N).
+    void build();
+
+    // Recursive search logic for finding the closest facility to a query point
+    void find_nearest_recursive(size_t index, double lat, double lon, int depth, int& best, double& best_dist) const;
+
+    // Recursive k-nearest search; 'heap' is a max-heap of (squared distance, index) capped at k entries
+    void find_k_nearest_recursive(size_t index, double lat, double lon, int depth, size_t k, const std::string& type,
+                                  std::vector<std::pair<double, int>>& heap) const;
+
+    // Recursive range search collecting (squared distance, index) pairs inside radius²
+    void find_within_radius_recursive(size_t index, double lat, double lon, int depth, double radius_sq, const std::string& type,
+                                      std::vector<std::pair<double, int>>& hits) const;
+
+    // True if facility i passes the type filter (an empty filter accepts everything)
+    bool matches(int i, const std::string& type) const { return type.empty() || facilities[i].type == type; }
+
     // Mathematical helper to calculate Euclidean distance (used as a heuristic)
-    double calculate_distance(double lat1, double lon1, double lat2, double lon2);
+    static double calculate_distance(double lat1, double lon1, double lat2, double lon2);
 
 public:
+    // Facilities per leaf bucket: small enough to scan linearly, large enough to keep the tree shallow
+    static const int kLeafSize = 8;
+
     // Default constructor: creates an empty tree
-    KDTree() : root(nullptr) {}
-    
-    // Public API to insert a facility into the structure
+    KDTree() = default;
+
+    // Bulk constructor: builds a balanced tree over all facilities at once
+    explicit KDTree(std::vector<Facility> list);
+
+    // Public API to insert a facility; the tree is rebuilt before the next search
     void insert(Facility f);
-    
+
     // Public API to find the closest facility to the given coordinates
     Facility find_nearest(double lat, double lon);
+
+    // Public API returning the positions of the k closest facilities, nearest first.
+    // Only facilities whose type equals 'type' are considered unless it is empty.
+    std::vector<int> find_k_nearest(double lat, double lon, size_t k, const std::string& type = "");
+
+    // Public API returning the positions of every facility within 'radius' (in coordinate
+    // degrees, the same metric as the tree), nearest first, optionally filtered by type
+    std::vector<int> find_within_radius(double lat, double lon, double radius, const std::string& type = "");
+
+    // Facility at a position returned by the queries above (valid until the next insert)
+    const Facility& facility(int index) const { return facilities[index]; }
+
+    // Number of facilities stored
+    size_t size() const { return facilities.size(); }
 };
 
 #endif // KDTREE_H
@@ -0,0 +1,53 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() : counts(bucket_of(kMaxTrackable) + 1, 0) {}
+
+/**
+ * LatencyHistogram::bucket_of
+ * Values < 64 map to themselves. For larger values, 'shift' drops all but the
+ * top six significant bits; the top bit is always set, leaving 32 distinct
+ * sub-buckets for each doubling after the first exact 64.
+ */
+size_t LatencyHistogram::bucket_of(uint64_t value) {
+    if (value < kSubBucketCount) return static_cast<size_t>(value);
+    int msb = 63;
+    while (!(value >> msb)) --msb;
+    const int shift = msb - (kSubBucketBits - 1);
+    const uint64_t sub = value >> shift; // In [32, 64)
+    return static_cast<size_t>(kSubBucketCount + (shift - 1) * kHalfCount + (sub - kHalfCount));
+}
+
+uint64_t LatencyHistogram::bucket_upper(size_t index) {
+    if (index < kSubBucketCount) return index;
+    const uint64_t offset = index - kSubBucketCount;
+    const int shift = static_cast<int>(offset / kHalfCount) + 1;
+    const uint64_t sub = offset % kHalfCount + kHalfCount;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    const uint64_t value = std::min(micros, kMaxTrackable);
+    counts[bucket_of(value)]++;
+    total++;
+    sum += static_cast<double>(value);
+    maximum = std::max(maximum, value);
+}
+
+/**
+ * LatencyHistogram::percentile
+ * Walks the counters until the running count reaches the requested rank. The
+ * answer is the bucket's upper bound, capped by the true maximum seen.
+ */
+uint64_t LatencyHistogram::percentile(double percent) const {
+    if (total == 0) return 0;
+    const double clamped = std::min(100.0, std::max(0.0, percent));
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucket_upper(i), maximum);
+    }
+    return maximum;
+}
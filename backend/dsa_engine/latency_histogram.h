@@ -0,0 +1,48 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * LatencyHistogram Class
+ * HDR-style histogram of latencies in microseconds. Values below 64 get exact
+ * buckets; above that every power of two is split into 32 linear sub-buckets, so
+ * any recorded value is known to within ~3% while the whole range up to ~12 days
+ * fits in about a thousand counters. Recording is O(1) and allocation-free, and
+ * percentiles (p50 / p99 / p99.9) are read by one pass over the counters.
+ */
+class LatencyHistogram {
+private:
+    static constexpr int kSubBucketBits = 6;                            // 64 sub-buckets per doubling...
+    static constexpr uint64_t kSubBucketCount = 1ULL << kSubBucketBits;
+    static constexpr uint64_t kHalfCount = kSubBucketCount / 2;         // ...of which the upper 32 are new
+    static constexpr uint64_t kMaxTrackable = (1ULL << 40) - 1;         // Larger values are clamped
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t maximum = 0;
+    double sum = 0;
+
+    // Counter index holding 'value'
+    static size_t bucket_of(uint64_t value);
+
+    // Largest value that maps to counter 'index' (HDR "highest equivalent value")
+    static uint64_t bucket_upper(size_t index);
+
+public:
+    LatencyHistogram();
+
+    // Adds one observation
+    void record(uint64_t micros);
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maximum; }
+    double mean() const { return total > 0 ? sum / total : 0.0; }
+
+    // Smallest bucket bound covering 'percent' % of the observations (0 if empty)
+    uint64_t percentile(double percent) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
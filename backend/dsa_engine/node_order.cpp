@@ -0,0 +1,82 @@
+#include "node_order.h"
+#include <algorithm>
+#include <numeric>
+
+namespace node_order {
+
+/**
+ * hilbert_index
+ * The classic iterative conversion: at each level, pick the quadrant's position
+ * along the curve, then rotate/flip the coordinates into that quadrant's frame.
+ */
+uint64_t hilbert_index(uint32_t x, uint32_t y, int bits) {
+    uint64_t index = 0;
+    for (uint32_t s = 1u << (bits - 1); s > 0; s >>= 1) {
+        const uint32_t rx = (x & s) ? 1 : 0;
+        const uint32_t ry = (y & s) ? 1 : 0;
+        index += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - (x & (s - 1));
+                y = s - 1 - (y & (s - 1));
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+/**
+ * hilbert_keys
+ * Quantizes both axes over the bounding box with the same scale, so the curve
+ * cells stay square on the map.
+ */
+std::vector<uint64_t> hilbert_keys(const CSRGraph& graph) {
+    const int n = graph.node_count();
+    std::vector<uint64_t> keys(n, 0);
+    if (n == 0) return keys;
+
+    double min_lat = graph.latitude(0), max_lat = min_lat;
+    double min_lon = graph.longitude(0), max_lon = min_lon;
+    for (int v = 1; v < n; ++v) {
+        min_lat = std::min(min_lat, graph.latitude(v));
+        max_lat = std::max(max_lat, graph.latitude(v));
+        min_lon = std::min(min_lon, graph.longitude(v));
+        max_lon = std::max(max_lon, graph.longitude(v));
+    }
+    const double span = std::max(max_lat - min_lat, max_lon - min_lon);
+    const double cells = static_cast<double>((1u << kHilbertBits) - 1);
+    const double scale = span > 0 ? cells / span : 0.0;
+
+    for (int v = 0; v < n; ++v) {
+        const uint32_t x = static_cast<uint32_t>((graph.longitude(v) - min_lon) * scale);
+        const uint32_t y = static_cast<uint32_t>((graph.latitude(v) - min_lat) * scale);
+        keys[v] = hilbert_index(x, y);
+    }
+    return keys;
+}
+
+std::vector<int> hilbert_order(const CSRGraph& graph) {
+    const std::vector<uint64_t> keys = hilbert_keys(graph);
+    std::vector<int> order(graph.node_count());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return keys[a] < keys[b]; });
+    return order;
+}
+
+bool is_hilbert_ordered(const CSRGraph& graph) {
+    const std::vector<uint64_t> keys = hilbert_keys(graph);
+    return std::is_sorted(keys.begin(), keys.end());
+}
+
+/**
+ * hilbert_reordered
+ * The O(V) check first, so an already ordered (possibly memory-mapped) graph
+ * is kept without copying anything.
+ */
+CSRGraph hilbert_reordered(const CSRGraph& graph) {
+    if (is_hilbert_ordered(graph)) return graph;
+    return graph.permuted(hilbert_order(graph));
+}
+
+} // namespace node_order
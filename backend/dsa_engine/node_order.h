@@ -0,0 +1,41 @@
+#ifndef NODE_ORDER_H
+#define NODE_ORDER_H
+
+#include "csr_graph.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * Node Order
+ * Cache-locality renumbering of a road network. Source data numbers
+ * intersections arbitrarily (OSM IDs, import order), so neighbors on the map
+ * end up far apart in every node and edge column and a search touches a new
+ * cache line (and page) at almost every relaxation. Sorting the nodes along a
+ * Hilbert curve over their coordinates keeps nearby intersections, and therefore
+ * the edge slices a search frontier walks, close together in memory.
+ * Only internal indices change: external Node IDs are looked up through the
+ * CSRGraph ID table, so every command's input and output is unaffected.
+ */
+namespace node_order {
+
+// Resolution of the curve: coordinates are quantized to a 2^kHilbertBits square grid
+constexpr int kHilbertBits = 16;
+
+// Position of cell (x, y) along the Hilbert curve filling the 2^bits x 2^bits grid
+uint64_t hilbert_index(uint32_t x, uint32_t y, int bits = kHilbertBits);
+
+// Curve position of every node, from its coordinates within the graph's bounding box
+std::vector<uint64_t> hilbert_keys(const CSRGraph& graph);
+
+// Internal indices sorted along the curve (ties keep their current order)
+std::vector<int> hilbert_order(const CSRGraph& graph);
+
+// True if the internal indices already follow the curve (e.g. a file written by the importer)
+bool is_hilbert_ordered(const CSRGraph& graph);
+
+// The graph renumbered along the curve; returned as is (sharing its arrays) if it already is
+CSRGraph hilbert_reordered(const CSRGraph& graph);
+
+} // namespace node_order
+
+#endif // NODE_ORDER_H
@@ -0,0 +1,189 @@
+#include "payload_parser.h"
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+// Drops spaces, tabs and line breaks at both ends of a field
+std::string_view trim(std::string_view field) {
+    const char* blanks = " \t\r\n";
+    size_t first = field.find_first_not_of(blanks);
+    if (first == std::string_view::npos) return {};
+    size_t last = field.find_last_not_of(blanks);
+    return field.substr(first, last - first + 1);
+}
+
+/**
+ * FieldCursor
+ * Walks the '|'-separated fields of one record without copying them.
+ */
+class FieldCursor {
+private:
+    std::string_view rest;
+    bool done = false;
+
+public:
+    explicit FieldCursor(std::string_view record) : rest(record) {}
+
+    // Next field, or an empty view once the record is exhausted
+    std::string_view next() {
+        if (done) return {};
+        size_t bar = rest.find('|');
+        std::string_view field = rest.substr(0, bar);
+        if (bar == std::string_view::npos) done = true;
+        else rest.remove_prefix(bar + 1);
+        return trim(field);
+    }
+};
+
+/**
+ * for_each_record
+ * Calls visit(record, index) for every non-empty ';'-separated record.
+ */
+template <typename Visit>
+void for_each_record(std::string_view payload, Visit visit) {
+    size_t index = 0;
+    size_t begin = 0;
+    while (begin <= payload.size()) {
+        size_t end = payload.find(';', begin);
+        if (end == std::string_view::npos) end = payload.size();
+        std::string_view record = trim(payload.substr(begin, end - begin));
+        if (!record.empty()) visit(record, index++);
+        begin = end + 1;
+    }
+}
+
+bool valid_coordinates(double lat, double lon) {
+    return lat >= -90.0 && lat <= 90.0 && lon >= -180.0 && lon <= 180.0;
+}
+
+// Unix time in seconds (non-negative, 0 = none)
+bool parse_time_field(std::string_view field, long long& value) {
+    field = trim(field);
+    if (field.empty()) return false;
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size() && value >= 0;
+}
+
+} // namespace
+
+void ParseReport::reject(size_t record, const char* reason) {
+    if (errors.size() < kMaxErrors) errors.push_back({record, reason});
+    malformed++;
+}
+
+bool parse_int_field(std::string_view field, int& value) {
+    field = trim(field);
+    if (field.empty()) return false;
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+bool parse_double_field(std::string_view field, double& value) {
+    field = trim(field);
+    if (field.empty()) return false;
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size() && std::isfinite(value);
+}
+
+/**
+ * parse_hazards
+ * O(payload length). Id, coordinates and severity are required; the type is optional.
+ */
+void parse_hazards(std::string_view payload, std::vector<Hazard>& out, ParseReport& report) {
+    for_each_record(payload, [&](std::string_view record, size_t index) {
+        FieldCursor fields(record);
+        Hazard h;
+        if (!parse_int_field(fields.next(), h.id)) return report.reject(index, "invalid hazard id");
+        if (!parse_double_field(fields.next(), h.latitude)) return report.reject(index, "invalid latitude");
+        if (!parse_double_field(fields.next(), h.longitude)) return report.reject(index, "invalid longitude");
+        if (!valid_coordinates(h.latitude, h.longitude)) return report.reject(index, "coordinates out of range");
+        if (!parse_int_field(fields.next(), h.severity)) return report.reject(index, "invalid severity");
+        h.type = fields.next();
+        out.push_back(std::move(h));
+        report.accepted++;
+    });
+}
+
+/**
+ * parse_hazard_updates
+ * O(payload length). The operation comes first; add / update take the same
+ * fields as parse_hazards plus an optional expiry time.
+ */
+void parse_hazard_updates(std::string_view payload, std::vector<HazardUpdate>& out, ParseReport& report) {
+    for_each_record(payload, [&](std::string_view record, size_t index) {
+        FieldCursor fields(record);
+        const std::string_view op = fields.next();
+        HazardUpdate u{HazardUpdate::Op::Clear, Hazard{0, 0, 0, 0, ""}, 0};
+        if (op == "add") u.op = HazardUpdate::Op::Add;
+        else if (op == "update") u.op = HazardUpdate::Op::Update;
+        else if (op == "remove") u.op = HazardUpdate::Op::Remove;
+        else if (op == "expire") u.op = HazardUpdate::Op::ExpireAt;
+        else if (op != "clear") return report.reject(index, "unknown operation");
+
+        if (u.op != HazardUpdate::Op::Clear && !parse_int_field(fields.next(), u.hazard.id)) {
+            return report.reject(index, "invalid hazard id");
+        }
+        if (u.op == HazardUpdate::Op::Add || u.op == HazardUpdate::Op::Update) {
+            Hazard& h = u.hazard;
+            if (!parse_double_field(fields.next(), h.latitude)) return report.reject(index, "invalid latitude");
+            if (!parse_double_field(fields.next(), h.longitude)) return report.reject(index, "invalid longitude");
+            if (!valid_coordinates(h.latitude, h.longitude)) return report.reject(index, "coordinates out of range");
+            if (!parse_int_field(fields.next(), h.severity)) return report.reject(index, "invalid severity");
+            h.type = fields.next();
+            const std::string_view expires_at = fields.next();
+            if (!expires_at.empty() && !parse_time_field(expires_at, u.expires_at)) return report.reject(index, "invalid expiry time");
+        } else if (u.op == HazardUpdate::Op::ExpireAt) {
+            if (!parse_time_field(fields.next(), u.expires_at)) return report.reject(index, "invalid expiry time");
+        }
+        out.push_back(std::move(u));
+        report.accepted++;
+    });
+}
+
+/**
+ * parse_candidates
+ * O(payload length). Name and coordinates are required; the type is optional.
+ */
+void parse_candidates(std::string_view payload, std::vector<Facility>& out, ParseReport& report,
+                      const char* default_type) {
+    for_each_record(payload, [&](std::string_view record, size_t index) {
+        FieldCursor fields(record);
+        std::string_view name = fields.next();
+        if (name.empty()) return report.reject(index, "missing name");
+        Facility f{0, std::string(name), "", 0, 0};
+        if (!parse_double_field(fields.next(), f.latitude)) return report.reject(index, "invalid latitude");
+        if (!parse_double_field(fields.next(), f.longitude)) return report.reject(index, "invalid longitude");
+        if (!valid_coordinates(f.latitude, f.longitude)) return report.reject(index, "coordinates out of range");
+        std::string_view type = fields.next();
+        f.type = type.empty() ? std::string_view(default_type) : type;
+        out.push_back(std::move(f));
+        report.accepted++;
+    });
+}
+
+bool load_payload_argument(std::string& arg, bool allow_stdin, std::string& error) {
+    if (arg == "-") {
+        if (!allow_stdin) {
+            error = "Reading a payload from stdin is only supported in one-shot mode";
+            return false;
+        }
+        std::ostringstream contents;
+        contents << std::cin.rdbuf();
+        arg = contents.str();
+        return true;
+    }
+    if (arg.size() > 1 && arg[0] == '@' && arg.find('|') == std::string::npos) {
+        std::ifstream file(arg.substr(1), std::ios::binary);
+        if (!file) {
+            error = "Cannot read payload file";
+            return false;
+        }
+        arg.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef PAYLOAD_PARSER_H
+#define PAYLOAD_PARSER_H
+
+#include "hazards.h"
+#include "kdtree.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Payload Parser
+ * Reads the record lists the Flask bridge sends with each command:
+ *   hazards:    id|lat|lon|sev|type;id|lat|lon|sev|type;...
+ *   hazard updates (streamed into a resident engine, see HazardUpdate):
+ *               add|id|lat|lon|sev|type[|expires_at]   update|id|lat|lon|sev|type[|expires_at]
+ *               remove|id   expire|id|expires_at   clear
+ *               (expires_at in Unix seconds, 0 = never)
+ *   candidates: name|lat|lon[|type];name|lat|lon[|type];...
+ * Fields are string_views into the payload and numbers are decoded with
+ * std::from_chars, so no temporary strings are built per field; only the text
+ * fields kept in the records (hazard type, facility name and type) are copied.
+ * A record that does not parse is skipped and described in a ParseReport
+ * instead of throwing, so one bad entry never fails the whole request.
+ * Empty records (e.g. a trailing ';') are ignored silently.
+ */
+
+/**
+ * ParseReport
+ * Outcome of parsing one payload: how many records were accepted, and which ones
+ * were rejected and why (the first kMaxErrors of them are described).
+ */
+struct ParseReport {
+    static const size_t kMaxErrors = 10;
+
+    struct Error {
+        size_t record;       // 0-based position of the record in the payload
+        std::string reason;  // e.g. "invalid latitude"
+    };
+
+    size_t accepted = 0;
+    size_t malformed = 0;
+    std::vector<Error> errors;
+
+    void reject(size_t record, const char* reason);
+};
+
+// Appends the hazards of 'payload' to 'out'
+void parse_hazards(std::string_view payload, std::vector<Hazard>& out, ParseReport& report);
+
+// Appends the update records of 'payload' to 'out'
+void parse_hazard_updates(std::string_view payload, std::vector<HazardUpdate>& out, ParseReport& report);
+
+// Appends the candidates of 'payload' to 'out'; entries without a type get 'default_type'
+void parse_candidates(std::string_view payload, std::vector<Facility>& out, ParseReport& report,
+                      const char* default_type = "Dynamic");
+
+// Strict number decoding of a whole field (surrounding blanks allowed). False if the
+// field is empty, has trailing garbage, or is out of range.
+bool parse_int_field(std::string_view field, int& value);
+bool parse_double_field(std::string_view field, double& value);
+
+/**
+ * load_payload_argument
+ * Large payloads need not travel inside argv (which the OS caps at a few hundred KB):
+ *   "@path"  is replaced by the contents of the file at 'path'
+ *   "-"      is replaced by everything on standard input (only if 'allow_stdin')
+ * Arguments containing '|' are record lists, never file references, and are left
+ * alone. Returns false with 'error' set if the file or stdin cannot be read.
+ */
+bool load_payload_argument(std::string& arg, bool allow_stdin, std::string& error);
+
+#endif // PAYLOAD_PARSER_H
@@ -0,0 +1,127 @@
+#include "penalty_kernel.h"
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AMAAN_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Upper bound set by force_isa(); AVX2 means "no cap"
+std::atomic<penalty_kernel::Isa> isa_cap{penalty_kernel::Isa::AVX2};
+
+/**
+ * accumulate_scalar
+ * Reference version, also used for the points left over after the last full
+ * vector. The squared-distance test skips the sqrt for hazards out of range.
+ */
+void accumulate_scalar(const double* lats, const double* lons, size_t count,
+                       const double* hazard_lats, const double* hazard_lons, const double* hazard_severities,
+                       size_t hazard_count, double radius, double* out) {
+    const double radius_sq = radius * radius;
+    for (size_t i = 0; i < count; ++i) {
+        double total = out[i];
+        for (size_t j = 0; j < hazard_count; ++j) {
+            double d_lat = lats[i] - hazard_lats[j];
+            double d_lon = lons[i] - hazard_lons[j];
+            double dist_sq = d_lat * d_lat + d_lon * d_lon;
+            if (dist_sq < radius_sq) {
+                total += hazard_severities[j] * (1.0 - (std::sqrt(dist_sq) / radius));
+            }
+        }
+        out[i] = total;
+    }
+}
+
+#ifdef AMAAN_HAVE_AVX2_KERNEL
+/**
+ * accumulate_avx2
+ * Four points per register, one hazard broadcast at a time. Lanes outside the
+ * radius are masked to a zero penalty; when all four are out of range the sqrt
+ * and division are skipped. No FMA, so the rounding matches the scalar path.
+ */
+__attribute__((target("avx2")))
+void accumulate_avx2(const double* lats, const double* lons, size_t count,
+                     const double* hazard_lats, const double* hazard_lons, const double* hazard_severities,
+                     size_t hazard_count, double radius, double* out) {
+    const __m256d radius_v = _mm256_set1_pd(radius);
+    const __m256d radius_sq = _mm256_set1_pd(radius * radius);
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d lat = _mm256_loadu_pd(lats + i);
+        const __m256d lon = _mm256_loadu_pd(lons + i);
+        __m256d total = _mm256_loadu_pd(out + i);
+        for (size_t j = 0; j < hazard_count; ++j) {
+            const __m256d d_lat = _mm256_sub_pd(lat, _mm256_set1_pd(hazard_lats[j]));
+            const __m256d d_lon = _mm256_sub_pd(lon, _mm256_set1_pd(hazard_lons[j]));
+            const __m256d dist_sq = _mm256_add_pd(_mm256_mul_pd(d_lat, d_lat), _mm256_mul_pd(d_lon, d_lon));
+            const __m256d in_range = _mm256_cmp_pd(dist_sq, radius_sq, _CMP_LT_OQ);
+            if (_mm256_movemask_pd(in_range) == 0) continue;
+
+            const __m256d decay = _mm256_sub_pd(one, _mm256_div_pd(_mm256_sqrt_pd(dist_sq), radius_v));
+            const __m256d penalty = _mm256_mul_pd(_mm256_set1_pd(hazard_severities[j]), decay);
+            total = _mm256_add_pd(total, _mm256_and_pd(in_range, penalty));
+        }
+        _mm256_storeu_pd(out + i, total);
+    }
+    accumulate_scalar(lats + i, lons + i, count - i, hazard_lats, hazard_lons, hazard_severities,
+                      hazard_count, radius, out + i);
+}
+#endif
+
+} // namespace
+
+namespace penalty_kernel {
+
+Isa detected_isa() {
+#ifdef AMAAN_HAVE_AVX2_KERNEL
+    static const Isa detected = __builtin_cpu_supports("avx2") ? Isa::AVX2 : Isa::Scalar;
+    return detected;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+Isa active_isa() {
+    const Isa detected = detected_isa();
+    return isa_cap.load() == Isa::Scalar ? Isa::Scalar : detected;
+}
+
+void force_isa(Isa isa) {
+    isa_cap.store(isa);
+}
+
+const char* isa_name(Isa isa) {
+    return isa == Isa::AVX2 ? "avx2" : "scalar";
+}
+
+void accumulate(const double* lats, const double* lons, size_t count,
+                const double* hazard_lats, const double* hazard_lons, const double* hazard_severities,
+                size_t hazard_count, double radius, double* out) {
+    accumulate(lats, lons, count, hazard_lats, hazard_lons, hazard_severities, hazard_count, radius, out, active_isa());
+}
+
+/**
+ * accumulate
+ * Dispatches to the requested version; AVX2 falls back to scalar on CPUs (or
+ * builds) without it.
+ */
+void accumulate(const double* lats, const double* lons, size_t count,
+                const double* hazard_lats, const double* hazard_lons, const double* hazard_severities,
+                size_t hazard_count, double radius, double* out, Isa isa) {
+#ifdef AMAAN_HAVE_AVX2_KERNEL
+    if (isa == Isa::AVX2 && detected_isa() == Isa::AVX2) {
+        accumulate_avx2(lats, lons, count, hazard_lats, hazard_lons, hazard_severities, hazard_count, radius, out);
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    accumulate_scalar(lats, lons, count, hazard_lats, hazard_lons, hazard_severities, hazard_count, radius, out);
+}
+
+} // namespace penalty_kernel
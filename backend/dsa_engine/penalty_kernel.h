@@ -0,0 +1,71 @@
+#ifndef PENALTY_KERNEL_H
+#define PENALTY_KERNEL_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * HazardColumns
+ * Structure-of-arrays copy of the hazard fields the penalty math needs: one
+ * contiguous column per field, so a kernel streams coordinates straight into
+ * vector registers instead of striding over Hazard records (and their strings).
+ */
+struct HazardColumns {
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<double> severities;
+
+    size_t size() const { return latitudes.size(); }
+
+    void clear() {
+        latitudes.clear();
+        longitudes.clear();
+        severities.clear();
+    }
+
+    void push_back(double latitude, double longitude, double severity) {
+        latitudes.push_back(latitude);
+        longitudes.push_back(longitude);
+        severities.push_back(severity);
+    }
+};
+
+/**
+ * Penalty Kernel
+ * The linear-decay hazard penalty (see HazardManager::get_penalty_for_location)
+ * evaluated for a block of points against a block of hazards at once.
+ * On x86-64 an AVX2 version scores four points per instruction; it is picked at
+ * run time when the CPU supports it, otherwise a scalar loop runs. Both add the
+ * hazards to each point in the same order with the same operations, so their
+ * results are bit-for-bit identical.
+ */
+namespace penalty_kernel {
+
+enum class Isa { Scalar, AVX2 };
+
+// Best instruction set this CPU supports
+Isa detected_isa();
+
+// Instruction set accumulate() uses by default: detected_isa(), unless capped by force_isa()
+Isa active_isa();
+
+// Caps the default instruction set (e.g. Isa::Scalar to benchmark the fallback)
+void force_isa(Isa isa);
+
+const char* isa_name(Isa isa);
+
+/**
+ * accumulate
+ * For every point i < count, adds the penalty of each of the 'hazard_count'
+ * hazards whose center lies within 'radius' of (lats[i], lons[i]) to out[i].
+ */
+void accumulate(const double* lats, const double* lons, size_t count,
+                const double* hazard_lats, const double* hazard_lons, const double* hazard_severities,
+                size_t hazard_count, double radius, double* out);
+void accumulate(const double* lats, const double* lons, size_t count,
+                const double* hazard_lats, const double* hazard_lons, const double* hazard_severities,
+                size_t hazard_count, double radius, double* out, Isa isa);
+
+} // namespace penalty_kernel
+
+#endif // PENALTY_KERNEL_H
@@ -0,0 +1,299 @@
+#ifndef PRIORITY_QUEUES_H
+#define PRIORITY_QUEUES_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <utility>
+#include <functional>
+
+/**
+ * Priority queues for the Dijkstra core.
+ * Every queue orders (key, node) pairs by key and offers the same interface, so
+ * the search functions are templated on the queue type:
+ *   reset(node_count)  empty the queue before a search
+ *   empty()            true when no entries are left
+ *   size()             number of entries held (stale ones included)
+ *   top()              smallest (key, node) pair
+ *   pop()              remove the smallest pair
+ *   push(node, key)    insert the node, or lower its key if the queue supports it
+ * Queues without decrease-key simply insert again; the search then skips the
+ * stale entry when it surfaces (its key is larger than the node's distance).
+ * Keys must be non-negative. The radix heap and the bucket queue additionally
+ * assume monotone keys (never below the last popped key), which holds for
+ * Dijkstra and for A* with a consistent lower bound.
+ */
+
+/**
+ * BinaryHeap
+ * Binary min-heap (std::push_heap / std::pop_heap) with lazy deletion: every relaxation adds an entry, so the
+ * heap holds one entry per successful relaxation rather than one per node.
+ */
+class BinaryHeap {
+private:
+    std::vector<std::pair<double, int>> heap; // (key, node), min-heap via std::greater
+
+public:
+    void reset(int /*node_count*/) { heap.clear(); } // Keeps the capacity for the next search
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    std::pair<double, int> top() const { return heap.front(); }
+    void pop() {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<double, int>>());
+        heap.pop_back();
+    }
+    void push(int node, double key) {
+        heap.push_back({key, node});
+        std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<double, int>>());
+    }
+};
+
+/**
+ * FourAryHeap
+ * Indexed 4-ary min-heap with decrease-key: each node appears at most once and a
+ * position table finds it in O(1). A wider fan-out halves the height compared to
+ * a binary heap and keeps each node's children in one cache line.
+ */
+class FourAryHeap {
+private:
+    std::vector<std::pair<double, int>> heap; // (key, node), heap-ordered
+    std::vector<int> position;                // Node -> slot in 'heap', -1 if not queued
+
+    void place(size_t slot, const std::pair<double, int>& entry) {
+        heap[slot] = entry;
+        position[entry.second] = static_cast<int>(slot);
+    }
+
+    void sift_up(size_t slot) {
+        std::pair<double, int> entry = heap[slot];
+        while (slot > 0) {
+            size_t parent = (slot - 1) / 4;
+            if (heap[parent].first <= entry.first) break;
+            place(slot, heap[parent]);
+            slot = parent;
+        }
+        place(slot, entry);
+    }
+
+    void sift_down(size_t slot) {
+        std::pair<double, int> entry = heap[slot];
+        const size_t size = heap.size();
+        while (true) {
+            size_t first_child = 4 * slot + 1;
+            if (first_child >= size) break;
+            size_t best = first_child;
+            size_t last_child = first_child + 4 < size ? first_child + 4 : size;
+            for (size_t c = first_child + 1; c < last_child; ++c) {
+                if (heap[c].first < heap[best].first) best = c;
+            }
+            if (heap[best].first >= entry.first) break;
+            place(slot, heap[best]);
+            slot = best;
+        }
+        place(slot, entry);
+    }
+
+public:
+    // O(entries left from the previous search), plus O(V) once when the graph size changes
+    void reset(int node_count) {
+        if (position.size() != static_cast<size_t>(node_count)) {
+            position.assign(node_count, -1);
+        } else {
+            for (const auto& entry : heap) position[entry.second] = -1;
+        }
+        heap.clear();
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    std::pair<double, int> top() const { return heap.front(); }
+
+    void pop() {
+        position[heap.front().second] = -1;
+        std::pair<double, int> last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            sift_down(0);
+        }
+    }
+
+    void push(int node, double key) {
+        int slot = position[node];
+        if (slot < 0) {
+            heap.push_back({key, node});
+            sift_up(heap.size() - 1);
+        } else if (key < heap[slot].first) {
+            heap[slot].first = key; // Decrease-key: the entry can only move up
+            sift_up(slot);
+        }
+    }
+};
+
+/**
+ * RadixHeap
+ * Monotone integer priority queue (Ahuja et al.). Keys are mapped to 64-bit
+ * integers and bucket i holds keys whose highest bit differing from the last
+ * popped key is bit i - 1, so each entry moves down at most 64 times in total.
+ * Non-negative IEEE-754 doubles compare exactly like their bit patterns read as
+ * unsigned integers, so the costs are used without any rounding.
+ */
+class RadixHeap {
+private:
+    struct Entry {
+        uint64_t bits; // Key as an integer, raised to 'last' if rounding put it below
+        double key;    // Key as pushed, which top() reports
+        int node;
+    };
+    std::vector<Entry> buckets[65];
+    uint64_t last = 0;  // Last popped key; every queued key is >= last
+    size_t count = 0;
+
+    static uint64_t to_bits(double key) {
+        if (!(key > 0)) return 0; // Also folds -0.0 into 0
+        uint64_t bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        return bits;
+    }
+    // Bucket = number of significant bits in (key XOR last)
+    int bucket_of(uint64_t key) const {
+        uint64_t diff = key ^ last;
+#if defined(__GNUC__) || defined(__clang__)
+        return diff == 0 ? 0 : 64 - __builtin_clzll(diff);
+#else
+        int bucket = 0;
+        while (diff) { diff >>= 1; ++bucket; }
+        return bucket;
+#endif
+    }
+
+    // Makes bucket 0 non-empty by redistributing the first non-empty bucket around its minimum
+    void refill() {
+        if (!buckets[0].empty()) return;
+        int i = 1;
+        while (buckets[i].empty()) ++i;
+        uint64_t minimum = buckets[i].front().bits;
+        for (const Entry& entry : buckets[i]) minimum = entry.bits < minimum ? entry.bits : minimum;
+        last = minimum;
+        for (const Entry& entry : buckets[i]) buckets[bucket_of(entry.bits)].push_back(entry);
+        buckets[i].clear();
+    }
+
+public:
+    void reset(int /*node_count*/) {
+        for (auto& bucket : buckets) bucket.clear();
+        last = 0;
+        count = 0;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    std::pair<double, int> top() {
+        refill();
+        return {buckets[0].back().key, buckets[0].back().node};
+    }
+
+    void pop() {
+        refill();
+        buckets[0].pop_back();
+        --count;
+    }
+
+    void push(int node, double key) {
+        uint64_t bits = to_bits(key);
+        // Last-ulp rounding in A* keys can dip below 'last': file such an entry in the
+        // current bucket, but keep its own key so the search does not take it for stale
+        if (bits < last) bits = last;
+        buckets[bucket_of(bits)].push_back({bits, key, node});
+        ++count;
+    }
+};
+
+/**
+ * BucketQueue
+ * Dial's algorithm: a circular array of buckets, each covering 'width' units of
+ * cost, swept in increasing order. Unlike textbook Dial, the minimum inside the
+ * current bucket is picked by a short scan, so entries leave in exact key order
+ * for any bucket width (the width only trades bucket count against scan length).
+ * The default of 0.005 cost units (5 m of plain road) keeps the swept bucket to a
+ * handful of entries on city grids. The ring doubles if a key lands beyond its span.
+ */
+class BucketQueue {
+private:
+    double width;
+    std::vector<std::vector<std::pair<double, int>>> ring; // Power-of-two number of buckets
+    long long current = 0;  // Absolute index of the bucket being swept
+    size_t count = 0;
+    long long min_slot = -1; // Position of the minimum inside the current bucket (-1 = unknown)
+
+    long long bucket_index(double key) const { return static_cast<long long>(std::floor(key / width)); }
+    std::vector<std::pair<double, int>>& bucket(long long index) { return ring[static_cast<size_t>(index) & (ring.size() - 1)]; }
+
+    void grow(long long needed_span) {
+        size_t size = ring.size();
+        while (static_cast<long long>(size) <= needed_span) size *= 2;
+        std::vector<std::vector<std::pair<double, int>>> old;
+        old.swap(ring);
+        ring.resize(size);
+        for (auto& b : old) {
+            for (const auto& entry : b) {
+                long long index = bucket_index(entry.first);
+                bucket(index < current ? current : index).push_back(entry);
+            }
+        }
+    }
+
+    // Advances to the first non-empty bucket and locates its minimum
+    void find_min() {
+        if (min_slot >= 0) return;
+        while (bucket(current).empty()) ++current;
+        auto& b = bucket(current);
+        min_slot = 0;
+        for (size_t i = 1; i < b.size(); ++i) {
+            if (b[i].first < b[min_slot].first) min_slot = static_cast<long long>(i);
+        }
+    }
+
+public:
+    explicit BucketQueue(double bucket_width = 0.005, size_t buckets = 1024) : width(bucket_width), ring(buckets) {}
+
+    void reset(int /*node_count*/) {
+        for (auto& b : ring) b.clear();
+        current = 0;
+        count = 0;
+        min_slot = -1;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    std::pair<double, int> top() {
+        find_min();
+        return bucket(current)[min_slot];
+    }
+
+    void pop() {
+        find_min();
+        auto& b = bucket(current);
+        b[min_slot] = b.back();
+        b.pop_back();
+        --count;
+        min_slot = -1;
+    }
+
+    void push(int node, double key) {
+        long long index = bucket_index(key);
+        if (index < current) index = current; // Monotone keys; see RadixHeap::push
+        if (index - current >= static_cast<long long>(ring.size())) grow(index - current);
+        auto& b = bucket(index);
+        b.push_back({key, node});
+        ++count;
+        // A new entry in the swept bucket may be its new minimum
+        if (index == current && min_slot >= 0 && key < b[min_slot].first) min_slot = static_cast<long long>(b.size() - 1);
+    }
+};
+
+#endif // PRIORITY_QUEUES_H
@@ -0,0 +1,132 @@
+#include "rcu.h"
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Slot value of a thread that is not inside a ReadGuard
+constexpr uint64_t kIdle = UINT64_MAX;
+
+/**
+ * ReaderSlot
+ * The epoch one reading thread pinned at. Padded to a cache line so readers on
+ * different cores never write to the same line.
+ */
+struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{kIdle};
+    std::atomic<bool> taken{false};
+};
+
+ReaderSlot reader_slots[rcu::kMaxReaders];
+std::atomic<uint64_t> global_epoch{1};
+
+/**
+ * Retired
+ * A replaced version waiting for its readers: freed once every slot has moved
+ * past 'epoch'.
+ */
+struct Retired {
+    uint64_t epoch;
+    void* object;
+    void (*destroy)(void*);
+};
+
+std::mutex retired_mutex; // Taken by writers only
+std::vector<Retired> retired;
+
+/**
+ * ThreadSlot
+ * The calling thread's claim on a reader slot, made on its first guard and
+ * released when the thread exits.
+ */
+struct ThreadSlot {
+    int index = -1;
+    int depth = 0; // Nesting level of ReadGuards on this thread
+
+    int claim() {
+        for (int i = 0; index < 0 && i < rcu::kMaxReaders; ++i) {
+            bool expected = false;
+            if (reader_slots[i].taken.compare_exchange_strong(expected, true)) index = i;
+        }
+        if (index < 0) throw std::runtime_error("rcu: too many concurrent reader threads");
+        return index;
+    }
+
+    ~ThreadSlot() {
+        if (index < 0) return;
+        reader_slots[index].epoch.store(kIdle);
+        reader_slots[index].taken.store(false);
+    }
+};
+
+thread_local ThreadSlot thread_slot;
+
+} // namespace
+
+namespace rcu {
+
+/**
+ * ReadGuard
+ * Announcing the epoch before any version is loaded is what makes reclamation
+ * safe: a writer that retires a version afterwards sees the announcement, and
+ * one that retired it before has already swapped in the successor.
+ */
+ReadGuard::ReadGuard() {
+    if (thread_slot.depth == 0) {
+        reader_slots[thread_slot.claim()].epoch.store(global_epoch.load());
+    }
+    thread_slot.depth++;
+}
+
+ReadGuard::~ReadGuard() {
+    if (--thread_slot.depth == 0) {
+        reader_slots[thread_slot.index].epoch.store(kIdle);
+    }
+}
+
+/**
+ * retire
+ * Tags the object with the current epoch and advances it, so readers pinning
+ * from now on are known not to hold the object.
+ */
+void retire(void* object, void (*destroy)(void*)) {
+    const uint64_t epoch = global_epoch.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex);
+        retired.push_back({epoch, object, destroy});
+    }
+    reclaim();
+}
+
+/**
+ * reclaim
+ * One scan of the reader slots gives the oldest pinned epoch; everything retired
+ * before it is unreachable. Destructors run outside the lock.
+ */
+size_t reclaim() {
+    std::vector<Retired> ready;
+    size_t remaining = 0;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex);
+        if (retired.empty()) return 0;
+        uint64_t oldest = kIdle;
+        for (const ReaderSlot& slot : reader_slots) oldest = std::min(oldest, slot.epoch.load());
+        auto still_visible = std::partition(retired.begin(), retired.end(),
+                                            [&](const Retired& r) { return r.epoch >= oldest; });
+        ready.assign(still_visible, retired.end());
+        retired.erase(still_visible, retired.end());
+        remaining = retired.size();
+    }
+    for (const Retired& r : ready) r.destroy(r.object);
+    return remaining;
+}
+
+size_t pending() {
+    std::lock_guard<std::mutex> lock(retired_mutex);
+    return retired.size();
+}
+
+} // namespace rcu
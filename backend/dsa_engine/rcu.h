@@ -0,0 +1,84 @@
+#ifndef RCU_H
+#define RCU_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * RCU (Read-Copy-Update) with epoch-based reclamation
+ * Lets many query threads read shared state while writers replace it, without
+ * readers ever taking a lock or waiting:
+ * - A writer builds a complete new immutable version off to the side and
+ *   publishes it with one atomic pointer exchange (Versioned::publish).
+ * - A reader pins the current version for the duration of a query by holding a
+ *   ReadGuard, then dereferences Versioned::get() as often as it likes.
+ * - A replaced version is retired, not deleted. It is freed once every reader
+ *   that could still hold it has dropped its guard.
+ *
+ * Reclamation uses a global epoch counter. Each reading thread owns a slot in a
+ * fixed table and announces the epoch it pinned at. A version retired at epoch
+ * E is unreachable for any reader pinned after E, so it can be freed as soon as
+ * no slot announces an epoch <= E. Only writers touch the (mutex-protected)
+ * retired list; a reader does one atomic load and two stores per guard.
+ */
+namespace rcu {
+
+// Reading threads that can hold a guard at the same time (slots are reused on thread exit)
+constexpr int kMaxReaders = 256;
+
+/**
+ * ReadGuard
+ * Pins the calling thread's view: versions loaded while the guard lives stay
+ * valid until it is destroyed. Guards nest; only the outermost one pins.
+ */
+class ReadGuard {
+public:
+    ReadGuard();
+    ~ReadGuard();
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+};
+
+// Hands 'object' to the reclaimer: 'destroy(object)' runs once no reader can see it
+void retire(void* object, void (*destroy)(void*));
+
+// Frees every retired object no pinned reader can still see; returns how many remain
+size_t reclaim();
+
+// Retired objects still waiting for readers to move on
+size_t pending();
+
+/**
+ * Versioned<T>
+ * An atomically replaceable pointer to an immutable T.
+ */
+template <typename T>
+class Versioned {
+private:
+    std::atomic<const T*> current{nullptr};
+
+public:
+    Versioned() = default;
+    Versioned(const Versioned&) = delete;
+    Versioned& operator=(const Versioned&) = delete;
+
+    // Only safe once no reader can be running (e.g. at process exit)
+    ~Versioned() { delete current.load(); }
+
+    // The current version; the caller must hold a ReadGuard for as long as it uses it.
+    // A writer serialized against other writers may also read without a guard.
+    const T* get() const { return current.load(); }
+
+    // Makes 'next' the current version and retires the previous one
+    void publish(std::unique_ptr<const T> next) {
+        const T* previous = current.exchange(next.release());
+        if (previous) {
+            retire(const_cast<T*>(previous), [](void* object) { delete static_cast<const T*>(object); });
+        }
+    }
+};
+
+} // namespace rcu
+
+#endif // RCU_H
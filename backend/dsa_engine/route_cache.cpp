@@ -0,0 +1,145 @@
+#include "route_cache.h"
+#include "geo.h"
+#include <algorithm>
+
+namespace {
+
+// Km per coordinate degree (exact for latitude, an upper bound for longitude),
+// with 1% slack so the lower bound test is safe against rounding
+const double kKmPerDegree = geo::kEarthRadiusKm * geo::kDegToRad * 1.01;
+
+} // namespace
+
+/**
+ * touches_path
+ * Mirrors WeightOverlay::rebuild: an edge is penalized exactly when one of its
+ * endpoints lies strictly inside a hazard's radius, so the path is affected iff
+ * one of its nodes does. The bounding box rejects most hazards in O(1).
+ */
+bool RouteCache::touches_path(const Entry& entry, const Hazard& h) {
+    const double r = HazardManager::kInfluenceRadius;
+    if (h.latitude < entry.min_lat - r || h.latitude > entry.max_lat + r ||
+        h.longitude < entry.min_lon - r || h.longitude > entry.max_lon + r) {
+        return false;
+    }
+    for (size_t i = 0; i < entry.lats.size(); ++i) {
+        double d_lat = entry.lats[i] - h.latitude;
+        double d_lon = entry.lons[i] - h.longitude;
+        if (d_lat * d_lat + d_lon * d_lon < r * r) return true;
+    }
+    return false;
+}
+
+/**
+ * survives
+ * Applies the rules from the class comment to every change since the entry's epoch.
+ * A changed hazard counts as its old version removed plus its new version added.
+ */
+bool RouteCache::survives(const CSRGraph& graph, const Entry& entry) const {
+    if (!entry.result.success) return true; // Reachability does not depend on hazards
+
+    double scale = -1; // Looked up on first use
+    const double radius_km = HazardManager::kInfluenceRadius * kKmPerDegree;
+    // Any route helped by an eased hazard passes within radius_km of its center
+    auto detour_is_worse = [&](const Hazard& h) {
+        if (entry.key.mode == CostModel::Eta) return true; // Travel-time routes ignore hazards
+        if (scale < 0) scale = Dijkstra::lower_bound_scale(graph, entry.key.mode);
+        if (scale <= 0) return false;
+        double to_zone = geo::haversine_km(entry.lats.front(), entry.lons.front(), h.latitude, h.longitude) - radius_km;
+        double from_zone = geo::haversine_km(h.latitude, h.longitude, entry.lats.back(), entry.lons.back()) - radius_km;
+        return scale * (std::max(0.0, to_zone) + std::max(0.0, from_zone)) >= entry.result.total_cost;
+    };
+
+    for (const HazardChange& c : changes) {
+        // Renames and reclassifications do not move any penalty
+        if (c.has_before && c.has_after && c.before.latitude == c.after.latitude &&
+            c.before.longitude == c.after.longitude && c.before.severity == c.after.severity) {
+            continue;
+        }
+        if (c.has_before && touches_path(entry, c.before)) return false;
+        if (c.has_after && touches_path(entry, c.after)) return false;
+
+        // Roads get cheaper when a hazard with severity > 0 goes away or one with severity <= 0 arrives
+        if (c.has_before && c.before.severity > 0 && !detour_is_worse(c.before)) return false;
+        if (c.has_after && c.after.severity <= 0 && !detour_is_worse(c.after)) return false;
+    }
+    return true;
+}
+
+/**
+ * lookup
+ * O(1) hash probe, plus O(changes x path length) when the hazard epoch moved
+ * since the entry was last validated.
+ */
+const PathResult* RouteCache::lookup(const CSRGraph& graph, const HazardManager& hazards, const Key& key) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        counters.misses++;
+        return nullptr;
+    }
+    Entry& entry = *it->second;
+
+    // Stored by a concurrent query that already saw newer hazards than the caller's snapshot
+    if (entry.epoch > hazards.get_epoch()) {
+        counters.misses++;
+        return nullptr;
+    }
+    if (entry.epoch != hazards.get_epoch()) {
+        changes.clear();
+        if (!hazards.changes_since(entry.epoch, changes) || !survives(graph, entry)) {
+            lru.erase(it->second);
+            index.erase(it);
+            counters.invalidated++;
+            counters.misses++;
+            return nullptr;
+        }
+        entry.epoch = hazards.get_epoch();
+    }
+
+    lru.splice(lru.begin(), lru, it->second); // Mark as most recently used
+    counters.hits++;
+    return &entry.result;
+}
+
+/**
+ * store
+ * Inserts (or replaces) the entry at the front of the LRU list, evicting the
+ * least recently used one when full.
+ */
+void RouteCache::store(const CSRGraph& graph, unsigned long long epoch, const Key& key, const PathResult& result) {
+    if (capacity == 0) return;
+    auto it = index.find(key);
+    if (it != index.end()) {
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    Entry entry{key, result, epoch, {}, {}, 0, 0, 0, 0};
+    entry.result.stats = SearchStats(); // A cache hit does no search work
+    for (int id : result.path) {
+        int v = graph.index_of(id);
+        entry.lats.push_back(graph.latitude(v));
+        entry.lons.push_back(graph.longitude(v));
+    }
+    if (!entry.lats.empty()) {
+        auto lat_range = std::minmax_element(entry.lats.begin(), entry.lats.end());
+        auto lon_range = std::minmax_element(entry.lons.begin(), entry.lons.end());
+        entry.min_lat = *lat_range.first;
+        entry.max_lat = *lat_range.second;
+        entry.min_lon = *lon_range.first;
+        entry.max_lon = *lon_range.second;
+    }
+
+    lru.push_front(std::move(entry));
+    index[key] = lru.begin();
+    if (lru.size() > capacity) {
+        index.erase(lru.back().key);
+        lru.pop_back();
+        counters.evictions++;
+    }
+}
+
+void RouteCache::clear() {
+    lru.clear();
+    index.clear();
+}
@@ -0,0 +1,98 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include "csr_graph.h"
+#include "hazards.h"
+#include "dijkstra.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+/**
+ * RouteCache Class
+ * LRU cache of route results keyed by (start, end, cost model, search). Each entry also
+ * remembers the hazard epoch it is known to be optimal for. When the epoch has
+ * moved, the entry is checked lazily against the HazardManager changelog instead
+ * of being thrown away:
+ * - A hazard whose zone of influence touches a node of the cached path changes
+ *   the path's own cost or safety score, so the entry is dropped.
+ * - A hazard added (or made worse) away from the path only makes other routes
+ *   more expensive, so the cached route stays optimal.
+ * - A hazard removed (or eased) away from the path can only help routes passing
+ *   through its zone. The entry survives if even the geographic lower bound of
+ *   such a detour (Dijkstra::lower_bound_scale) costs at least as much as the
+ *   cached route.
+ * Unreachable pairs are cached too: hazards never add or remove roads.
+ */
+class RouteCache {
+public:
+    // Lifetime counters, reported by the serve-mode "stats" command
+    struct Counters {
+        uint64_t hits = 0;         // Lookups answered from the cache
+        uint64_t misses = 0;       // Lookups with no entry for the key
+        uint64_t invalidated = 0;  // Entries dropped because a hazard change affected them
+        uint64_t evictions = 0;    // Entries dropped to stay within capacity
+    };
+
+    // What a cached result answers: the endpoints, the cost model and the search that
+    // found the route. Searches agree on the optimal cost but may pick different routes
+    // of that cost, so each gets its own entry and a hit reports the search it asked for.
+    struct Key {
+        int start;
+        int end;
+        CostModel mode;
+        SearchAlgorithm algorithm = SearchAlgorithm::Dijkstra;
+        bool hierarchy = false; // Answered by the contraction hierarchy ('algorithm' unused)
+        bool operator==(const Key& other) const {
+            return start == other.start && end == other.end && mode == other.mode &&
+                   algorithm == other.algorithm && hierarchy == other.hierarchy;
+        }
+    };
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint64_t packed = (static_cast<uint64_t>(static_cast<uint32_t>(k.start)) << 32) | static_cast<uint32_t>(k.end);
+            uint64_t search = static_cast<uint64_t>(k.mode) * 8 + static_cast<uint64_t>(k.algorithm) * 2 + k.hierarchy;
+            return std::hash<uint64_t>()(packed * 31 + search);
+        }
+    };
+    struct Entry {
+        Key key;
+        PathResult result;
+        unsigned long long epoch;            // Hazard epoch the result is known to be valid for
+        std::vector<double> lats, lons;      // Coordinates of the path nodes, in path order
+        double min_lat, max_lat, min_lon, max_lon; // Bounding box of the path
+    };
+
+    size_t capacity;
+    std::list<Entry> lru;  // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    Counters counters;
+    std::vector<HazardChange> changes; // Scratch for changelog reads
+
+    // True if hazard 'h' penalizes any node of the entry's path
+    static bool touches_path(const Entry& entry, const Hazard& h);
+    // True if every change in 'changes' leaves the entry's route optimal and its summary exact
+    bool survives(const CSRGraph& graph, const Entry& entry) const;
+
+public:
+    explicit RouteCache(size_t max_entries = 4096) : capacity(max_entries) {}
+
+    // The cached result for 'key' if it is still valid under the current hazards,
+    // otherwise nullptr. Valid entries are moved to the front of the LRU list.
+    const PathResult* lookup(const CSRGraph& graph, const HazardManager& hazards, const Key& key);
+
+    // Remembers a result computed against 'graph' while the hazards were at 'epoch'.
+    // Its search stats are dropped: a hit does no search work.
+    void store(const CSRGraph& graph, unsigned long long epoch, const Key& key, const PathResult& result);
+
+    // Drops every entry (e.g. when the road network is replaced)
+    void clear();
+
+    size_t size() const { return lru.size(); }
+    const Counters& stats() const { return counters; }
+};
+
+#endif // ROUTE_CACHE_H
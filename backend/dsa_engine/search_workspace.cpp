@@ -0,0 +1,43 @@
+#include "search_workspace.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+std::atomic<uint64_t> allocation_count(0);
+}
+
+/**
+ * SearchWorkspace::begin
+ * Bumping the generation invalidates every entry at once. The arrays are only
+ * touched when they must grow/shrink to a new graph size, or once every 2^32
+ * searches when the counter wraps and old stamps could be mistaken for new ones.
+ */
+void SearchWorkspace::begin(int node_count) {
+    const size_t n = static_cast<size_t>(node_count);
+    if (stamps.size() != n) {
+        distances.assign(n, kUnreached);
+        parent_edges.assign(n, -1);
+        aux_values.assign(n, 0.0);
+        stamps.assign(n, 0);
+        generation = 0;
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (++generation == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+}
+
+/**
+ * SearchWorkspace::local
+ * Lazily created per-thread workspaces; they live as long as the thread and
+ * keep their capacity between queries.
+ */
+SearchWorkspace& SearchWorkspace::local(int slot) {
+    thread_local SearchWorkspace workspaces[2];
+    return workspaces[slot];
+}
+
+uint64_t SearchWorkspace::allocations() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,64 @@
+#ifndef SEARCH_WORKSPACE_H
+#define SEARCH_WORKSPACE_H
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * SearchWorkspace Class
+ * Reusable per-node scratch arrays for one graph search: tentative distance,
+ * the edge the node was reached through, and one auxiliary value (e.g. the A*
+ * lower bound). Instead of refilling the arrays before every query, each entry
+ * carries the generation that last wrote it; entries from older generations
+ * read as "not reached". Starting a new search is therefore O(1), so a query
+ * between two neighbors no longer pays O(V) just to initialize.
+ *
+ * A workspace must not be shared by two searches running at the same time;
+ * use SearchWorkspace::local() to get one owned by the calling thread. Those
+ * only pay off on threads that outlive a query (serve workers, WorkerPool
+ * helpers): a thread started per call allocates O(V) again every time.
+ */
+class SearchWorkspace {
+private:
+    std::vector<double> distances;  // Tentative cost per node (valid if stamped)
+    std::vector<int> parent_edges;  // CSR edge the node was reached through (-1 at the origin)
+    std::vector<double> aux_values; // Free per-node slot for the search (valid if stamped)
+    std::vector<uint32_t> stamps;   // Generation that last wrote each node
+    uint32_t generation = 0;        // Current search; 0 is never a live generation
+
+public:
+    static constexpr double kUnreached = 1e18;
+
+    // Starts a new search over a graph with 'node_count' nodes. O(1), except when the
+    // graph size changes or the generation counter wraps (then O(V) once).
+    void begin(int node_count);
+
+    // True if node v has been written during the current search
+    bool reached(int v) const { return stamps[v] == generation; }
+
+    // Tentative cost of v, or kUnreached
+    double distance(int v) const { return reached(v) ? distances[v] : kUnreached; }
+
+    // Edge through which v was reached, or -1 (origin or not reached)
+    int parent_edge(int v) const { return reached(v) ? parent_edges[v] : -1; }
+
+    // Records a (better) cost for v and the edge it came through
+    void set(int v, double distance, int parent_edge) {
+        stamps[v] = generation;
+        distances[v] = distance;
+        parent_edges[v] = parent_edge;
+    }
+
+    // Auxiliary value of v; only meaningful once v is reached in this search
+    double& aux(int v) { return aux_values[v]; }
+
+    // Workspace owned by the calling thread. 'slot' selects an independent one,
+    // so a search needing two (forward + backward) can hold both at once.
+    static SearchWorkspace& local(int slot = 0);
+
+    // Times any workspace had to (re)allocate its arrays, process-wide. Stays flat
+    // while long-lived threads keep searching the same graph.
+    static uint64_t allocations();
+};
+
+#endif // SEARCH_WORKSPACE_H
@@ -0,0 +1,157 @@
+/**
+ * cost_models: every route mode (standard, eta, night, vulnerable) against a
+ * reference search over the policy's own edge costs, for every search variant,
+ * plus the lower bounds A* relies on and their upkeep per graph.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../cost_policies.h"
+#include "../dijkstra.h"
+#include "../geo.h"
+#include "../hazards.h"
+
+namespace {
+
+const CostModel kModels[] = {CostModel::Standard, CostModel::Eta, CostModel::Night, CostModel::Vulnerable};
+const SearchAlgorithm kAlgorithms[] = {SearchAlgorithm::Dijkstra, SearchAlgorithm::AStar, SearchAlgorithm::Bidirectional};
+
+// The policy's routing cost as an EdgeCost
+template <typename Policy>
+fixtures::EdgeCost policy_cost(const CSRGraph& graph, const WeightOverlay* overlay) {
+    return [&graph, overlay](int e) { return Policy::cost(graph, overlay, e); };
+}
+
+fixtures::EdgeCost model_cost(const CSRGraph& graph, const WeightOverlay* overlay, CostModel mode) {
+    switch (mode) {
+        case CostModel::Eta: return policy_cost<EtaCost>(graph, overlay);
+        case CostModel::Night: return policy_cost<NightCost>(graph, overlay);
+        case CostModel::Vulnerable: return policy_cost<VulnerableCost>(graph, overlay);
+        default: return policy_cost<StandardCost>(graph, overlay);
+    }
+}
+
+// The policy's cost without the overlay, which must never exceed its cost with it
+template <typename Policy>
+int base_above_cost(const CSRGraph& graph, const WeightOverlay* overlay) {
+    int violations = 0;
+    for (int e = 0; e < graph.edge_count(); ++e) violations += Policy::base(graph, e) > Policy::cost(graph, overlay, e) + 1e-12;
+    return violations;
+}
+
+// The small city with every road 'factor' times as long
+CSRGraph stretched_city(double factor) {
+    const CSRGraph city(fixtures::small_city());
+    Graph g;
+    for (int v = 0; v < city.node_count(); ++v) g.add_node(city.node_id(v), city.latitude(v), city.longitude(v));
+    for (int e = 0; e < city.edge_count(); ++e) {
+        g.add_one_way_edge(city.node_id(city.edge_source(e)), city.node_id(city.edge_target(e)),
+                           factor * city.edge_length(e), city.edge_hazard(e), factor * edge_safety_bonus(city, e));
+    }
+    return CSRGraph(g);
+}
+
+// Smallest ratio of the policy's static cost to straight-line length, by a direct scan
+template <typename Policy>
+double scanned_scale(const CSRGraph& graph) {
+    double scale = 1e18;
+    for (int e = 0; e < graph.edge_count(); ++e) {
+        const int u = graph.edge_source(e), v = graph.edge_target(e);
+        const double straight = geo::haversine_km(graph.latitude(u), graph.longitude(u), graph.latitude(v), graph.longitude(v));
+        if (straight > 0) scale = std::min(scale, std::max(0.0, Policy::base(graph, e)) / straight);
+    }
+    return scale;
+}
+
+} // namespace
+
+TEST(cost_models, small_city_modes) {
+    const CSRGraph city(fixtures::small_city());
+    auto route = [&](int s, int t, CostModel mode) {
+        return Dijkstra::find_safest_path(city, s, t, nullptr, SearchAlgorithm::Dijkstra, QueueType::BinaryHeap, mode);
+    };
+
+    // Length alone: straight along the south row, and the one-way shortcut back
+    PathResult r = route(1, 4, CostModel::Eta);
+    CHECK_EQ(r.path, (std::vector<int>{1, 2, 3, 4}));
+    CHECK_NEAR(r.total_cost, 3.0, 1e-12);
+    CHECK_NEAR(route(4, 1, CostModel::Eta).total_cost, 2.5, 1e-12);
+
+    // At night the static hazard on 2-3 weighs 15: the north detour wins as in standard mode
+    r = route(1, 4, CostModel::Night);
+    CHECK_EQ(r.path, (std::vector<int>{1, 2, 6, 7, 3, 4}));
+    CHECK_NEAR(r.total_cost, 5.1, 1e-12);
+
+    // The 0.5 bonus counts three times, flooring 6-7 at a tenth of its length
+    r = route(1, 4, CostModel::Vulnerable);
+    CHECK_EQ(r.path, (std::vector<int>{1, 2, 6, 7, 3, 4}));
+    CHECK_NEAR(r.total_cost, 1.0 + 1.2 + 0.12 + 1.2 + 1.0, 1e-12);
+}
+
+TEST(cost_models, every_mode_matches_reference) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Geometric, 2500, 111);
+    HazardManager hazards;
+    hazards.replace_all(synthetic::make_hazards(city, 30, 112));
+    WeightOverlay overlay;
+    overlay.rebuild(city, hazards);
+
+    for (CostModel mode : kModels) {
+        const fixtures::EdgeCost cost = model_cost(city, &overlay, mode);
+        for (const auto& [s, t] : fixtures::random_pairs(city, 25, 113)) {
+            const double expected = fixtures::reference_costs(city, city.index_of(s), cost)[city.index_of(t)];
+            for (SearchAlgorithm algorithm : kAlgorithms) {
+                for (QueueType queue : {QueueType::BinaryHeap, QueueType::RadixHeap}) {
+                    const PathResult r = Dijkstra::find_safest_path(city, s, t, &overlay, algorithm, queue, mode);
+                    CHECK_EQ(r.success, expected != fixtures::kUnreachable);
+                    if (!r.success) continue;
+                    CHECK_NEAR(r.total_cost, expected, 1e-9);
+                    CHECK_NEAR(fixtures::route_cost(city, r.path, cost), r.total_cost, 1e-9);
+                }
+            }
+        }
+    }
+}
+
+TEST(cost_models, lower_bounds_hold) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Grid, 2000, 114);
+    HazardManager hazards;
+    hazards.replace_all(synthetic::make_hazards(city, 30, 115));
+    WeightOverlay overlay;
+    overlay.rebuild(city, hazards);
+
+    CHECK_EQ(base_above_cost<StandardCost>(city, &overlay), 0);
+    CHECK_EQ(base_above_cost<EtaCost>(city, &overlay), 0);
+    CHECK_EQ(base_above_cost<NightCost>(city, &overlay), 0);
+    CHECK_EQ(base_above_cost<VulnerableCost>(city, &overlay), 0);
+
+    // Scaled straight-line distance never exceeds the cheapest route, in any mode
+    for (CostModel mode : kModels) {
+        const double scale = Dijkstra::lower_bound_scale(city, mode);
+        CHECK(scale >= 0);
+        for (const auto& [s, t] : fixtures::random_pairs(city, 20, 116)) {
+            const int u = city.index_of(s), v = city.index_of(t);
+            const double best = fixtures::reference_costs(city, u, model_cost(city, &overlay, mode))[v];
+            if (best == fixtures::kUnreachable) continue;
+            const double bound = scale * geo::haversine_km(city.latitude(u), city.longitude(u), city.latitude(v), city.longitude(v));
+            CHECK(bound <= best + 1e-9);
+        }
+    }
+}
+
+TEST(cost_models, lower_bounds_follow_each_graph) {
+    // Graphs of one shape built one after another (often at the same addresses) keep their own scales
+    for (double factor : {1.0, 0.5, 2.0, 0.25, 1.0, 4.0}) {
+        const CSRGraph city = stretched_city(factor);
+        CHECK_NEAR(Dijkstra::lower_bound_scale(city, CostModel::Eta), scanned_scale<EtaCost>(city), 1e-12);
+        CHECK_NEAR(Dijkstra::lower_bound_scale(city, CostModel::Night), scanned_scale<NightCost>(city), 1e-12);
+        CHECK_NEAR(Dijkstra::lower_bound_scale(city, CostModel::Vulnerable), scanned_scale<VulnerableCost>(city), 1e-12);
+        CHECK_EQ(Dijkstra::lower_bound_scale(city, CostModel::Standard), city.heuristic_scale());
+
+        // Copies share the graph's columns and its scales
+        const CSRGraph copy = city;
+        CHECK_EQ(Dijkstra::lower_bound_scale(copy, CostModel::Eta), Dijkstra::lower_bound_scale(city, CostModel::Eta));
+        const PathResult r = Dijkstra::find_safest_path(copy, 1, 4, nullptr, SearchAlgorithm::AStar,
+                                                        QueueType::BinaryHeap, CostModel::Eta);
+        CHECK_NEAR(r.total_cost, 3.0 * factor, 1e-9);
+    }
+}
@@ -0,0 +1,241 @@
+/**
+ * graph: the CSR form against the adjacency-list Graph it is compiled from,
+ * CSR Dijkstra against a textbook search over the adjacency lists, Hilbert
+ * renumbering, and the binary graph file format.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../dijkstra.h"
+#include "../graph_file.h"
+#include "../node_order.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+// Every column of 'a' equals the same column of 'b'
+int column_mismatches(const CSRGraph& a, const CSRGraph& b) {
+    if (a.node_count() != b.node_count() || a.edge_count() != b.edge_count()) return -1;
+    int mismatches = a.heuristic_scale() != b.heuristic_scale();
+    for (int v = 0; v < a.node_count(); ++v) {
+        mismatches += a.node_id(v) != b.node_id(v) || a.latitude(v) != b.latitude(v) ||
+                      a.longitude(v) != b.longitude(v) || a.node_name(v) != b.node_name(v) ||
+                      a.edge_begin(v) != b.edge_begin(v) || a.in_edge_begin(v) != b.in_edge_begin(v) ||
+                      a.index_of(a.node_id(v)) != b.index_of(a.node_id(v));
+    }
+    for (int e = 0; e < a.edge_count(); ++e) {
+        mismatches += a.edge_source(e) != b.edge_source(e) || a.edge_target(e) != b.edge_target(e) ||
+                      a.edge_weight(e) != b.edge_weight(e) || a.edge_length(e) != b.edge_length(e) ||
+                      a.edge_hazard(e) != b.edge_hazard(e) || a.in_edge(e) != b.in_edge(e);
+    }
+    return mismatches;
+}
+
+// Each node's outgoing roads as (target ID, weight, length), by external ID
+std::vector<std::tuple<int, double, double>> roads_of(const CSRGraph& graph, int node_id) {
+    std::vector<std::tuple<int, double, double>> roads;
+    const int v = graph.index_of(node_id);
+    for (int e = graph.edge_begin(v); e < graph.edge_end(v); ++e) {
+        roads.emplace_back(graph.node_id(graph.edge_target(e)), graph.edge_weight(e), graph.edge_length(e));
+    }
+    std::sort(roads.begin(), roads.end());
+    return roads;
+}
+
+// True if loading 'path' is refused with an error
+bool load_fails(const std::string& path) {
+    try {
+        GraphFile::load(path);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(graph, csr_matches_adjacency_lists) {
+    const Graph g = fixtures::small_city();
+    const CSRGraph csr(g);
+    CHECK_EQ(csr.node_count(), 9);
+    CHECK_EQ(csr.edge_count(), 21);
+    CHECK_EQ(csr.index_of(42), -1);
+
+    for (int id : g.get_all_node_ids()) {
+        const int v = csr.index_of(id);
+        REQUIRE(v >= 0);
+        CHECK_EQ(csr.node_id(v), id);
+        CHECK_EQ(csr.latitude(v), g.get_node(id).latitude);
+        CHECK_EQ(csr.longitude(v), g.get_node(id).longitude);
+        CHECK_EQ(csr.node_name(v), g.get_node(id).name);
+
+        const std::vector<Edge>& edges = g.get_neighbors(id);
+        REQUIRE(csr.edge_end(v) - csr.edge_begin(v) == static_cast<int>(edges.size()));
+        for (size_t i = 0; i < edges.size(); ++i) {
+            const int e = csr.edge_begin(v) + static_cast<int>(i);
+            CHECK_EQ(csr.edge_source(e), v);
+            CHECK_EQ(csr.node_id(csr.edge_target(e)), edges[i].destination_id);
+            CHECK_EQ(csr.edge_weight(e), edges[i].get_weight());
+            CHECK_EQ(csr.edge_length(e), edges[i].distance);
+            CHECK_EQ(csr.edge_hazard(e), edges[i].hazard_penalty);
+        }
+    }
+
+    // Every edge appears exactly once among the incoming edges of its target
+    std::vector<int> seen(csr.edge_count(), 0);
+    for (int v = 0; v < csr.node_count(); ++v) {
+        for (int i = csr.in_edge_begin(v); i < csr.in_edge_end(v); ++i) {
+            CHECK_EQ(csr.edge_target(csr.in_edge(i)), v);
+            seen[csr.in_edge(i)]++;
+        }
+    }
+    CHECK_EQ(seen, std::vector<int>(csr.edge_count(), 1));
+}
+
+TEST(graph, small_city_routes) {
+    const CSRGraph csr(fixtures::small_city());
+
+    PathResult r = Dijkstra::find_safest_path(csr, 1, 4);
+    REQUIRE(r.success);
+    CHECK_EQ(r.path, (std::vector<int>{1, 2, 6, 7, 3, 4}));
+    CHECK_NEAR(r.total_cost, 5.1, 1e-12);
+    CHECK_NEAR(r.total_distance, 5.6, 1e-12);
+
+    r = Dijkstra::find_safest_path(csr, 4, 1);
+    REQUIRE(r.success);
+    CHECK_EQ(r.path, (std::vector<int>{4, 3, 7, 6, 2, 1}));
+    CHECK_NEAR(r.total_cost, 4.6, 1e-12);
+    CHECK_NEAR(r.total_distance, 5.1, 1e-12);
+
+    r = Dijkstra::find_safest_path(csr, 2, 2);
+    CHECK(r.success);
+    CHECK_EQ(r.path, std::vector<int>{2});
+    CHECK_EQ(r.total_cost, 0.0);
+
+    CHECK(!Dijkstra::find_safest_path(csr, 1, 9).success);
+    CHECK(!Dijkstra::find_safest_path(csr, 9, 1).success);
+    CHECK(!Dijkstra::find_safest_path(csr, 1, 42).success);
+}
+
+TEST(graph, csr_dijkstra_matches_reference) {
+    for (synthetic::CityKind kind : {synthetic::CityKind::Grid, synthetic::CityKind::Geometric}) {
+        const Graph g = fixtures::to_graph(synthetic::make_city(kind, 1500, 11));
+        const CSRGraph csr(g);
+        for (const auto& [s, t] : fixtures::random_pairs(csr, 60, 12)) {
+            const double expected = fixtures::reference_cost(g, s, t);
+            const PathResult r = Dijkstra::find_safest_path(g, s, t);
+            CHECK_EQ(r.success, expected != fixtures::kUnreachable);
+            if (!r.success) continue;
+            CHECK_NEAR(r.total_cost, expected, 1e-9);
+            CHECK_NEAR(fixtures::route_cost(csr, r.path, fixtures::standard_cost(csr, nullptr)), r.total_cost, 1e-9);
+            CHECK_EQ(r.path.front(), s);
+            CHECK_EQ(r.path.back(), t);
+        }
+    }
+}
+
+TEST(graph, hilbert_curve_visits_each_cell_once) {
+    const int bits = 4, side = 1 << bits;
+    std::vector<std::pair<int, int>> cell_at(side * side, {-1, -1});
+    for (int x = 0; x < side; ++x) {
+        for (int y = 0; y < side; ++y) {
+            const uint64_t d = node_order::hilbert_index(x, y, bits);
+            REQUIRE(d < cell_at.size());
+            CHECK_EQ(cell_at[d].first, -1);
+            cell_at[d] = {x, y};
+        }
+    }
+    // Consecutive curve positions are neighbouring cells, starting in a corner
+    CHECK_EQ(node_order::hilbert_index(0, 0, bits), uint64_t(0));
+    int jumps = 0;
+    for (size_t d = 1; d < cell_at.size(); ++d) {
+        jumps += std::abs(cell_at[d].first - cell_at[d - 1].first) + std::abs(cell_at[d].second - cell_at[d - 1].second) != 1;
+    }
+    CHECK_EQ(jumps, 0);
+}
+
+TEST(graph, hilbert_renumbering_keeps_the_network) {
+    for (synthetic::CityKind kind : {synthetic::CityKind::Grid, synthetic::CityKind::Geometric}) {
+        // Scramble the internal order, as arbitrary source numbering would
+        const CSRGraph city = synthetic::make_city(kind, 2000, 16);
+        std::vector<int> scramble(city.node_count());
+        for (int v = 0; v < city.node_count(); ++v) scramble[v] = v;
+        std::shuffle(scramble.begin(), scramble.end(), std::mt19937(17));
+        const CSRGraph scrambled = city.permuted(scramble);
+        CHECK(!node_order::is_hilbert_ordered(scrambled));
+
+        const CSRGraph ordered = node_order::hilbert_reordered(scrambled);
+        REQUIRE(ordered.node_count() == scrambled.node_count() && ordered.edge_count() == scrambled.edge_count());
+        CHECK(node_order::is_hilbert_ordered(ordered));
+        const std::vector<uint64_t> keys = node_order::hilbert_keys(ordered);
+        CHECK(std::is_sorted(keys.begin(), keys.end()));
+
+        // Same IDs, coordinates and roads; only internal indices moved
+        int mismatches = 0;
+        for (int v = 0; v < scrambled.node_count(); ++v) {
+            const int id = scrambled.node_id(v), w = ordered.index_of(id);
+            mismatches += w < 0 || ordered.latitude(w) != scrambled.latitude(v) ||
+                          ordered.longitude(w) != scrambled.longitude(v) || roads_of(ordered, id) != roads_of(scrambled, id);
+        }
+        CHECK_EQ(mismatches, 0);
+        for (const auto& [s, t] : fixtures::random_pairs(scrambled, 40, 18)) {
+            const PathResult before = Dijkstra::find_safest_path(scrambled, s, t);
+            const PathResult after = Dijkstra::find_safest_path(ordered, s, t);
+            CHECK_EQ(after.success, before.success);
+            CHECK_NEAR(after.total_cost, before.total_cost, 1e-9);
+        }
+
+        // An ordered graph is returned as is, sharing its columns
+        CHECK(node_order::hilbert_reordered(ordered).columns().node_ids == ordered.columns().node_ids);
+    }
+}
+
+TEST(graph, file_round_trip) {
+    const char* path = "amaan_tests_round_trip.amgr";
+    for (const CSRGraph& original : {CSRGraph(fixtures::small_city()),
+                                     synthetic::make_city(synthetic::CityKind::Geometric, 2000, 13)}) {
+        GraphFile::write(original, path);
+        {
+            const CSRGraph loaded = GraphFile::load(path);
+            CHECK_EQ(column_mismatches(loaded, original), 0);
+            for (const auto& [s, t] : fixtures::random_pairs(original, 20, 14)) {
+                CHECK_EQ(Dijkstra::find_safest_path(loaded, s, t).path, Dijkstra::find_safest_path(original, s, t).path);
+            }
+        }
+        std::remove(path);
+    }
+}
+
+TEST(graph, bad_files_are_rejected) {
+    const char* path = "amaan_tests_bad.amgr";
+    CHECK(load_fails("amaan_tests_missing.amgr"));
+
+    GraphFile::write(synthetic::make_city(synthetic::CityKind::Grid, 500, 15), path);
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto write_bytes = [&](const std::string& content) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    };
+
+    write_bytes(bytes.substr(0, bytes.size() / 2)); // Sections run past the end
+    CHECK(load_fails(path));
+    write_bytes(bytes.substr(0, 16));               // Not even a whole header
+    CHECK(load_fails(path));
+    std::string foreign = bytes;
+    foreign[0] = 'X';                               // Wrong magic
+    write_bytes(foreign);
+    CHECK(load_fails(path));
+    write_bytes(bytes);
+    CHECK(!load_fails(path));
+    std::remove(path);
+}
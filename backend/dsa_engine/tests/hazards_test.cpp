@@ -0,0 +1,245 @@
+/**
+ * hazards: grid penalty lookups against a linear scan, the vectorized batch
+ * kernel against single lookups, the registry's streamed
+ * updates and expiry, its changelog (also across copies, as hazard snapshots
+ * make them), and incremental overlay updates against full rebuilds.
+ */
+#include "test_harness.h"
+#include "../bench/synthetic_city.h"
+#include "../hazards.h"
+#include "../penalty_kernel.h"
+#include "../weight_overlay.h"
+#include <climits>
+#include <cmath>
+#include <random>
+
+namespace {
+
+Hazard hazard(int id, double lat, double lon, int severity) {
+    return {id, lat, lon, severity, "Traffic"};
+}
+
+HazardUpdate add(const Hazard& h, long long expires_at = 0) {
+    return {HazardUpdate::Op::Add, h, expires_at};
+}
+
+HazardUpdate remove(int id) {
+    return {HazardUpdate::Op::Remove, hazard(id, 0, 0, 0), 0};
+}
+
+std::vector<int> ids(const HazardManager& manager) {
+    std::vector<int> out;
+    for (const Hazard& h : manager.get_all_hazards()) out.push_back(h.id);
+    return out;
+}
+
+// Linear decay summed over every hazard, as the registry scored points before its grid
+double scan_penalty(const std::vector<Hazard>& all, double lat, double lon, double radius) {
+    double total = 0;
+    for (const Hazard& h : all) {
+        const double d = std::sqrt((lat - h.latitude) * (lat - h.latitude) + (lon - h.longitude) * (lon - h.longitude));
+        if (d < radius) total += h.severity * (1.0 - d / radius);
+    }
+    return total;
+}
+
+} // namespace
+
+TEST(hazards, grid_lookup_matches_linear_scan) {
+    // Hazards around the equator and prime meridian too, where cell indices turn negative
+    std::mt19937 rng(54);
+    std::uniform_real_distribution<double> offset(-0.03, 0.03);
+    std::vector<Hazard> all;
+    for (int id = 0; id < 300; ++id) {
+        const bool origin = id % 2 == 0;
+        all.push_back(hazard(id, (origin ? 0.0 : 33.7) + offset(rng), (origin ? 0.0 : 73.05) + offset(rng), 1 + id % 10));
+    }
+
+    for (double cell : {HazardManager::kInfluenceRadius, 0.002}) {
+        HazardManager manager(cell);
+        manager.replace_all(all);
+        for (double radius : {HazardManager::kInfluenceRadius, 0.012}) {
+            int mismatches = 0;
+            for (int i = 0; i < 400; ++i) {
+                const double lat = (i % 2 ? 0.0 : 33.7) + offset(rng), lon = (i % 2 ? 0.0 : 73.05) + offset(rng);
+                mismatches += std::fabs(manager.get_penalty_for_location(lat, lon, radius) -
+                                        scan_penalty(all, lat, lon, radius)) > 1e-9;
+            }
+            CHECK_EQ(mismatches, 0);
+        }
+    }
+    CHECK_EQ(HazardManager().get_penalty_for_location(33.7, 73.05), 0.0);
+}
+
+TEST(hazards, batch_kernel_matches_single_lookups) {
+    // Every instruction set this CPU offers gives bit-identical sums, at every tail length
+    std::mt19937 rng(55);
+    std::uniform_real_distribution<double> lat(33.69, 33.71), lon(73.04, 73.06), severity(0.0, 10.0);
+    std::vector<double> hazard_lats, hazard_lons, severities;
+    for (int j = 0; j < 37; ++j) {
+        hazard_lats.push_back(lat(rng));
+        hazard_lons.push_back(lon(rng));
+        severities.push_back(severity(rng));
+    }
+    for (size_t count = 0; count <= 13; ++count) {
+        std::vector<double> lats, lons;
+        for (size_t i = 0; i < count; ++i) {
+            lats.push_back(lat(rng));
+            lons.push_back(lon(rng));
+        }
+        std::vector<double> scalar(count, 1.0), best(count, 1.0);
+        penalty_kernel::accumulate(lats.data(), lons.data(), count, hazard_lats.data(), hazard_lons.data(),
+                                   severities.data(), hazard_lats.size(), 0.005, scalar.data(), penalty_kernel::Isa::Scalar);
+        penalty_kernel::accumulate(lats.data(), lons.data(), count, hazard_lats.data(), hazard_lons.data(),
+                                   severities.data(), hazard_lats.size(), 0.005, best.data(),
+                                   penalty_kernel::detected_isa());
+        CHECK_EQ(best, scalar);
+    }
+
+    // The registry's batch scoring equals its single lookups exactly, whichever kernel runs
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Geometric, 4000, 56);
+    HazardManager manager;
+    manager.replace_all(synthetic::make_hazards(city, 60, 57));
+    for (penalty_kernel::Isa isa : {penalty_kernel::Isa::Scalar, penalty_kernel::Isa::AVX2}) {
+        penalty_kernel::force_isa(isa);
+        CHECK(penalty_kernel::active_isa() ==
+              (isa == penalty_kernel::Isa::Scalar ? isa : penalty_kernel::detected_isa()));
+        std::vector<double> batch;
+        manager.get_penalties_for_locations(city.node_latitudes(), city.node_longitudes(), city.node_count(), batch);
+        int mismatches = 0, penalized = 0;
+        for (int v = 0; v < city.node_count(); ++v) {
+            mismatches += batch[v] != manager.get_penalty_for_location(city.latitude(v), city.longitude(v));
+            penalized += batch[v] > 0;
+        }
+        CHECK_EQ(mismatches, 0);
+        CHECK(penalized > 0);
+    }
+    penalty_kernel::force_isa(penalty_kernel::Isa::AVX2); // No cap, as at startup
+}
+
+TEST(hazards, apply_is_one_epoch) {
+    HazardManager manager;
+    CHECK_EQ(manager.apply({add(hazard(1, 33.70, 73.05, 5)), add(hazard(2, 33.71, 73.06, 3)), remove(7)}), size_t(2));
+    CHECK_EQ(manager.get_epoch(), 1ULL);
+    CHECK_EQ(ids(manager), (std::vector<int>{1, 2}));
+    CHECK(manager.get_penalty_for_location(33.70, 73.05) > 0);
+
+    // Re-adding an identical hazard changes nothing; an update and a removal share epoch 2
+    CHECK_EQ(manager.apply({add(hazard(1, 33.70, 73.05, 5))}), size_t(0));
+    CHECK_EQ(manager.apply({add(hazard(1, 33.70, 73.05, 9)), remove(2)}), size_t(2));
+    CHECK_EQ(manager.get_epoch(), 2ULL);
+    CHECK_EQ(ids(manager), std::vector<int>{1});
+    CHECK_EQ(manager.get_penalty_for_location(33.71, 73.06), 0.0);
+
+    std::vector<HazardChange> changes;
+    REQUIRE(manager.changes_since(1, changes));
+    REQUIRE(changes.size() == 2);
+    CHECK(changes[0].has_before && changes[0].has_after && changes[0].after.severity == 9);
+    CHECK(changes[1].has_before && !changes[1].has_after && changes[1].before.id == 2);
+
+    CHECK_EQ(manager.apply({{HazardUpdate::Op::Clear, Hazard{}, 0}}), size_t(1));
+    CHECK_EQ(manager.size(), size_t(0));
+    CHECK_EQ(manager.get_penalty_for_location(33.70, 73.05), 0.0);
+}
+
+TEST(hazards, expiry) {
+    HazardManager manager;
+    manager.apply({add(hazard(1, 33.70, 73.05, 5), 100), add(hazard(2, 33.71, 73.06, 3), 200), add(hazard(3, 33.72, 73.07, 4))});
+    CHECK_EQ(manager.next_expiry(), 100LL);
+    CHECK_EQ(manager.expire(99), size_t(0));
+    const unsigned long long epoch = manager.get_epoch();
+
+    // Rescheduling hazard 1 leaves a stale heap entry behind; it must not expire anything
+    CHECK_EQ(manager.apply({{HazardUpdate::Op::ExpireAt, hazard(1, 0, 0, 0), 300}}), size_t(1));
+    CHECK_EQ(manager.get_epoch(), epoch); // Expiry alone does not change a hazard
+    CHECK_EQ(manager.next_expiry(), 200LL);
+    CHECK_EQ(manager.expire(250), size_t(1));
+    CHECK_EQ(ids(manager), (std::vector<int>{1, 3}));
+    CHECK_EQ(manager.get_epoch(), epoch + 1);
+
+    // A removed hazard takes its expiry with it; re-adding without one cancels it
+    manager.apply({remove(1)});
+    CHECK_EQ(manager.next_expiry(), LLONG_MAX);
+    manager.apply({add(hazard(3, 33.72, 73.07, 4), 400), add(hazard(3, 33.72, 73.07, 4), 0)});
+    CHECK_EQ(manager.next_expiry(), LLONG_MAX);
+    CHECK_EQ(manager.expire(1000), size_t(0));
+    CHECK_EQ(ids(manager), std::vector<int>{3});
+
+    // replace_all drops the expiry of hazards that left the list
+    manager.apply({add(hazard(4, 33.73, 73.08, 2), 500)});
+    manager.replace_all({hazard(3, 33.72, 73.07, 4)});
+    CHECK_EQ(manager.next_expiry(), LLONG_MAX);
+}
+
+TEST(hazards, copies_keep_their_own_history) {
+    HazardManager first;
+    first.apply({add(hazard(1, 33.70, 73.05, 5))});
+    HazardManager second = first;
+    second.apply({add(hazard(2, 33.71, 73.06, 3))});
+    first.apply({remove(1)});
+
+    // Both logged epoch 2, each its own change; the shared epoch 1 is intact in both
+    std::vector<HazardChange> a, b;
+    REQUIRE(first.changes_since(0, a));
+    REQUIRE(second.changes_since(0, b));
+    REQUIRE(a.size() == 2 && b.size() == 2);
+    CHECK(a[0].after.id == 1 && b[0].after.id == 1);
+    CHECK(!a[1].has_after && a[1].before.id == 1);
+    CHECK(b[1].has_after && b[1].after.id == 2);
+    CHECK_EQ(first.get_penalty_for_location(33.70, 73.05), 0.0);
+    CHECK(second.get_penalty_for_location(33.70, 73.05) > 0);
+}
+
+TEST(hazards, changelog_is_trimmed_by_whole_epochs) {
+    HazardManager manager;
+    for (int round = 0; round < 5000; ++round) {
+        manager.apply({add(hazard(round % 50, 33.70, 73.05, 1 + round % 9))});
+        std::vector<HazardChange> changes;
+        REQUIRE(manager.changes_since(manager.get_epoch() - 1, changes));
+        REQUIRE(changes.size() == 1);
+    }
+    // One epoch bigger than the whole log is never handed out in part
+    std::vector<Hazard> many;
+    for (int id = 0; id < 5000; ++id) many.push_back(hazard(id, 33.70 + id * 1e-5, 73.05, 3));
+    manager.replace_all(many);
+    std::vector<HazardChange> changes;
+    CHECK(!manager.changes_since(manager.get_epoch() - 1, changes));
+    CHECK(changes.empty());
+    manager.apply({remove(1)});
+    CHECK(manager.changes_since(manager.get_epoch() - 1, changes));
+    CHECK_EQ(changes.size(), size_t(1));
+}
+
+TEST(hazards, overlay_update_matches_rebuild) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Geometric, 5000, 51);
+    std::vector<Hazard> live = synthetic::make_hazards(city, 40, 52);
+    HazardManager manager;
+    manager.replace_all(live);
+    WeightOverlay incremental;
+    incremental.rebuild(city, manager);
+
+    std::mt19937 rng(53);
+    for (int round = 0; round < 60; ++round) {
+        // Move, reweigh, remove or add a few hazards
+        std::vector<HazardUpdate> updates;
+        for (int k = 0; k < 3; ++k) {
+            Hazard h = live[rng() % live.size()];
+            switch (rng() % 4) {
+                case 0: h.latitude += 0.002; break;
+                case 1: h.severity = 1 + rng() % 10; break;
+                case 2: updates.push_back(remove(h.id)); continue;
+                default: h.id = 1000 + round * 3 + k; break;
+            }
+            updates.push_back(add(h));
+        }
+        manager.apply(updates);
+        incremental.update(city, manager);
+
+        WeightOverlay fresh;
+        fresh.rebuild(city, manager);
+        int mismatches = 0;
+        for (int e = 0; e < city.edge_count(); ++e) mismatches += incremental.penalty(e) != fresh.penalty(e);
+        CHECK_EQ(mismatches, 0);
+        CHECK(incremental.is_current(manager));
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * isochrone: bounded searches against a full reference search, and
+ * many-origin isochrones on the shared worker pool against single ones.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../dijkstra.h"
+#include "../hazards.h"
+#include <map>
+
+namespace {
+
+const CostModel kModels[] = {CostModel::Standard, CostModel::Eta, CostModel::Night, CostModel::Vulnerable};
+
+std::map<int, double> costs_of(const Isochrone& iso) {
+    std::map<int, double> costs;
+    for (const ReachedNode& node : iso.reached) costs[node.node_id] = node.cost;
+    return costs;
+}
+
+bool same_isochrone(const Isochrone& a, const Isochrone& b) {
+    if (a.origin != b.origin || a.success != b.success || a.reached.size() != b.reached.size()) return false;
+    for (size_t i = 0; i < a.reached.size(); ++i) {
+        if (a.reached[i].node_id != b.reached[i].node_id || a.reached[i].cost != b.reached[i].cost ||
+            a.reached[i].distance != b.reached[i].distance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(isochrone, small_city_budget) {
+    const CSRGraph city(fixtures::small_city());
+    const Isochrone iso = Dijkstra::reachable_within(city, 1, 2.25);
+    CHECK(iso.success);
+    CHECK_EQ(iso.origin, 1);
+    REQUIRE(iso.reached.size() == 4);
+    CHECK_EQ(iso.reached[0].node_id, 1);
+    CHECK_EQ(iso.reached[0].cost, 0.0);
+    const std::map<int, double> costs = costs_of(iso);
+    CHECK_NEAR(costs.at(2), 1.0, 1e-12);
+    CHECK_NEAR(costs.at(5), 1.2, 1e-12);
+    CHECK_NEAR(costs.at(6), 2.2, 1e-12);
+    for (size_t i = 1; i < iso.reached.size(); ++i) CHECK(iso.reached[i - 1].cost <= iso.reached[i].cost);
+
+    // A negative budget reaches nothing; an unknown origin is a failure
+    const Isochrone none = Dijkstra::reachable_within(city, 1, -1.0);
+    CHECK(none.success && none.reached.empty());
+    CHECK(!Dijkstra::reachable_within(city, 42, 5.0).success);
+    CHECK_EQ(Dijkstra::reachable_within(city, 9, 100.0).reached.size(), size_t(1));
+}
+
+TEST(isochrone, matches_reference_search) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Geometric, 3000, 71);
+    HazardManager hazards;
+    hazards.replace_all(synthetic::make_hazards(city, 30, 72));
+    WeightOverlay overlay;
+    overlay.rebuild(city, hazards);
+
+    const double budget = 1.5;
+    for (const auto& [origin, unused] : fixtures::random_pairs(city, 20, 73)) {
+        const std::vector<double> best =
+            fixtures::reference_costs(city, city.index_of(origin), fixtures::standard_cost(city, &overlay));
+        const std::map<int, double> costs = costs_of(Dijkstra::reachable_within(city, origin, budget, &overlay));
+        size_t inside = 0;
+        for (int v = 0; v < city.node_count(); ++v) {
+            if (best[v] > budget) continue;
+            inside++;
+            auto it = costs.find(city.node_id(v));
+            REQUIRE(it != costs.end());
+            CHECK_NEAR(it->second, best[v], 1e-9);
+        }
+        CHECK_EQ(costs.size(), inside);
+    }
+}
+
+TEST(isochrone, many_origins_match_single_ones) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Grid, 2000, 74);
+    HazardManager hazards;
+    hazards.replace_all(synthetic::make_hazards(city, 20, 75));
+    WeightOverlay overlay;
+    overlay.rebuild(city, hazards);
+
+    std::vector<int> origins = {42424242}; // Unknown origins keep their slot
+    for (const auto& [s, t] : fixtures::random_pairs(city, 15, 76)) origins.push_back(s);
+
+    for (CostModel mode : kModels) {
+        for (unsigned threads : {1u, 3u, 0u}) {
+            const std::vector<Isochrone> many = Dijkstra::reachable_within(city, origins, 2.0, &overlay, mode, threads);
+            REQUIRE(many.size() == origins.size());
+            CHECK(!many[0].success);
+            for (size_t i = 0; i < origins.size(); ++i) {
+                CHECK(same_isochrone(many[i], Dijkstra::reachable_within(city, origins[i], 2.0, &overlay, mode)));
+            }
+        }
+    }
+}
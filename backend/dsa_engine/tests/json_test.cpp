@@ -0,0 +1,74 @@
+/**
+ * json: the response writer's layout, separators, escaping and numbers, and
+ * reuse of one writer across responses.
+ */
+#include "test_harness.h"
+#include "../json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <sstream>
+
+TEST(json, layout_and_separators) {
+    JsonWriter json;
+    json.begin_object().field("status", "success").key("data").begin_object();
+    json.key("path").begin_array().value(1).value(2).value(3).end_array();
+    json.key("empty").begin_array().end_array();
+    json.key("nested").begin_array().begin_object().field("ok", true).end_object().begin_object().end_object().end_array();
+    json.field("none", false).key("missing").null();
+    json.end_object().end_object().newline();
+    CHECK_EQ(json.str(), "{\"status\": \"success\", \"data\": {\"path\": [1, 2, 3], \"empty\": [], "
+                         "\"nested\": [{\"ok\": true}, {}], \"none\": false, \"missing\": null}}\n");
+
+    // One write, byte for byte
+    std::ostringstream out;
+    json.write_to(out);
+    CHECK_EQ(out.str(), json.str());
+}
+
+TEST(json, strings_are_escaped) {
+    JsonWriter json;
+    json.begin_array();
+    json.value("plain").value("quote \" backslash \\").value("line\nbreak\ttab\r");
+    json.value(std::string("nul\0byte", 8)).value("\x01\x1f").value("caf\xc3\xa9");
+    json.end_array();
+    CHECK_EQ(json.str(), "[\"plain\", \"quote \\\" backslash \\\\\", \"line\\nbreak\\ttab\\r\", "
+                         "\"nul\\u0000byte\", \"\\u0001\\u001f\", \"caf\xc3\xa9\"]");
+
+    json.clear();
+    json.begin_object().field("na\"me", "x").end_object();
+    CHECK_EQ(json.str(), "{\"na\\\"me\": \"x\"}");
+}
+
+TEST(json, numbers) {
+    JsonWriter json;
+    json.begin_array();
+    json.value(0.0).value(-2.5).value(1e-7).value(100.0).value(std::nan("")).value(std::numeric_limits<double>::infinity());
+    json.value(-42).value(std::numeric_limits<long long>::min()).value(std::numeric_limits<unsigned long long>::max());
+    json.end_array();
+    CHECK_EQ(json.str(), "[0, -2.5, 1e-07, 100, null, null, -42, -9223372036854775808, 18446744073709551615]");
+
+    // Doubles are written in the shortest form that reads back to the same value
+    std::mt19937_64 rng(141);
+    std::uniform_real_distribution<double> coordinate(-180.0, 180.0);
+    int mismatches = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const double x = coordinate(rng);
+        json.clear();
+        json.value(x);
+        double back = 0;
+        std::from_chars(json.str().data(), json.str().data() + json.size(), back);
+        mismatches += back != x;
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST(json, cleared_writer_starts_fresh) {
+    JsonWriter json(16);
+    json.begin_object().key("data").begin_array().value(1); // Left unfinished, as after an error
+    json.clear();
+    CHECK_EQ(json.size(), size_t(0));
+    json.begin_object().field("a", 1).end_object();
+    CHECK_EQ(json.str(), "{\"a\": 1}");
+}
@@ -0,0 +1,131 @@
+/**
+ * kdtree: nearest, k-nearest and radius queries against a linear scan, for
+ * trees bulk-built from random, sorted and duplicate-heavy lists and for trees
+ * grown by inserts, with and without a type filter.
+ */
+#include "test_harness.h"
+#include "../kdtree.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+const char* const kTypes[] = {"Emergency", "Security", "Shelter"};
+
+std::vector<Facility> random_facilities(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> lat(33.60, 33.80), lon(72.95, 73.15);
+    std::vector<Facility> list;
+    for (int id = 0; id < count; ++id) list.push_back({id, "Facility " + std::to_string(id), kTypes[id % 3], lat(rng), lon(rng)});
+    return list;
+}
+
+double distance_sq(const Facility& f, double lat, double lon) {
+    return (f.latitude - lat) * (f.latitude - lat) + (f.longitude - lon) * (f.longitude - lon);
+}
+
+// Distance to the closest facility by linear scan
+double scan_nearest(const std::vector<Facility>& list, double lat, double lon) {
+    double best = 1e18;
+    for (const Facility& f : list) best = std::min(best, distance_sq(f, lat, lon));
+    return best;
+}
+
+// Queries the tree at random points; counts answers farther than the true nearest
+int nearest_mismatches(KDTree& tree, const std::vector<Facility>& list, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> lat(33.55, 33.85), lon(72.90, 73.20);
+    int mismatches = 0;
+    for (int i = 0; i < 300; ++i) {
+        const double qlat = lat(rng), qlon = lon(rng);
+        mismatches += distance_sq(tree.find_nearest(qlat, qlon), qlat, qlon) != scan_nearest(list, qlat, qlon);
+    }
+    return mismatches;
+}
+
+// Squared distances of the facilities the tree returned, in the order returned
+std::vector<double> distances_of(const KDTree& tree, const std::vector<int>& found, double lat, double lon) {
+    std::vector<double> out;
+    for (int i : found) out.push_back(distance_sq(tree.facility(i), lat, lon));
+    return out;
+}
+
+// Squared distances of every facility of 'type' (any if empty), nearest first
+std::vector<double> scan_distances(const std::vector<Facility>& list, double lat, double lon, const std::string& type) {
+    std::vector<double> out;
+    for (const Facility& f : list) {
+        if (type.empty() || f.type == type) out.push_back(distance_sq(f, lat, lon));
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+} // namespace
+
+TEST(kdtree, nearest_matches_linear_scan) {
+    const std::vector<Facility> list = random_facilities(1000, 101);
+    KDTree bulk(list);
+    CHECK_EQ(bulk.size(), list.size());
+    CHECK_EQ(nearest_mismatches(bulk, list, 102), 0);
+
+    // Sorted input is the worst case for a tree built by inserts without rebalancing
+    std::vector<Facility> sorted = list;
+    std::sort(sorted.begin(), sorted.end(), [](const Facility& a, const Facility& b) { return a.latitude < b.latitude; });
+    KDTree from_sorted(sorted);
+    CHECK_EQ(nearest_mismatches(from_sorted, list, 103), 0);
+
+    KDTree grown;
+    for (size_t i = 0; i < list.size(); ++i) {
+        grown.insert(list[i]);
+        if (i == 10 || i == 200) grown.find_nearest(33.7, 73.05); // Rebuilds between inserts
+    }
+    CHECK_EQ(nearest_mismatches(grown, list, 104), 0);
+}
+
+TEST(kdtree, duplicates_and_tiny_trees) {
+    KDTree empty;
+    CHECK_EQ(empty.find_nearest(33.7, 73.05).id, -1);
+
+    KDTree single({{7, "Only", "Shelter", 33.7, 73.05}});
+    CHECK_EQ(single.find_nearest(0, 0).id, 7);
+
+    // Many facilities on one spot, far more than a leaf bucket holds
+    std::vector<Facility> stacked;
+    for (int id = 0; id < 5 * KDTree::kLeafSize; ++id) stacked.push_back({id, "Stacked", "Security", 33.7, 73.05});
+    stacked.push_back({999, "Apart", "Security", 33.75, 73.10});
+    KDTree tree(stacked);
+    CHECK_EQ(tree.find_nearest(33.751, 73.101).id, 999);
+    CHECK(tree.find_nearest(33.701, 73.051).id < 5 * KDTree::kLeafSize);
+}
+
+TEST(kdtree, k_nearest_and_radius_match_linear_scan) {
+    const std::vector<Facility> list = random_facilities(800, 105);
+    KDTree tree(list);
+    std::mt19937 rng(106);
+    std::uniform_real_distribution<double> lat(33.55, 33.85), lon(72.90, 73.20);
+
+    for (int i = 0; i < 100; ++i) {
+        const double qlat = lat(rng), qlon = lon(rng);
+        for (const std::string type : {"", "Shelter"}) {
+            const std::vector<double> all = scan_distances(list, qlat, qlon, type);
+            for (size_t k : {size_t(1), size_t(5), size_t(40)}) {
+                const std::vector<int> found = tree.find_k_nearest(qlat, qlon, k, type);
+                CHECK_EQ(distances_of(tree, found, qlat, qlon), std::vector<double>(all.begin(), all.begin() + k));
+                for (int f : found) CHECK(type.empty() || tree.facility(f).type == type);
+            }
+
+            const double radius = 0.02;
+            const std::vector<int> inside = tree.find_within_radius(qlat, qlon, radius, type);
+            const auto end = std::upper_bound(all.begin(), all.end(), radius * radius);
+            CHECK_EQ(distances_of(tree, inside, qlat, qlon), std::vector<double>(all.begin(), end));
+        }
+    }
+
+    // Asking for more than there is returns everything that matches
+    CHECK_EQ(tree.find_k_nearest(33.7, 73.05, 5000).size(), list.size());
+    CHECK_EQ(tree.find_k_nearest(33.7, 73.05, 5000, "Security").size(), size_t(267));
+    CHECK(tree.find_k_nearest(33.7, 73.05, 3, "Bakery").empty());
+    CHECK(tree.find_k_nearest(33.7, 73.05, 0).empty());
+    CHECK(tree.find_within_radius(10.0, 10.0, 0.5).empty());
+    CHECK(KDTree().find_k_nearest(33.7, 73.05, 3).empty());
+}
@@ -0,0 +1,44 @@
+/**
+ * latency: the serve-mode latency histogram's percentiles against exact order
+ * statistics, within its stated precision.
+ */
+#include "test_harness.h"
+#include "../latency_histogram.h"
+#include <algorithm>
+#include <random>
+
+TEST(latency, small_values_are_exact) {
+    LatencyHistogram h;
+    CHECK_EQ(h.count(), 0ULL);
+    CHECK_EQ(h.percentile(50), 0ULL);
+    CHECK_EQ(h.mean(), 0.0);
+
+    for (uint64_t us = 1; us <= 60; ++us) h.record(us);
+    CHECK_EQ(h.count(), 60ULL);
+    CHECK_EQ(h.max(), 60ULL);
+    CHECK_NEAR(h.mean(), 30.5, 1e-12);
+    CHECK_EQ(h.percentile(50), 30ULL);
+    CHECK_EQ(h.percentile(90), 54ULL);
+    CHECK_EQ(h.percentile(100), 60ULL);
+}
+
+TEST(latency, large_values_within_three_percent) {
+    std::mt19937 rng(121);
+    std::lognormal_distribution<double> micros(8.0, 2.0); // Median ~3 ms, long tail into seconds
+    std::vector<uint64_t> values;
+    LatencyHistogram h;
+    for (int i = 0; i < 20000; ++i) {
+        values.push_back(static_cast<uint64_t>(micros(rng)));
+        h.record(values.back());
+    }
+    std::sort(values.begin(), values.end());
+    CHECK_EQ(h.max(), values.back());
+
+    for (double percent : {50.0, 90.0, 99.0, 99.9}) {
+        // Bucket bound of the value at that rank: never below it, at most ~3% above
+        const uint64_t exact = values[static_cast<size_t>(percent / 100.0 * values.size()) - 1];
+        const uint64_t reported = h.percentile(percent);
+        CHECK(reported >= exact);
+        CHECK(reported <= exact + exact / 32 + 1);
+    }
+}
@@ -0,0 +1,154 @@
+/**
+ * matrix: route matrices against single searches, and the shared worker pool
+ * they run on, including several requests using it at once and keeping its
+ * threads' search workspaces between requests.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../dijkstra.h"
+#include "../hazards.h"
+#include "../search_workspace.h"
+#include "../worker_pool.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+
+typedef std::vector<std::vector<MatrixCell>> Matrix;
+
+// Cells compare exactly: every thread count must run the very same searches
+bool same_matrix(const Matrix& a, const Matrix& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].size() != b[i].size()) return false;
+        for (size_t j = 0; j < a[i].size(); ++j) {
+            if (a[i][j].success != b[i][j].success || a[i][j].total_distance != b[i][j].total_distance ||
+                a[i][j].safety_score != b[i][j].safety_score) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<int> random_nodes(const CSRGraph& graph, int count, unsigned seed) {
+    std::vector<int> nodes;
+    for (const auto& [s, t] : fixtures::random_pairs(graph, count, seed)) nodes.push_back(s);
+    return nodes;
+}
+
+} // namespace
+
+TEST(matrix, small_city_cells) {
+    const CSRGraph city(fixtures::small_city());
+    const Matrix m = Dijkstra::many_to_many(city, {1, 4, 9, 42}, {4, 1, 9, 1});
+    REQUIRE(m.size() == 4);
+    CHECK(m[0][0].success);
+    CHECK_NEAR(m[0][0].total_distance, 5.6, 1e-12);
+    CHECK(m[0][1].success);
+    CHECK_EQ(m[0][1].total_distance, 0.0);
+    CHECK(!m[0][2].success);
+    CHECK_NEAR(m[1][1].total_distance, 5.1, 1e-12);
+    CHECK_NEAR(m[1][3].total_distance, 5.1, 1e-12); // A repeated target gets its own cell
+    CHECK(!m[2][0].success);
+    CHECK(m[2][2].success);
+    for (const MatrixCell& cell : m[3]) CHECK(!cell.success);
+}
+
+TEST(matrix, matches_single_searches) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Geometric, 3000, 61);
+    HazardManager hazards;
+    hazards.replace_all(synthetic::make_hazards(city, 30, 62));
+    WeightOverlay overlay;
+    overlay.rebuild(city, hazards);
+
+    const std::vector<int> sources = random_nodes(city, 24, 63), targets = random_nodes(city, 20, 64);
+    const Matrix m = Dijkstra::many_to_many(city, sources, targets, &overlay, 4);
+    REQUIRE(m.size() == sources.size());
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const std::vector<double> best =
+            fixtures::reference_costs(city, city.index_of(sources[i]), fixtures::standard_cost(city, &overlay));
+        for (size_t j = 0; j < targets.size(); ++j) {
+            CHECK_EQ(m[i][j].success, best[city.index_of(targets[j])] != fixtures::kUnreachable);
+            const PathResult r = Dijkstra::find_safest_path(city, sources[i], targets[j], &overlay);
+            if (!r.success) continue;
+            CHECK_NEAR(m[i][j].total_distance, r.total_distance, 1e-9);
+            CHECK_NEAR(m[i][j].safety_score, r.safety_score, 1e-9);
+        }
+    }
+
+    for (unsigned threads : {1u, 2u, 0u, 64u}) {
+        CHECK(same_matrix(Dijkstra::many_to_many(city, sources, targets, &overlay, threads), m));
+    }
+}
+
+TEST(matrix, concurrent_requests_share_the_pool) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Grid, 2000, 65);
+    const std::vector<int> sources = random_nodes(city, 16, 66), targets = random_nodes(city, 16, 67);
+    const Matrix expected = Dijkstra::many_to_many(city, sources, targets, nullptr, 1);
+
+    // As serve mode's workers would: every request asks for all cores at once
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> requests;
+    for (int t = 0; t < 8; ++t) {
+        requests.emplace_back([&]() {
+            for (int round = 0; round < 5; ++round) {
+                if (!same_matrix(Dijkstra::many_to_many(city, sources, targets, nullptr, 0), expected)) mismatches++;
+            }
+        });
+    }
+    for (std::thread& t : requests) t.join();
+    CHECK_EQ(mismatches.load(), 0);
+}
+
+TEST(matrix, workspaces_outlive_requests) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Geometric, 4000, 68);
+    const std::vector<int> sources = random_nodes(city, 32, 69), targets = random_nodes(city, 8, 70);
+
+    // Each thread sizes its workspace for this map at most once, however many requests it serves
+    const uint64_t before = SearchWorkspace::allocations();
+    for (int round = 0; round < 20; ++round) {
+        Dijkstra::many_to_many(city, sources, targets, nullptr, 0);
+        Dijkstra::reachable_within(city, sources, 1.0, nullptr, CostModel::Standard, 0);
+    }
+    CHECK(SearchWorkspace::allocations() - before <= WorkerPool::shared().helper_count() + 1);
+
+    // Same on a pool with helpers, whatever the machine's core count
+    WorkerPool pool(3);
+    const uint64_t start = SearchWorkspace::allocations();
+    for (int round = 0; round < 20; ++round) {
+        pool.parallel_for(sources.size(), 0, [&](size_t i) { Dijkstra::one_to_many(city, sources[i], targets); });
+    }
+    CHECK(SearchWorkspace::allocations() - start <= 4);
+}
+
+TEST(matrix, pool_runs_each_index_once) {
+    WorkerPool pool(3);
+    CHECK_EQ(pool.helper_count(), 3u);
+    for (unsigned parallelism : {0u, 1u, 2u, 10u}) {
+        std::vector<std::atomic<int>> calls(1000);
+        pool.parallel_for(calls.size(), parallelism, [&](size_t i) { calls[i]++; });
+        int wrong = 0;
+        for (const std::atomic<int>& c : calls) wrong += c.load() != 1;
+        CHECK_EQ(wrong, 0);
+    }
+
+    // Callers finish their own jobs even while the helpers are taken
+    std::atomic<long long> sum(0);
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 6; ++t) {
+        callers.emplace_back([&]() {
+            for (int round = 0; round < 50; ++round) {
+                pool.parallel_for(100, 0, [&](size_t i) { sum += static_cast<long long>(i); });
+            }
+        });
+    }
+    for (std::thread& t : callers) t.join();
+    CHECK_EQ(sum.load(), 6LL * 50 * 4950);
+
+    WorkerPool none(0);
+    int ran = 0;
+    none.parallel_for(5, 0, [&](size_t) { ran++; });
+    CHECK_EQ(ran, 5);
+}
@@ -0,0 +1,67 @@
+/**
+ * overlay: per-edge hazard penalties against the registry's point penalties,
+ * resets between rebuilds, and routes steering around a penalized road.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../dijkstra.h"
+#include "../hazards.h"
+#include "../weight_overlay.h"
+
+namespace {
+
+// Penalty the overlay should give edge e: the average of both ends, doubled
+double expected_penalty(const CSRGraph& graph, const HazardManager& hazards, int e) {
+    const int u = graph.edge_source(e), v = graph.edge_target(e);
+    return hazards.get_penalty_for_location(graph.latitude(u), graph.longitude(u)) +
+           hazards.get_penalty_for_location(graph.latitude(v), graph.longitude(v));
+}
+
+} // namespace
+
+TEST(overlay, penalties_follow_the_hazards) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Grid, 3000, 91);
+    HazardManager hazards;
+    hazards.replace_all(synthetic::make_hazards(city, 40, 92));
+    WeightOverlay overlay;
+    CHECK(!overlay.is_current(hazards));
+    overlay.rebuild(city, hazards);
+    CHECK(overlay.is_current(hazards));
+
+    int mismatches = 0, penalized = 0;
+    for (int e = 0; e < city.edge_count(); ++e) {
+        mismatches += std::fabs(overlay.penalty(e) - expected_penalty(city, hazards, e)) > 1e-12;
+        penalized += overlay.penalty(e) != 0.0;
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK(penalized > 0);
+    CHECK_EQ(overlay.penalized_edges().size(), static_cast<size_t>(penalized));
+    for (int e : overlay.penalized_edges()) CHECK(overlay.penalty(e) != 0.0);
+
+    // A new hazard set makes the overlay stale; rebuilding for none clears every penalty
+    hazards.replace_all({});
+    CHECK(!overlay.is_current(hazards));
+    overlay.rebuild(city, hazards);
+    int left = 0;
+    for (int e = 0; e < city.edge_count(); ++e) left += overlay.penalty(e) != 0.0;
+    CHECK_EQ(left, 0);
+    CHECK(overlay.penalized_edges().empty());
+}
+
+TEST(overlay, routes_avoid_a_penalized_intersection) {
+    const CSRGraph city(fixtures::small_city());
+    HazardManager hazards;
+    hazards.replace_all({{1, 33.710, 73.010, 8, "Accident"}}); // On node 6
+    WeightOverlay overlay;
+    overlay.rebuild(city, hazards);
+
+    // Every road at node 6 now costs 8 more, so 1 -> 4 takes the static hazard on 2-3 instead
+    const PathResult r = Dijkstra::find_safest_path(city, 1, 4, &overlay);
+    REQUIRE(r.success);
+    CHECK_EQ(r.path, (std::vector<int>{1, 2, 3, 4}));
+    CHECK_NEAR(r.total_cost, 8.0, 1e-12);
+
+    // The shared topology is untouched: without the overlay the old route comes back
+    CHECK_EQ(Dijkstra::find_safest_path(city, 1, 4).path, (std::vector<int>{1, 2, 6, 7, 3, 4}));
+}
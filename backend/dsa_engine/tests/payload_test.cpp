@@ -0,0 +1,143 @@
+/**
+ * payload: the hazard, hazard update and candidate record parsers, their
+ * error reports, strict number fields, and payloads passed by file.
+ */
+#include "test_harness.h"
+#include "../bench/synthetic_city.h"
+#include "../payload_parser.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+TEST(payload, hazards) {
+    std::vector<Hazard> out;
+    ParseReport report;
+    parse_hazards(" 1|33.7|73.05|5|Traffic ; 2 | -33.5 | 151.2 | 3 ;;\n3|0|0|0|Fire;", out, report);
+    REQUIRE(out.size() == 3);
+    CHECK_EQ(report.accepted, size_t(3));
+    CHECK_EQ(report.malformed, size_t(0));
+    CHECK_EQ(out[0].id, 1);
+    CHECK_EQ(out[0].latitude, 33.7);
+    CHECK_EQ(out[0].longitude, 73.05);
+    CHECK_EQ(out[0].severity, 5);
+    CHECK_EQ(out[0].type, "Traffic");
+    CHECK_EQ(out[1].latitude, -33.5);
+    CHECK_EQ(out[1].type, "");
+    CHECK_EQ(out[2].type, "Fire");
+
+    // Every bad record is skipped and described by its position; the good ones still count
+    out.clear();
+    report = ParseReport();
+    parse_hazards("x|1|1|1;4|91|0|1;5|1|1;6|1|1|2|ok;7|1|abc|1;8|1|1|1.5", out, report);
+    CHECK_EQ(out.size(), size_t(1));
+    CHECK_EQ(out[0].id, 6);
+    CHECK_EQ(report.malformed, size_t(5));
+    REQUIRE(report.errors.size() == 5);
+    CHECK_EQ(report.errors[0].reason, "invalid hazard id");
+    CHECK_EQ(report.errors[1].reason, "coordinates out of range");
+    CHECK_EQ(report.errors[2].reason, "invalid severity");
+    CHECK_EQ(report.errors[3].record, size_t(4));
+    CHECK_EQ(report.errors[3].reason, "invalid longitude");
+    CHECK_EQ(report.errors[4].reason, "invalid severity");
+
+    // What the benchmarks send reads back, to the ten digits they print
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Grid, 500, 131);
+    const std::vector<Hazard> sent = synthetic::make_hazards(city, 50, 132);
+    std::vector<Hazard> received;
+    ParseReport round_trip;
+    parse_hazards(synthetic::format_hazards(sent), received, round_trip);
+    REQUIRE(received.size() == sent.size());
+    int mismatches = 0;
+    for (size_t i = 0; i < sent.size(); ++i) {
+        mismatches += received[i].id != sent[i].id || std::fabs(received[i].latitude - sent[i].latitude) > 1e-7 ||
+                      std::fabs(received[i].longitude - sent[i].longitude) > 1e-7 ||
+                      received[i].severity != sent[i].severity || received[i].type != sent[i].type;
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST(payload, hazard_updates) {
+    std::vector<HazardUpdate> out;
+    ParseReport report;
+    parse_hazard_updates("add|1|33.7|73.05|5|Traffic|1700000000;update|1|33.7|73.05|6|Traffic;remove|2;"
+                         "expire|3|1700000100;clear;drop|4;expire|5;add|6|33.7|73.05|5|Fire|-1",
+                         out, report);
+    REQUIRE(out.size() == 5);
+    CHECK(out[0].op == HazardUpdate::Op::Add);
+    CHECK_EQ(out[0].expires_at, 1700000000LL);
+    CHECK(out[1].op == HazardUpdate::Op::Update);
+    CHECK_EQ(out[1].hazard.severity, 6);
+    CHECK_EQ(out[1].expires_at, 0LL);
+    CHECK(out[2].op == HazardUpdate::Op::Remove);
+    CHECK_EQ(out[2].hazard.id, 2);
+    CHECK(out[3].op == HazardUpdate::Op::ExpireAt);
+    CHECK_EQ(out[3].expires_at, 1700000100LL);
+    CHECK(out[4].op == HazardUpdate::Op::Clear);
+
+    REQUIRE(report.errors.size() == 3);
+    CHECK_EQ(report.errors[0].reason, "unknown operation");
+    CHECK_EQ(report.errors[1].reason, "invalid expiry time");
+    CHECK_EQ(report.errors[2].record, size_t(7));
+    CHECK_EQ(report.errors[2].reason, "invalid expiry time");
+}
+
+TEST(payload, candidates) {
+    std::vector<Facility> out;
+    ParseReport report;
+    parse_candidates("PIMS Hospital|33.70|73.05|Emergency;Station 4|33.71|73.06;|33|73;Far|33|200", out, report, "Police");
+    REQUIRE(out.size() == 2);
+    CHECK_EQ(out[0].name, "PIMS Hospital");
+    CHECK_EQ(out[0].type, "Emergency");
+    CHECK_EQ(out[1].type, "Police");
+    REQUIRE(report.errors.size() == 2);
+    CHECK_EQ(report.errors[0].reason, "missing name");
+    CHECK_EQ(report.errors[1].reason, "coordinates out of range");
+
+    // Only the first few errors are described, but all are counted
+    std::string bad;
+    for (int i = 0; i < 25; ++i) bad += "name|x|0;";
+    out.clear();
+    report = ParseReport();
+    parse_candidates(bad, out, report);
+    CHECK_EQ(report.malformed, size_t(25));
+    CHECK_EQ(report.errors.size(), size_t(ParseReport::kMaxErrors));
+}
+
+TEST(payload, number_fields_are_strict) {
+    int i = 0;
+    double d = 0;
+    CHECK(parse_int_field(" 42 ", i) && i == 42);
+    CHECK(parse_int_field("-7", i) && i == -7);
+    CHECK(!parse_int_field("", i));
+    CHECK(!parse_int_field("12x", i));
+    CHECK(!parse_int_field("4.5", i));
+    CHECK(!parse_int_field("99999999999", i));
+    CHECK(parse_double_field("33.6844", d) && d == 33.6844);
+    CHECK(parse_double_field("1e-3", d) && d == 1e-3);
+    CHECK(!parse_double_field("nan", d));
+    CHECK(!parse_double_field("inf", d));
+    CHECK(!parse_double_field("1e400", d));
+    CHECK(!parse_double_field("33.7.1", d));
+}
+
+TEST(payload, arguments_from_files) {
+    const char* path = "amaan_tests_payload.txt";
+    std::ofstream(path) << "1|33.7|73.05|5|Traffic";
+    std::string error;
+
+    std::string arg = std::string("@") + path;
+    CHECK(load_payload_argument(arg, false, error));
+    CHECK_EQ(arg, "1|33.7|73.05|5|Traffic");
+    std::remove(path);
+
+    arg = "@amaan_tests_missing.txt";
+    CHECK(!load_payload_argument(arg, false, error));
+    CHECK(!error.empty());
+
+    // Record lists are never file references, and stdin is refused unless allowed
+    arg = "@1|2|3";
+    CHECK(load_payload_argument(arg, false, error));
+    CHECK_EQ(arg, "@1|2|3");
+    arg = "-";
+    CHECK(!load_payload_argument(arg, false, error));
+}
@@ -0,0 +1,104 @@
+/**
+ * rcu: versions replaced under pinned readers are only freed once those
+ * readers move on, and concurrent readers always see whole versions.
+ */
+#include "test_harness.h"
+#include "../rcu.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<int> destroyed(0);
+
+// A version that counts its destruction and checks that readers never see it freed
+struct Version {
+    long long value;
+    long long twice;
+    std::atomic<bool> alive{true};
+
+    explicit Version(long long v) : value(v), twice(2 * v) {}
+    ~Version() {
+        alive = false;
+        destroyed++;
+    }
+};
+
+} // namespace
+
+TEST(rcu, retired_versions_wait_for_readers) {
+    rcu::Versioned<Version> state;
+    state.publish(std::make_unique<const Version>(1));
+    const int before = destroyed.load();
+
+    {
+        rcu::ReadGuard outer;
+        const Version* pinned = state.get();
+        {
+            rcu::ReadGuard inner; // Nested guards keep the outer pin
+        }
+        state.publish(std::make_unique<const Version>(2));
+        rcu::reclaim();
+        CHECK_EQ(destroyed.load(), before);
+        CHECK(pinned->alive && pinned->value == 1);
+        CHECK_EQ(state.get()->value, 2LL);
+    }
+    CHECK_EQ(rcu::reclaim(), size_t(0));
+    CHECK_EQ(destroyed.load(), before + 1);
+
+    // Without readers a replaced version is freed at once
+    state.publish(std::make_unique<const Version>(3));
+    CHECK_EQ(destroyed.load(), before + 2);
+    CHECK_EQ(rcu::pending(), size_t(0));
+
+    // A reader pinned after a version was retired does not hold it back
+    std::atomic<int> step(0);
+    std::thread early([&]() {
+        rcu::ReadGuard pin;
+        step = 1;
+        while (step != 2) std::this_thread::yield();
+    });
+    while (step != 1) std::this_thread::yield();
+    state.publish(std::make_unique<const Version>(4));
+    CHECK_EQ(rcu::pending(), size_t(1));
+    {
+        rcu::ReadGuard late;
+        step = 2;
+        early.join();
+        CHECK_EQ(rcu::reclaim(), size_t(0));
+        CHECK_EQ(destroyed.load(), before + 3);
+    }
+}
+
+TEST(rcu, concurrent_readers_see_whole_versions) {
+    rcu::Versioned<Version> state;
+    state.publish(std::make_unique<const Version>(0));
+    const int before = destroyed.load();
+    const int kVersions = 2000;
+
+    std::atomic<bool> writing(true);
+    std::atomic<int> torn(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            long long last = 0;
+            while (writing) {
+                rcu::ReadGuard pin;
+                const Version* v = state.get();
+                // Versions only move forward, and stay whole while pinned
+                if (!v->alive || v->twice != 2 * v->value || v->value < last) torn++;
+                last = v->value;
+                std::this_thread::yield();
+                if (!v->alive) torn++;
+            }
+        });
+    }
+    for (int i = 1; i <= kVersions; ++i) state.publish(std::make_unique<const Version>(i));
+    writing = false;
+    for (std::thread& t : readers) t.join();
+
+    CHECK_EQ(torn.load(), 0);
+    CHECK_EQ(rcu::reclaim(), size_t(0));
+    CHECK_EQ(destroyed.load(), before + kVersions);
+}
@@ -0,0 +1,130 @@
+/**
+ * route_cache: keys (including the search that found a route), LRU eviction,
+ * and lazy invalidation against hazard changes, checked against fresh searches.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../route_cache.h"
+#include <random>
+
+namespace {
+
+Hazard hazard(int id, double lat, double lon, int severity) {
+    return {id, lat, lon, severity, "Traffic"};
+}
+
+HazardUpdate add(const Hazard& h) {
+    return {HazardUpdate::Op::Add, h, 0};
+}
+
+HazardUpdate remove(int id) {
+    return {HazardUpdate::Op::Remove, hazard(id, 0, 0, 0), 0};
+}
+
+} // namespace
+
+TEST(route_cache, keys_include_the_search) {
+    const CSRGraph city(fixtures::small_city());
+    HazardManager hazards;
+    RouteCache cache;
+    const RouteCache::Key dijkstra{1, 4, CostModel::Standard};
+    const PathResult r = Dijkstra::find_safest_path(city, 1, 4);
+    REQUIRE(r.stats.nodes_settled > 0);
+    cache.store(city, hazards.get_epoch(), dijkstra, r);
+
+    CHECK(!cache.lookup(city, hazards, {1, 4, CostModel::Standard, SearchAlgorithm::AStar}));
+    CHECK(!cache.lookup(city, hazards, {1, 4, CostModel::Standard, SearchAlgorithm::Dijkstra, true}));
+    CHECK(!cache.lookup(city, hazards, {1, 4, CostModel::Night}));
+    CHECK(!cache.lookup(city, hazards, {4, 1, CostModel::Standard}));
+
+    const PathResult* hit = cache.lookup(city, hazards, dijkstra);
+    REQUIRE(hit);
+    CHECK_EQ(hit->path, r.path);
+    CHECK_EQ(hit->stats.nodes_settled, 0); // A hit reports no search work of its own
+    CHECK_EQ(cache.stats().hits, 1ULL);
+    CHECK_EQ(cache.stats().misses, 4ULL);
+}
+
+TEST(route_cache, least_recently_used_is_evicted) {
+    const CSRGraph city(fixtures::small_city());
+    HazardManager hazards;
+    RouteCache cache(2);
+    const RouteCache::Key a{1, 4, CostModel::Standard}, b{4, 1, CostModel::Standard}, c{1, 8, CostModel::Standard};
+    cache.store(city, 0, a, Dijkstra::find_safest_path(city, 1, 4));
+    cache.store(city, 0, b, Dijkstra::find_safest_path(city, 4, 1));
+    CHECK(cache.lookup(city, hazards, a)); // 'b' is now the oldest
+    cache.store(city, 0, c, Dijkstra::find_safest_path(city, 1, 8));
+    CHECK_EQ(cache.size(), size_t(2));
+    CHECK_EQ(cache.stats().evictions, 1ULL);
+    CHECK(!cache.lookup(city, hazards, b));
+    CHECK(cache.lookup(city, hazards, a));
+    CHECK(cache.lookup(city, hazards, c));
+}
+
+TEST(route_cache, hazard_changes_invalidate_lazily) {
+    const CSRGraph city(fixtures::small_city());
+    HazardManager hazards;
+    RouteCache cache;
+    const RouteCache::Key key{1, 4, CostModel::Standard};
+    const RouteCache::Key unreachable{1, 9, CostModel::Standard};
+    cache.store(city, hazards.get_epoch(), key, Dijkstra::find_safest_path(city, 1, 4));
+    cache.store(city, hazards.get_epoch(), unreachable, Dijkstra::find_safest_path(city, 1, 9));
+
+    // A hazard far from the route, added and then removed again: the route stays optimal
+    hazards.apply({add(hazard(1, 33.80, 73.10, 8))});
+    CHECK(cache.lookup(city, hazards, key));
+    hazards.apply({remove(1)});
+    CHECK(cache.lookup(city, hazards, key));
+
+    // A hazard at node 6, which the route passes through
+    hazards.apply({add(hazard(2, 33.71, 73.01, 8))});
+    CHECK(!cache.lookup(city, hazards, key));
+    CHECK_EQ(cache.stats().invalidated, 1ULL);
+    const PathResult* none = cache.lookup(city, hazards, unreachable);
+    REQUIRE(none);
+    CHECK(!none->success);
+}
+
+TEST(route_cache, hits_match_fresh_searches) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Geometric, 3000, 81);
+    std::vector<Hazard> live = synthetic::make_hazards(city, 30, 82);
+    HazardManager hazards;
+    hazards.replace_all(live);
+    RouteCache cache;
+    const std::vector<std::pair<int, int>> pairs = fixtures::random_pairs(city, 40, 83);
+
+    std::mt19937 rng(84);
+    int hits = 0;
+    for (int round = 0; round < 30; ++round) {
+        WeightOverlay overlay;
+        overlay.rebuild(city, hazards);
+        for (const auto& [s, t] : pairs) {
+            const RouteCache::Key key{s, t, CostModel::Standard};
+            const PathResult expected = Dijkstra::find_safest_path(city, s, t, &overlay);
+            if (const PathResult* hit = cache.lookup(city, hazards, key)) {
+                hits++;
+                CHECK_EQ(hit->success, expected.success);
+                CHECK_NEAR(hit->total_cost, expected.total_cost, 1e-9);
+                CHECK_NEAR(hit->safety_score, expected.safety_score, 1e-9);
+            } else {
+                cache.store(city, hazards.get_epoch(), key, expected);
+            }
+        }
+
+        // Move, ease, worsen, remove or add a few hazards
+        std::vector<HazardUpdate> updates;
+        for (int k = 0; k < 2; ++k) {
+            Hazard h = live[rng() % live.size()];
+            switch (rng() % 4) {
+                case 0: h.latitude += 0.003; break;
+                case 1: h.severity = 1 + rng() % 10; break;
+                case 2: updates.push_back(remove(h.id)); continue;
+                default: h.id = 1000 + round * 2 + k; break;
+            }
+            updates.push_back(add(h));
+        }
+        hazards.apply(updates);
+    }
+    CHECK(hits > 0); // Most routes survive a couple of changes elsewhere
+}
@@ -0,0 +1,117 @@
+/**
+ * search: every search variant (A*, bidirectional, each priority queue, the
+ * contraction hierarchy) against plain Dijkstra on the binary heap, with and
+ * without a live hazard overlay, and A* on roads where its lower bound is tight.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../contraction_hierarchy.h"
+#include "../dijkstra.h"
+#include "../geo.h"
+#include "../hazards.h"
+#include <random>
+
+namespace {
+
+const SearchAlgorithm kAlgorithms[] = {SearchAlgorithm::Dijkstra, SearchAlgorithm::AStar, SearchAlgorithm::Bidirectional};
+const QueueType kQueues[] = {QueueType::BinaryHeap, QueueType::FourAryHeap, QueueType::RadixHeap, QueueType::Buckets};
+
+// A result must be a real route whose cost is the optimum found by plain Dijkstra
+void check_same_optimum(const CSRGraph& graph, const WeightOverlay* overlay, const PathResult& expected,
+                        const PathResult& actual) {
+    CHECK_EQ(actual.success, expected.success);
+    if (!actual.success || !expected.success) return;
+    CHECK_NEAR(actual.total_cost, expected.total_cost, 1e-9);
+    CHECK_NEAR(fixtures::route_cost(graph, actual.path, fixtures::standard_cost(graph, overlay)), actual.total_cost, 1e-9);
+    CHECK_EQ(actual.path.front(), expected.path.front());
+    CHECK_EQ(actual.path.back(), expected.path.back());
+}
+
+// A straight road of 'nodes' intersections whose weights are exactly their great-circle
+// lengths, so the A* lower bound is tight and keys repeat up to the last ulp
+CSRGraph straight_road(int nodes, double lat, double lon, double lat_step, double lon_step) {
+    Graph g;
+    for (int i = 0; i < nodes; ++i) g.add_node(i + 1, lat + i * lat_step, lon + i * lon_step);
+    for (int i = 1; i < nodes; ++i) {
+        const Node& a = g.get_node(i);
+        const Node& b = g.get_node(i + 1);
+        g.add_edge(i, i + 1, geo::haversine_km(a.latitude, a.longitude, b.latitude, b.longitude));
+    }
+    return CSRGraph(g);
+}
+
+} // namespace
+
+TEST(search, variants_match_dijkstra) {
+    for (synthetic::CityKind kind : {synthetic::CityKind::Grid, synthetic::CityKind::Geometric}) {
+        const CSRGraph city = synthetic::make_city(kind, 2000, 21);
+        HazardManager hazards;
+        hazards.replace_all(synthetic::make_hazards(city, 30, 22));
+        WeightOverlay overlay;
+        overlay.rebuild(city, hazards);
+
+        const WeightOverlay* const overlays[] = {nullptr, &overlay};
+        for (const WeightOverlay* live : overlays) {
+            for (const auto& [s, t] : fixtures::random_pairs(city, 40, 23)) {
+                const PathResult expected = Dijkstra::find_safest_path(city, s, t, live);
+                for (SearchAlgorithm algorithm : kAlgorithms) {
+                    for (QueueType queue : kQueues) {
+                        check_same_optimum(city, live, expected, Dijkstra::find_safest_path(city, s, t, live, algorithm, queue));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(search, tight_lower_bounds) {
+    std::mt19937 rng(24);
+    std::uniform_real_distribution<double> lat(-60.0, 60.0), lon(-170.0, 170.0), step(0.0005, 0.01);
+    for (int line = 0; line < 60; ++line) {
+        // Along a meridian, then along a diagonal
+        const CSRGraph road = straight_road(50, lat(rng), lon(rng), step(rng), line % 2 ? step(rng) : 0.0);
+        const PathResult expected = Dijkstra::find_safest_path(road, 1, 50);
+        REQUIRE(expected.success);
+        for (QueueType queue : kQueues) {
+            const PathResult r = Dijkstra::find_safest_path(road, 1, 50, nullptr, SearchAlgorithm::AStar, queue);
+            check_same_optimum(road, nullptr, expected, r);
+            CHECK_EQ(r.path.size(), size_t(50));
+        }
+    }
+}
+
+TEST(search, hierarchy_matches_dijkstra) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Grid, 2000, 31);
+    ContractionHierarchy hierarchy(city);
+    HazardManager hazards;
+    WeightOverlay overlay;
+    // Customized for a first hazard set, then again after it changes
+    for (unsigned seed : {32u, 33u}) {
+        hazards.replace_all(synthetic::make_hazards(city, 30, seed));
+        overlay.rebuild(city, hazards);
+        hierarchy.customize(city, &overlay);
+        for (const auto& [s, t] : fixtures::random_pairs(city, 60, seed)) {
+            check_same_optimum(city, &overlay, Dijkstra::find_safest_path(city, s, t, &overlay),
+                               hierarchy.find_safest_path(city, &overlay, s, t));
+        }
+    }
+}
+
+TEST(search, unreachable_and_unknown_nodes) {
+    const CSRGraph city(fixtures::small_city());
+    ContractionHierarchy hierarchy(city);
+    hierarchy.customize(city, nullptr);
+    for (SearchAlgorithm algorithm : kAlgorithms) {
+        for (QueueType queue : kQueues) {
+            CHECK(!Dijkstra::find_safest_path(city, 1, 9, nullptr, algorithm, queue).success);
+            CHECK(!Dijkstra::find_safest_path(city, 9, 4, nullptr, algorithm, queue).success);
+            CHECK(!Dijkstra::find_safest_path(city, 1, 42, nullptr, algorithm, queue).success);
+            const PathResult r = Dijkstra::find_safest_path(city, 1, 4, nullptr, algorithm, queue);
+            CHECK_EQ(r.path, (std::vector<int>{1, 2, 6, 7, 3, 4}));
+        }
+    }
+    CHECK(!hierarchy.find_safest_path(city, nullptr, 1, 9).success);
+    CHECK(!hierarchy.find_safest_path(city, nullptr, 1, 42).success);
+    CHECK_EQ(hierarchy.find_safest_path(city, nullptr, 4, 1).path, (std::vector<int>{4, 3, 7, 6, 2, 1}));
+}
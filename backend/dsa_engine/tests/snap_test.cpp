@@ -0,0 +1,121 @@
+/**
+ * snap: snapping coordinates to the nearest road against a scan over every
+ * segment, and routes between snapped points on the small city.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../dijkstra.h"
+#include "../edge_index.h"
+#include "../geo.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+/**
+ * ScanSnapper
+ * Distance from a point to the nearest road by checking every edge, in the
+ * same local projection the index uses.
+ */
+struct ScanSnapper {
+    const CSRGraph& graph;
+    double cos_ref;
+
+    explicit ScanSnapper(const CSRGraph& g) : graph(g) {
+        double lat_sum = 0;
+        for (int v = 0; v < g.node_count(); ++v) lat_sum += g.latitude(v);
+        cos_ref = std::cos(lat_sum / g.node_count() * geo::kDegToRad);
+    }
+
+    // Projected distance from (lat, lon) to the point 'fraction' of the way along edge e
+    double distance_to(int e, double fraction, double lat, double lon) const {
+        const int u = graph.edge_source(e), v = graph.edge_target(e);
+        const double x = (graph.longitude(u) + fraction * (graph.longitude(v) - graph.longitude(u))) * cos_ref;
+        const double y = graph.latitude(u) + fraction * (graph.latitude(v) - graph.latitude(u));
+        return std::hypot(x - lon * cos_ref, y - lat);
+    }
+
+    double nearest(double lat, double lon) const {
+        double best = 1e300;
+        for (int e = 0; e < graph.edge_count(); ++e) {
+            const int u = graph.edge_source(e), v = graph.edge_target(e);
+            const double ax = graph.longitude(u) * cos_ref, ay = graph.latitude(u);
+            const double dx = graph.longitude(v) * cos_ref - ax, dy = graph.latitude(v) - ay;
+            const double length_sq = dx * dx + dy * dy;
+            const double t = length_sq > 0 ? std::clamp(((lon * cos_ref - ax) * dx + (lat - ay) * dy) / length_sq, 0.0, 1.0) : 0.0;
+            best = std::min(best, distance_to(e, t, lat, lon));
+        }
+        return best;
+    }
+};
+
+} // namespace
+
+TEST(snap, nearest_road_matches_scan) {
+    for (synthetic::CityKind kind : {synthetic::CityKind::Grid, synthetic::CityKind::Geometric}) {
+        const CSRGraph city = synthetic::make_city(kind, 3000, 151);
+        const EdgeIndex index(city);
+        const ScanSnapper scan(city);
+        CHECK(index.segment_count() > 0);
+
+        // Points over the city and well outside it, where the ring search must widen
+        double min_lat = 90, max_lat = -90, min_lon = 180, max_lon = -180;
+        for (int v = 0; v < city.node_count(); ++v) {
+            min_lat = std::min(min_lat, city.latitude(v));
+            max_lat = std::max(max_lat, city.latitude(v));
+            min_lon = std::min(min_lon, city.longitude(v));
+            max_lon = std::max(max_lon, city.longitude(v));
+        }
+        std::mt19937 rng(152);
+        std::uniform_real_distribution<double> lat(2 * min_lat - max_lat, 2 * max_lat - min_lat);
+        std::uniform_real_distribution<double> lon(2 * min_lon - max_lon, 2 * max_lon - min_lon);
+        int mismatches = 0;
+        for (int i = 0; i < 300; ++i) {
+            const double qlat = lat(rng), qlon = lon(rng);
+            const RoadSnap snap = index.snap(city, qlat, qlon);
+            REQUIRE(snap.found());
+            CHECK(snap.fraction >= 0 && snap.fraction <= 1);
+            mismatches += std::fabs(scan.distance_to(snap.edge, snap.fraction, qlat, qlon) - scan.nearest(qlat, qlon)) > 1e-12;
+            if (snap.reverse_edge >= 0) {
+                CHECK_EQ(city.edge_source(snap.reverse_edge), city.edge_target(snap.edge));
+                CHECK_EQ(city.edge_target(snap.reverse_edge), city.edge_source(snap.edge));
+            }
+        }
+        CHECK_EQ(mismatches, 0);
+    }
+    CHECK(!EdgeIndex().snap(synthetic::make_city(synthetic::CityKind::Grid, 100, 153), 33.7, 73.05).found());
+}
+
+TEST(snap, routes_between_snapped_points) {
+    const CSRGraph city(fixtures::small_city());
+    const EdgeIndex index(city);
+
+    // Halfway along 1-2 (just south of it) and halfway along 3-4
+    const RoadSnap from = index.snap(city, 33.6995, 73.005);
+    const RoadSnap to = index.snap(city, 33.6995, 73.025);
+    REQUIRE(from.found() && to.found());
+    CHECK_NEAR(from.fraction, 0.5, 1e-9);
+    CHECK_NEAR(from.latitude, 33.700, 1e-12);
+    CHECK_NEAR(from.distance_km, 0.0556, 1e-3);
+
+    // Half of 1-2, the north detour to 3, then half of 3-4
+    PathResult r = Dijkstra::find_safest_path(city, from, to);
+    REQUIRE(r.success);
+    CHECK_EQ(r.path, (std::vector<int>{2, 6, 7, 3}));
+    CHECK_NEAR(r.total_cost, 0.5 + 1.2 + 0.7 + 1.2 + 0.5, 1e-9);
+    CHECK_NEAR(r.total_distance, 0.5 + 1.2 + 1.2 + 1.2 + 0.5, 1e-9);
+
+    // Both points on one road: no intersection is passed
+    r = Dijkstra::find_safest_path(city, from, index.snap(city, 33.7005, 73.008));
+    REQUIRE(r.success);
+    CHECK(r.path.empty());
+    CHECK_NEAR(r.total_distance, 0.3, 1e-9);
+
+    // A snap on an intersection routes like the node itself; the isolated node has no road
+    const RoadSnap at_4 = EdgeIndex::at_node(city, city.index_of(4));
+    CHECK_NEAR(Dijkstra::find_safest_path(city, at_4, from).total_cost,
+               Dijkstra::find_safest_path(city, 4, 2).total_cost + 0.5, 1e-9);
+    CHECK(!EdgeIndex::at_node(city, city.index_of(9)).found());
+}
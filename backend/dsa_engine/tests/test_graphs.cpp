@@ -0,0 +1,117 @@
+#include "test_graphs.h"
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <random>
+
+namespace fixtures {
+
+Graph small_city() {
+    Graph g;
+    g.add_node(1, 33.700, 73.000, "South 1");
+    g.add_node(2, 33.700, 73.010, "South 2");
+    g.add_node(3, 33.700, 73.020, "South 3");
+    g.add_node(4, 33.700, 73.030, "South 4");
+    g.add_node(5, 33.710, 73.000, "North 5");
+    g.add_node(6, 33.710, 73.010, "North 6");
+    g.add_node(7, 33.710, 73.020, "North 7");
+    g.add_node(8, 33.710, 73.030, "North 8");
+    g.add_node(9, 33.800, 73.100, "Island");
+    g.add_edge(1, 2, 1.0);
+    g.add_edge(2, 3, 1.0, 5.0);
+    g.add_edge(3, 4, 1.0);
+    g.add_edge(5, 6, 1.2);
+    g.add_edge(6, 7, 1.2, 0.0, 0.5);
+    g.add_edge(7, 8, 1.2);
+    for (int south = 1; south <= 4; ++south) g.add_edge(south, south + 4, 1.2);
+    g.add_one_way_edge(4, 3, 0.5);
+    return g;
+}
+
+Graph to_graph(const CSRGraph& graph) {
+    Graph g;
+    for (int v = 0; v < graph.node_count(); ++v) {
+        g.add_node(graph.node_id(v), graph.latitude(v), graph.longitude(v), graph.node_name(v));
+    }
+    for (int e = 0; e < graph.edge_count(); ++e) {
+        const double length = graph.edge_length(e), hazard = graph.edge_hazard(e);
+        g.add_one_way_edge(graph.node_id(graph.edge_source(e)), graph.node_id(graph.edge_target(e)), length, hazard,
+                           length + hazard - graph.edge_weight(e));
+    }
+    return g;
+}
+
+double reference_cost(const Graph& graph, int start_id, int end_id) {
+    if (!graph.has_node(start_id) || !graph.has_node(end_id)) return kUnreachable;
+    std::map<int, double> best;
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    best[start_id] = 0;
+    pq.push({0, start_id});
+    while (!pq.empty()) {
+        const auto [d, u] = pq.top();
+        pq.pop();
+        if (d > best[u]) continue;
+        if (u == end_id) return d;
+        for (const Edge& edge : graph.get_neighbors(u)) {
+            const double candidate = d + edge.get_weight();
+            auto it = best.find(edge.destination_id);
+            if (it == best.end() || candidate < it->second) {
+                best[edge.destination_id] = candidate;
+                pq.push({candidate, edge.destination_id});
+            }
+        }
+    }
+    return kUnreachable;
+}
+
+std::vector<double> reference_costs(const CSRGraph& graph, int start, const EdgeCost& cost) {
+    std::vector<double> best(graph.node_count(), kUnreachable);
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    best[start] = 0;
+    pq.push({0, start});
+    while (!pq.empty()) {
+        const auto [d, u] = pq.top();
+        pq.pop();
+        if (d > best[u]) continue;
+        for (int e = graph.edge_begin(u); e < graph.edge_end(u); ++e) {
+            const int v = graph.edge_target(e);
+            if (d + cost(e) < best[v]) {
+                best[v] = d + cost(e);
+                pq.push({best[v], v});
+            }
+        }
+    }
+    return best;
+}
+
+double route_cost(const CSRGraph& graph, const std::vector<int>& path, const EdgeCost& cost) {
+    double total = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        const int u = graph.index_of(path[i - 1]), v = graph.index_of(path[i]);
+        if (u < 0 || v < 0) return kUnreachable;
+        double cheapest = kUnreachable;
+        for (int e = graph.edge_begin(u); e < graph.edge_end(u); ++e) {
+            if (graph.edge_target(e) == v) cheapest = std::min(cheapest, cost(e));
+        }
+        if (cheapest == kUnreachable) return kUnreachable;
+        total += cheapest;
+    }
+    return total;
+}
+
+EdgeCost standard_cost(const CSRGraph& graph, const WeightOverlay* overlay) {
+    return [&graph, overlay](int e) { return routing_cost(graph, overlay, e); };
+}
+
+std::vector<std::pair<int, int>> random_pairs(const CSRGraph& graph, int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < count; ++i) {
+        pairs.push_back({graph.node_id(rng() % graph.node_count()), graph.node_id(rng() % graph.node_count())});
+    }
+    return pairs;
+}
+
+} // namespace fixtures
@@ -0,0 +1,58 @@
+#ifndef TEST_GRAPHS_H
+#define TEST_GRAPHS_H
+
+#include "../csr_graph.h"
+#include "../graph.h"
+#include "../weight_overlay.h"
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * Test Graphs
+ * Fixed road networks and a textbook reference search for the test suites.
+ */
+namespace fixtures {
+
+const double kUnreachable = 1e18;
+
+/**
+ * small_city
+ * Eight intersections in two rows of four (IDs 1-4 south, 5-8 north), every
+ * neighbour pair joined by a two-way road, plus an isolated node 9:
+ *
+ *   5 --1.2-- 6 --1.2-- 7 --1.2-- 8      6-7 carries a 0.5 safety bonus
+ *   |         |         |         |      (all verticals are 1.2 km)
+ *   1 --1.0-- 2 --1.0-- 3 --1.0-- 4      2-3 carries a static hazard of 5.0
+ *                       ^---0.5---'      one-way 4 -> 3
+ *
+ * Best routes: 1 -> 4 is 1, 2, 6, 7, 3, 4 (cost 5.1, 5.6 km); 4 -> 1 takes the
+ * one-way shortcut: 4, 3, 7, 6, 2, 1 (cost 4.6, 5.1 km).
+ */
+Graph small_city();
+
+// Same nodes and edges as 'graph' as an adjacency-list Graph (the legacy form)
+Graph to_graph(const CSRGraph& graph);
+
+// Textbook Dijkstra over the adjacency lists (Edge::get_weight); kUnreachable if no route
+double reference_cost(const Graph& graph, int start_id, int end_id);
+
+// Routing cost of CSR edge e, as a search under test would see it
+typedef std::function<double(int edge)> EdgeCost;
+
+// Textbook Dijkstra over CSR edges with 'cost': best cost from internal node 'start' to every node
+std::vector<double> reference_costs(const CSRGraph& graph, int start, const EdgeCost& cost);
+
+// Cost of a route given as external Node IDs, taking the cheapest edge between consecutive
+// nodes; kUnreachable if two consecutive nodes are not joined by an edge
+double route_cost(const CSRGraph& graph, const std::vector<int>& path, const EdgeCost& cost);
+
+// Routing cost under the standard model with 'overlay' (may be null), as an EdgeCost
+EdgeCost standard_cost(const CSRGraph& graph, const WeightOverlay* overlay);
+
+// 'count' random (start, end) pairs of external Node IDs, fixed by 'seed'
+std::vector<std::pair<int, int>> random_pairs(const CSRGraph& graph, int count, unsigned seed);
+
+} // namespace fixtures
+
+#endif // TEST_GRAPHS_H
@@ -0,0 +1,95 @@
+#ifndef TEST_HARNESS_H
+#define TEST_HARNESS_H
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Test Harness
+ * Self-registering test cases for amaan_tests, with no external framework (the
+ * engine has no third-party dependencies). TEST(suite, name) defines a case.
+ * CHECK* records a failure and carries on; REQUIRE* ends the case at once.
+ * "amaan_tests <suite>" runs one suite; ctest runs every suite as its own test
+ * (see CMakeLists.txt).
+ */
+namespace test {
+
+struct Case {
+    const char* suite;
+    const char* name;
+    void (*body)();
+};
+
+// Every case linked into the binary, in registration order
+std::vector<Case>& registry();
+
+struct Registrar {
+    Registrar(const char* suite, const char* name, void (*body)()) { registry().push_back({suite, name, body}); }
+};
+
+// Thrown by REQUIRE* to end the current case
+struct Abort {};
+
+// Reports a failed check of the running case
+void fail(const char* file, int line, const std::string& message);
+
+// Text form of a checked value, for failure messages
+template <typename T>
+std::string describe(const T& value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+template <typename T>
+std::string describe(const std::vector<T>& values) {
+    std::ostringstream out;
+    out << "[";
+    for (size_t i = 0; i < values.size(); ++i) out << (i ? ", " : "") << describe(values[i]);
+    out << "]";
+    return out.str();
+}
+
+} // namespace test
+
+#define TEST(suite, name)                                                                   \
+    static void suite##_##name();                                                           \
+    static const test::Registrar suite##_##name##_registrar(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) test::fail(__FILE__, __LINE__, "CHECK(" #condition ") failed"); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                \
+    do {                                                                                          \
+        const auto& check_actual_ = (actual);                                                     \
+        const auto& check_expected_ = (expected);                                                 \
+        if (!(check_actual_ == check_expected_)) {                                                \
+            test::fail(__FILE__, __LINE__, "CHECK_EQ(" #actual ", " #expected "): " +             \
+                       test::describe(check_actual_) + " != " + test::describe(check_expected_)); \
+        }                                                                                         \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                                   \
+    do {                                                                                          \
+        const double check_actual_ = (actual);                                                    \
+        const double check_expected_ = (expected);                                                \
+        if (!(std::fabs(check_actual_ - check_expected_) <= (tolerance))) {                       \
+            test::fail(__FILE__, __LINE__, "CHECK_NEAR(" #actual ", " #expected "): " +           \
+                       test::describe(check_actual_) + " vs " + test::describe(check_expected_)); \
+        }                                                                                         \
+    } while (0)
+
+#define REQUIRE(condition)                                                                  \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            test::fail(__FILE__, __LINE__, "REQUIRE(" #condition ") failed");               \
+            throw test::Abort();                                                            \
+        }                                                                                   \
+    } while (0)
+
+#endif // TEST_HARNESS_H
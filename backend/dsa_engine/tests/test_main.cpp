@@ -0,0 +1,71 @@
+/**
+ * amaan_tests
+ * Runs the registered test cases (see test_harness.h) and exits non-zero if any
+ * check failed.
+ *
+ * Usage: amaan_tests [suite ...]     (no suite = all of them)
+ *        amaan_tests --list
+ */
+#include "test_harness.h"
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+
+namespace {
+
+int failures_in_case = 0;
+
+} // namespace
+
+namespace test {
+
+std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+void fail(const char* file, int line, const std::string& message) {
+    failures_in_case++;
+    std::fprintf(stderr, "  %s:%d: %s\n", file, line, message.c_str());
+}
+
+} // namespace test
+
+int main(int argc, char* argv[]) {
+    if (argc == 2 && !std::strcmp(argv[1], "--list")) {
+        for (const test::Case& c : test::registry()) std::printf("%s.%s\n", c.suite, c.name);
+        return 0;
+    }
+
+    auto selected = [&](const test::Case& c) {
+        if (argc < 2) return true;
+        for (int i = 1; i < argc; ++i) {
+            if (!std::strcmp(argv[i], c.suite)) return true;
+        }
+        return false;
+    };
+
+    int run = 0, failed = 0;
+    for (const test::Case& c : test::registry()) {
+        if (!selected(c)) continue;
+        run++;
+        failures_in_case = 0;
+        try {
+            c.body();
+        } catch (const test::Abort&) {
+            // Already reported by REQUIRE
+        } catch (const std::exception& e) {
+            test::fail(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+        }
+        if (failures_in_case > 0) failed++;
+        std::printf("%-6s %s.%s\n", failures_in_case > 0 ? "FAIL" : "ok", c.suite, c.name);
+    }
+
+    if (run == 0) {
+        std::fprintf(stderr, "No test cases selected\n");
+        return 1;
+    }
+    std::printf("%d of %d cases passed\n", run - failed, run);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * tiles: routing on a tile file against the resident CSR graph it was cut
+ * from, including targets in another tile or in another component.
+ */
+#include "test_harness.h"
+#include "test_graphs.h"
+#include "../bench/synthetic_city.h"
+#include "../dijkstra.h"
+#include "../graph_tiles.h"
+#include "../hazards.h"
+#include <cstdio>
+
+namespace {
+
+/**
+ * TileFile
+ * A tile file written for one case, removed again when the case ends.
+ */
+struct TileFile {
+    std::string path;
+    TileFile(const CSRGraph& graph, const char* name, double tile_size) : path(name) {
+        TiledGraph::write(graph, path, tile_size);
+    }
+    ~TileFile() { std::remove(path.c_str()); }
+};
+
+} // namespace
+
+TEST(tiles, disconnected_targets_fail) {
+    // Two components, each a road inside its own tile, plus an isolated node in the first tile
+    Graph g;
+    g.add_node(10, 33.712, 73.012);
+    g.add_node(11, 33.713, 73.013);
+    g.add_node(12, 33.714, 73.014);
+    g.add_node(20, 33.912, 73.312);
+    g.add_node(21, 33.913, 73.313);
+    g.add_edge(10, 11, 0.2);
+    g.add_edge(20, 21, 0.2);
+    TileFile file(CSRGraph(g), "amaan_tests_disconnected.amtl", 0.05);
+    TiledGraph tiles(file.path);
+    REQUIRE(tiles.tile_count() == 2);
+
+    for (SearchAlgorithm algorithm : {SearchAlgorithm::Dijkstra, SearchAlgorithm::AStar}) {
+        CHECK(!Dijkstra::find_safest_path(tiles, 11, 20, nullptr, algorithm).success);
+        CHECK(!Dijkstra::find_safest_path(tiles, 21, 11, nullptr, algorithm).success);
+        CHECK(!Dijkstra::find_safest_path(tiles, 10, 12, nullptr, algorithm).success);
+        CHECK(!Dijkstra::find_safest_path(tiles, 12, 10, nullptr, algorithm).success);
+        CHECK(!Dijkstra::find_safest_path(tiles, 10, 99, nullptr, algorithm).success);
+
+        const PathResult r = Dijkstra::find_safest_path(tiles, 21, 20, nullptr, algorithm);
+        REQUIRE(r.success);
+        CHECK_EQ(r.path, (std::vector<int>{21, 20}));
+        CHECK_NEAR(r.total_cost, 0.2, 1e-12);
+    }
+}
+
+TEST(tiles, routes_match_resident_graph) {
+    const CSRGraph city = synthetic::make_city(synthetic::CityKind::Geometric, 3000, 41);
+    HazardManager hazards;
+    hazards.replace_all(synthetic::make_hazards(city, 25, 42));
+    WeightOverlay overlay;
+    overlay.rebuild(city, hazards);
+
+    // Small tiles and a cap of two resident tiles: most routes cross tiles and evict
+    TileFile file(city, "amaan_tests_city.amtl", 0.02);
+    TiledGraph tiles(file.path, 2);
+    REQUIRE(tiles.tile_count() > 4);
+
+    for (SearchAlgorithm algorithm : {SearchAlgorithm::Dijkstra, SearchAlgorithm::AStar}) {
+        for (const auto& [s, t] : fixtures::random_pairs(city, 60, 43)) {
+            const PathResult expected = Dijkstra::find_safest_path(city, s, t, &overlay, algorithm);
+            const PathResult r = Dijkstra::find_safest_path(tiles, s, t, &hazards, algorithm);
+            CHECK_EQ(r.success, expected.success);
+            if (!r.success || !expected.success) continue;
+            CHECK_NEAR(r.total_cost, expected.total_cost, 1e-9);
+            CHECK_NEAR(r.total_distance, expected.total_distance, 1e-9);
+            CHECK_NEAR(fixtures::route_cost(city, r.path, fixtures::standard_cost(city, &overlay)), r.total_cost, 1e-9);
+        }
+    }
+    CHECK(tiles.cache_counters().resident <= 2);
+}
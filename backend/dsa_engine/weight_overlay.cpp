@@ -0,0 +1,172 @@
+#include "weight_overlay.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * WeightOverlay::rebuild
+ * 1. Clears only the entries written by the previous build.
+ * 2. Evaluates the hazard penalty at every intersection (batch grid lookup).
+ * 3. Penalizes just the roads that start or end at a penalized intersection:
+ *    the average penalty of both ends, doubled for impact (AMAAN formula).
+ */
+void WeightOverlay::rebuild(const CSRGraph& graph, const HazardManager& hazards) {
+    // Size the arrays once per graph; afterwards resets are proportional to touched entries
+    if (node_penalties.size() != static_cast<size_t>(graph.node_count()) ||
+        edge_penalties.size() != static_cast<size_t>(graph.edge_count())) {
+        node_penalties.assign(graph.node_count(), 0.0);
+        edge_penalties.assign(graph.edge_count(), 0.0);
+        touched_nodes.clear();
+        touched_edges.clear();
+    }
+
+    // 1. Undo the previous overlay
+    for (int e : touched_edges) edge_penalties[e] = 0.0;
+    touched_nodes.clear();
+    touched_edges.clear();
+
+    // 2. Node penalties, scored in one batch pass (only nodes inside some hazard's
+    //    zone of influence are recorded as touched)
+    hazards.get_penalties_for_locations(graph.node_latitudes(), graph.node_longitudes(),
+                                        graph.node_count(), node_penalties);
+    for (int v = 0; v < graph.node_count(); ++v) {
+        if (node_penalties[v] > 0) touched_nodes.push_back(v);
+    }
+
+    // 3. Edge penalties: every edge leaving or entering a penalized node
+    auto penalize = [&](int e) {
+        if (edge_penalties[e] != 0.0) return; // Already set via its other endpoint
+        double avg_penalty = (node_penalties[graph.edge_source(e)] + node_penalties[graph.edge_target(e)]) / 2.0;
+        edge_penalties[e] = avg_penalty * 2.0;
+        touched_edges.push_back(e);
+    };
+    for (int v : touched_nodes) {
+        for (int e = graph.edge_begin(v); e < graph.edge_end(v); ++e) {
+            penalize(e);
+        }
+        for (int i = graph.in_edge_begin(v); i < graph.in_edge_end(v); ++i) {
+            penalize(graph.in_edge(i));
+        }
+    }
+
+    hazard_epoch = hazards.get_epoch();
+    built = true;
+    built_for = graph.columns().targets;
+}
+
+namespace {
+
+// Grid cell of a coordinate for WeightOverlay::index_nodes, packed like HazardManager's keys
+long long node_cell_key(double lat, double lon) {
+    const double cell = HazardManager::kInfluenceRadius;
+    const long long row = static_cast<long long>(std::floor(lat / cell));
+    const long long column = static_cast<long long>(std::floor(lon / cell));
+    return static_cast<long long>((static_cast<unsigned long long>(row) << 32) ^
+                                  (static_cast<unsigned long long>(column) & 0xffffffffULL));
+}
+
+} // namespace
+
+/**
+ * WeightOverlay::index_nodes
+ * Buckets every intersection by cell, CSR-style: node indices sorted by cell
+ * key, and each cell's slice of them. O(V log V), once per graph.
+ */
+void WeightOverlay::index_nodes(const CSRGraph& graph) {
+    std::vector<std::pair<long long, int>> keyed(graph.node_count());
+    for (int v = 0; v < graph.node_count(); ++v) keyed[v] = {node_cell_key(graph.latitude(v), graph.longitude(v)), v};
+    std::sort(keyed.begin(), keyed.end());
+
+    cell_nodes.resize(keyed.size());
+    node_cells.clear();
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        cell_nodes[i] = keyed[i].second;
+        auto cell = node_cells.try_emplace(keyed[i].first, static_cast<int>(i), static_cast<int>(i)).first;
+        cell->second.second = static_cast<int>(i) + 1;
+    }
+    cells_for = graph.columns().targets;
+}
+
+/**
+ * WeightOverlay::update
+ * 1. Collects the intersections within one influence radius of the old and new
+ *    position of every changed hazard (3x3 cells around each).
+ * 2. Rescores just those intersections; every other node keeps its penalty, as
+ *    no hazard in its reach changed.
+ * 3. Recomputes the roads entering or leaving them with the rebuild() formula
+ *    and keeps the touched lists exact.
+ */
+bool WeightOverlay::update(const CSRGraph& graph, const HazardManager& hazards) {
+    std::vector<HazardChange> changes;
+    if (!built || built_for != graph.columns().targets ||
+        edge_penalties.size() != static_cast<size_t>(graph.edge_count()) ||
+        !hazards.changes_since(hazard_epoch, changes)) {
+        rebuild(graph, hazards);
+        return false;
+    }
+    if (cells_for != graph.columns().targets) index_nodes(graph);
+
+    // 1. Intersections in reach of a change
+    const double radius = HazardManager::kInfluenceRadius;
+    std::vector<int> affected;
+    auto collect = [&](const Hazard& h) {
+        const long long row = static_cast<long long>(std::floor(h.latitude / radius));
+        const long long column = static_cast<long long>(std::floor(h.longitude / radius));
+        for (long long dy = -1; dy <= 1; ++dy) {
+            for (long long dx = -1; dx <= 1; ++dx) {
+                const long long key = static_cast<long long>((static_cast<unsigned long long>(row + dy) << 32) ^
+                                                             (static_cast<unsigned long long>(column + dx) & 0xffffffffULL));
+                auto cell = node_cells.find(key);
+                if (cell == node_cells.end()) continue;
+                for (int i = cell->second.first; i < cell->second.second; ++i) {
+                    const int v = cell_nodes[i];
+                    const double d_lat = graph.latitude(v) - h.latitude, d_lon = graph.longitude(v) - h.longitude;
+                    if (d_lat * d_lat + d_lon * d_lon < radius * radius) affected.push_back(v);
+                }
+            }
+        }
+    };
+    for (const HazardChange& change : changes) {
+        if (change.has_before) collect(change.before);
+        if (change.has_after) collect(change.after);
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+    // 2. Their penalties under the current hazards
+    bool dropped = false;
+    for (int v : affected) {
+        const double before = node_penalties[v];
+        node_penalties[v] = hazards.get_penalty_for_location(graph.latitude(v), graph.longitude(v));
+        if (before <= 0 && node_penalties[v] > 0) touched_nodes.push_back(v);
+        dropped |= before > 0 && node_penalties[v] <= 0;
+    }
+    if (dropped) {
+        touched_nodes.erase(std::remove_if(touched_nodes.begin(), touched_nodes.end(),
+                                           [&](int v) { return node_penalties[v] <= 0; }), touched_nodes.end());
+    }
+
+    // 3. Their roads, in both directions
+    dropped = false;
+    auto repenalize = [&](int e) {
+        const double source = node_penalties[graph.edge_source(e)], target = node_penalties[graph.edge_target(e)];
+        double penalty = 0.0;
+        if (source > 0 || target > 0) {
+            double avg_penalty = (source + target) / 2.0;
+            penalty = avg_penalty * 2.0;
+        }
+        if (edge_penalties[e] == 0.0 && penalty != 0.0) touched_edges.push_back(e);
+        dropped |= edge_penalties[e] != 0.0 && penalty == 0.0;
+        edge_penalties[e] = penalty;
+    };
+    for (int v : affected) {
+        for (int e = graph.edge_begin(v); e < graph.edge_end(v); ++e) repenalize(e);
+        for (int i = graph.in_edge_begin(v); i < graph.in_edge_end(v); ++i) repenalize(graph.in_edge(i));
+    }
+    if (dropped) {
+        touched_edges.erase(std::remove_if(touched_edges.begin(), touched_edges.end(),
+                                           [&](int e) { return edge_penalties[e] == 0.0; }), touched_edges.end());
+    }
+
+    hazard_epoch = hazards.get_epoch();
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef WEIGHT_OVERLAY_H
+#define WEIGHT_OVERLAY_H
+
+#include "csr_graph.h"
+#include "hazards.h"
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * WeightOverlay Class
+ * Per-edge hazard penalties layered on top of an immutable CSRGraph.
+ * Instead of copying the road network for every request, the base topology is
+ * shared and only the edges touched by active hazards carry a non-zero penalty.
+ * The overlay remembers which hazard epoch it was built for, so repeated queries
+ * against an unchanged hazard set pay only for the search itself, and a later
+ * hazard set can be caught up from the changes in between (update).
+ */
+class WeightOverlay {
+private:
+    // Dense per-node and per-edge penalties, indexed like the CSRGraph (zero by default)
+    std::vector<double> node_penalties;
+    std::vector<double> edge_penalties;
+    // Entries currently non-zero, so a rebuild only resets what was written
+    std::vector<int> touched_nodes;
+    std::vector<int> touched_edges;
+    // HazardManager epoch this overlay reflects (none yet after construction)
+    unsigned long long hazard_epoch = 0;
+    bool built = false;
+    const void* built_for = nullptr;  // Edge column of the graph it was built for (identifies the graph)
+
+    // Intersections grouped by grid cell (one influence radius wide), to find the
+    // ones within reach of a changed hazard. Built by the first update() on a graph.
+    std::vector<int> cell_nodes;
+    std::unordered_map<long long, std::pair<int, int>> node_cells;  // Cell key -> slice of 'cell_nodes'
+    const void* cells_for = nullptr;
+    void index_nodes(const CSRGraph& graph);
+
+public:
+    // Recomputes penalties for the given hazards. O(touched) reset + penalty evaluation.
+    void rebuild(const CSRGraph& graph, const HazardManager& hazards);
+
+    // Catches up with 'hazards' from the epoch the overlay was built for: only the
+    // intersections within reach of a hazard added, changed or removed since then are
+    // rescored (HazardManager::changes_since), and only their roads re-penalized.
+    // Falls back to rebuild() if the overlay has not been built for this graph or the
+    // changelog no longer reaches back. Returns true if the update was incremental.
+    // Either way the penalties equal those of a full rebuild.
+    bool update(const CSRGraph& graph, const HazardManager& hazards);
+
+    // True if the overlay already reflects the current state of 'hazards'
+    bool is_current(const HazardManager& hazards) const {
+        return built && hazard_epoch == hazards.get_epoch();
+    }
+
+    // Extra routing cost of an edge on top of CSRGraph::edge_weight
+    double penalty(int edge) const { return edge_penalties[edge]; }
+
+    // Edge IDs that currently carry a penalty
+    const std::vector<int>& penalized_edges() const { return touched_edges; }
+};
+
+/**
+ * routing_cost
+ * Cost of traversing edge 'e': the static CSR weight plus the live hazard
+ * penalty when an overlay is supplied. Shared by every routing back-end.
+ */
+inline double routing_cost(const CSRGraph& graph, const WeightOverlay* overlay, int e) {
+    double weight = graph.edge_weight(e);
+    if (overlay) weight += overlay->penalty(e);
+    return weight;
+}
+
+#endif // WEIGHT_OVERLAY_H
@@ -0,0 +1,100 @@
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+
+/**
+ * WorkerPool::Job
+ * One parallel_for call. Indices are claimed from an atomic counter, so
+ * whoever is free takes the next one; 'seats' is how many more helpers may
+ * join and 'active' how many are still inside run().
+ */
+struct WorkerPool::Job {
+    const std::function<void(size_t)>* body;
+    size_t count;
+    std::atomic<size_t> next{0};
+    unsigned seats;
+    unsigned active = 0; // Guarded by the pool mutex
+
+    Job(const std::function<void(size_t)>& job_body, size_t job_count, unsigned helpers)
+        : body(&job_body), count(job_count), seats(helpers) {}
+
+    void run() {
+        for (size_t i = next++; i < count; i = next++) (*body)(i);
+    }
+};
+
+WorkerPool::WorkerPool(unsigned helpers) {
+    threads.reserve(helpers);
+    for (unsigned t = 0; t < helpers; ++t) threads.emplace_back([this]() { run_helper(); });
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+/**
+ * WorkerPool::shared
+ * Started on first use; hardware_concurrency() may report 0, which leaves
+ * every job to its caller.
+ */
+WorkerPool& WorkerPool::shared() {
+    static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+/**
+ * WorkerPool::run_helper
+ * Takes a seat on the oldest queued job, works until its indices run out,
+ * then goes back for the next one. A job leaves the queue when its last seat
+ * is taken or its caller finishes.
+ */
+void WorkerPool::run_helper() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        work_ready.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        if (jobs.empty()) return;
+        std::shared_ptr<Job> job = jobs.front();
+        if (--job->seats == 0) jobs.pop_front();
+        job->active++;
+
+        lock.unlock();
+        job->run();
+        lock.lock();
+        if (--job->active == 0) helper_done.notify_all();
+    }
+}
+
+/**
+ * WorkerPool::parallel_for
+ * Small or single-threaded jobs run inline without touching the pool. Otherwise
+ * the job is queued for helpers and the caller works on it as well; once the
+ * caller runs out of indices it withdraws the job, so no new helper can join,
+ * and waits for the helpers still finishing their last index.
+ */
+void WorkerPool::parallel_for(size_t count, unsigned parallelism, const std::function<void(size_t)>& body) {
+    unsigned helpers = parallelism == 0 ? helper_count() : std::min(parallelism - 1, helper_count());
+    helpers = static_cast<unsigned>(std::min<size_t>(helpers, count > 0 ? count - 1 : 0));
+    if (helpers == 0) {
+        for (size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    auto job = std::make_shared<Job>(body, count, helpers);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(job);
+    }
+    work_ready.notify_all();
+
+    job->run();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto queued = std::find(jobs.begin(), jobs.end(), job);
+    if (queued != jobs.end()) jobs.erase(queued);
+    helper_done.wait(lock, [&job]() { return job->active == 0; });
+}
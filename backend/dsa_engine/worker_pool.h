@@ -0,0 +1,57 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * WorkerPool Class
+ * A fixed set of long-lived helper threads for splitting one request's work
+ * (route matrix rows, isochrone origins) across cores. Compared with starting
+ * threads per call:
+ * - Concurrent requests share the same helpers instead of each starting its
+ *   own, so serve mode with N workers never runs more than N + helpers threads.
+ * - Helpers outlive the request, so their thread_local search workspaces and
+ *   queues keep their capacity instead of being reallocated (O(V)) every call.
+ *
+ * The calling thread always works on its own job too, so a job finishes even
+ * when every helper is busy with other requests; helpers only speed it up.
+ */
+class WorkerPool {
+public:
+    // 'helpers' threads, started at once
+    explicit WorkerPool(unsigned helpers);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Process-wide pool with one helper per hardware thread beyond the caller's
+    static WorkerPool& shared();
+
+    unsigned helper_count() const { return static_cast<unsigned>(threads.size()); }
+
+    // Calls body(i) once for every i in [0, count) on the calling thread plus up to
+    // 'parallelism' - 1 helpers (0 = as many as the pool has), and returns once all
+    // calls have finished. Each i runs exactly once; order is unspecified.
+    void parallel_for(size_t count, unsigned parallelism, const std::function<void(size_t)>& body);
+
+private:
+    struct Job;
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable work_ready;          // A job was queued, or the pool is stopping
+    std::condition_variable helper_done;         // A helper left a job
+    std::deque<std::shared_ptr<Job>> jobs;       // Jobs that still accept helpers
+    bool stopping = false;
+
+    void run_helper();
+};
+
+#endif // WORKER_POOL_H